@@ -0,0 +1,408 @@
+// pxlmath micro benchmarks, self-contained, one binary per backend:
+//   g++ -O2 -std=c++17 -DPXL_SIMD=PXL_SIMD_NONE bench/pxlmath_bench.cpp -o bench_none -lpthread
+//   g++ -O2 -std=c++17 -msse2 -DPXL_SIMD=PXL_SIMD_SSE2 bench/pxlmath_bench.cpp -o bench_sse2 -lpthread
+//   g++ -O2 -std=c++17 -mavx2 -mfma -mf16c -DPXL_SIMD=PXL_SIMD_AVX2 bench/pxlmath_bench.cpp -o bench_avx2 -lpthread
+//   cl /O2 /std:c++17 /EHsc /arch:AVX2 /DPXL_SIMD=PXL_SIMD_AVX2 bench\pxlmath_bench.cpp
+// usage: bench [--quick] [filter...], only cases whose name contains one of the filters run
+//
+// latency: one call at a time with every result feeding the next call
+// throughput: elementwise over arrays sized to fill L1, L2, LLC and DRAM-sized working sets,
+// reported as ns per element and GB/s of array traffic (bytes read + written per element)
+// every figure is the best of 5 samples, each sample runs long enough for the clock to be stable
+
+#include "../pxlmath.h"
+#include "../pxlmath_anim.h"
+#include "../pxlmath_bvh.h"
+#include "../pxlmath_expr.h"
+#include "../pxlmath_geom.h"
+#include "../pxlmath_gpu.h"
+#include "../pxlmath_quant.h"
+#include "../pxlmath_skin.h"
+#include <chrono>
+#include <new>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <utility>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+using namespace pxl;
+
+namespace bench {
+#if defined(_MSC_VER) && !defined(__clang__)
+	template<typename T> inline void keep(const T& v) { static volatile char sink; sink = *(const volatile char*)&v; _ReadWriteBarrier(); }
+#else
+	// the compiler has to assume v (and anything reachable through memory) is read here
+	template<typename T> inline void keep(const T& v) { asm volatile("" : : "r"(&v) : "memory"); }
+#endif
+
+	static bool quick = false;
+	static int nfilters = 0;
+	static char** filters = nullptr;
+	static inline bool selected(const char* name) {
+		if (!nfilters) return true;
+		for (int i = 0; i < nfilters; ++i) if (strstr(name, filters[i])) return true;
+		return false;
+	}
+
+	static uint32_t seed = 0x12345678;
+	static inline float rnd() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) * (2.0f / 16777216.0f) - 1; }
+	static inline vec3f rnd3() { return { rnd(), rnd(), rnd() }; }
+	static inline vec4f rnd4() { return { rnd(), rnd(), rnd(), rnd() }; }
+	static inline quatf rndq() { return quatf{ rnd(), rnd(), rnd(), rnd() + 2 }.normalized(); }
+	static inline mat4f rndm() { return mat4f::trs(rnd3() * 10, rndq(), vec3f{ 1.5f, 1.5f, 1.5f } + rnd3()); }
+
+	// one bump allocation of the largest working set, carved per case
+	struct arena {
+		unsigned char* base{ nullptr };
+		size_t size{ 0 }, used{ 0 };
+		inline explicit arena(const size_t& n) : base((unsigned char*)::operator new(n, std::align_val_t(64))), size(n) {}
+		inline ~arena() { ::operator delete(base, std::align_val_t(64)); }
+		template<typename T> inline T* take(const size_t& n) {
+			T* p = (T*)(base + used);
+			used += (n * sizeof(T) + 63) & ~size_t(63);
+			return p;
+		}
+	};
+
+	typedef std::chrono::steady_clock clock;
+	// best ns per call of f() over 5 samples
+	template<typename F> inline double best(F& f) {
+		const double target = quick ? 2e6 : 2e7;
+		size_t iters = 1;
+		for (;;) {
+			const clock::time_point t0 = clock::now();
+			for (size_t i = 0; i < iters; ++i) f();
+			const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count();
+			if (ns >= target || iters >= (size_t(1) << 40)) break;
+			iters = ns < target / 64 ? iters * 64 : (size_t)(iters * target / ns) + 1;
+		}
+		double b = 1e300;
+		for (int s = 0; s < 5; ++s) {
+			const clock::time_point t0 = clock::now();
+			for (size_t i = 0; i < iters; ++i) f();
+			const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count() / iters;
+			if (ns < b) b = ns;
+		}
+		return b;
+	}
+
+	static const size_t sets[] = { size_t(16) << 10, size_t(256) << 10, size_t(4) << 20, size_t(64) << 20 };
+	static const char* set_names[] = { "L1", "L2", "LLC", "DRAM" };
+	static arena* memory = nullptr;
+
+	// make(state) returns a step function that runs chunk calls back to back, each depending on the last
+	template<typename Make> inline void latency(const char* name, const Make& make) {
+		if (!selected(name)) return;
+		const size_t chunk = 256;
+		auto step = make(chunk);
+		printf("%-28s %-5s %9s %10.2f ns\n", name, "chain", "-", best(step) / chunk);
+		fflush(stdout);
+	}
+	// make(memory, n) fills its arrays and returns a function that runs the operation on all n elements
+	template<typename Make> inline void throughput(const char* name, const size_t& bytes, const Make& make) {
+		if (!selected(name)) return;
+		for (size_t k = 0; k < sizeof(sets) / sizeof(sets[0]); ++k) {
+			if (quick && k == 3) break;
+			const size_t n = sets[k] / bytes;
+			memory->used = 0;
+			auto run = make(*memory, n);
+			run();
+			const double ns = best(run) / n;
+			printf("%-28s %-5s %9zu %10.2f ns %8.2f GB/s\n", name, set_names[k], n, ns, bytes / ns);
+			fflush(stdout);
+		}
+	}
+}
+
+using namespace bench;
+
+static const char* backend() {
+	switch (PXL_SIMD) {
+	case PXL_SIMD_SSE2: return "SSE2";
+	case PXL_SIMD_AVX2: return "AVX2";
+	case PXL_SIMD_NEON: return "NEON";
+	default: return "NONE (scalar)";
+	}
+}
+
+// a[i] op b[i] -> o[i] for one operand type
+#define PXL_BENCH_BINARY(NAME, A, B, O, FILLA, FILLB, EXPR) \
+	throughput(NAME, sizeof(A) + sizeof(B) + sizeof(O), [](arena& m, const size_t& n) { \
+		A* a = m.take<A>(n); B* b = m.take<B>(n); O* o = m.take<O>(n); \
+		for (size_t i = 0; i < n; ++i) { a[i] = FILLA; b[i] = FILLB; } \
+		return [=] { for (size_t i = 0; i < n; ++i) o[i] = EXPR; keep(*o); }; })
+#define PXL_BENCH_UNARY(NAME, A, O, FILLA, EXPR) \
+	throughput(NAME, sizeof(A) + sizeof(O), [](arena& m, const size_t& n) { \
+		A* a = m.take<A>(n); O* o = m.take<O>(n); \
+		for (size_t i = 0; i < n; ++i) a[i] = FILLA; \
+		return [=] { for (size_t i = 0; i < n; ++i) o[i] = EXPR; keep(*o); }; })
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--quick")) quick = true;
+		else { filters = argv + i; nfilters = argc - i; break; }
+	}
+	printf("pxlmath bench, backend %s, %zu float lanes\n", backend(), (size_t)(PXL_SIMD ? simd::lanes : 1));
+	printf("%-28s %-5s %9s %13s\n", "case", "set", "elements", "per element");
+	arena mem(sets[3]);
+	memory = &mem;
+
+	// latency
+	latency("mat4f operator*", [](const size_t& c) { mat4f m = rndm(), k = mat4f::trs(rnd3(), rndq(), { 1, 1, 1 }); return [=]() mutable { for (size_t i = 0; i < c; ++i) m = m * k; keep(m); }; });
+	latency("mat4f mul_affine", [](const size_t& c) { mat4f m = rndm(), k = mat4f::trs(rnd3(), rndq(), { 1, 1, 1 }); return [=]() mutable { for (size_t i = 0; i < c; ++i) m = m.mul_affine(k); keep(m); }; });
+	latency("mat4f inverse", [](const size_t& c) { mat4f m = rndm(); return [=]() mutable { for (size_t i = 0; i < c; ++i) { mat4f r; m.inverse(r); m = r; } keep(m); }; });
+	latency("mat4f det", [](const size_t& c) { mat4f m = rndm(); return [=]() mutable { for (size_t i = 0; i < c; ++i) m.m00 = m.det() * 1e-3f; keep(m); }; });
+	latency("quatf operator*", [](const size_t& c) { quatf q = rndq(), k = rndq(); return [=]() mutable { for (size_t i = 0; i < c; ++i) q = q * k; keep(q); }; });
+	latency("quatf from/to_euler", [](const size_t& c) { vec3f e = rnd3(); return [=]() mutable { for (size_t i = 0; i < c; ++i) e = quatf::to_euler(quatf::from_euler(e)); keep(e); }; });
+	latency("vec3f normalized", [](const size_t& c) { vec3f v = rnd3(); return [=]() mutable { for (size_t i = 0; i < c; ++i) v = (v * 1.5f).normalized(); keep(v); }; });
+	latency("quatf normalized", [](const size_t& c) { quatf q = rndq(); return [=]() mutable { for (size_t i = 0; i < c; ++i) q = quatf{ q.x * 1.5f, q.y * 1.5f, q.z * 1.5f, q.w * 1.5f }.normalized(); keep(q); }; });
+	latency("mathf::rsqrt<fast>", [](const size_t& c) { float x = 2; return [=]() mutable { for (size_t i = 0; i < c; ++i) x = mathf::rsqrt<mathf::precision::fast>(x) + 1; keep(x); }; });
+	latency("mathf::rsqrt<standard>", [](const size_t& c) { float x = 2; return [=]() mutable { for (size_t i = 0; i < c; ++i) x = mathf::rsqrt<mathf::precision::standard>(x) + 1; keep(x); }; });
+	latency("mathf::rsqrt<exact>", [](const size_t& c) { float x = 2; return [=]() mutable { for (size_t i = 0; i < c; ++i) x = mathf::rsqrt<mathf::precision::exact>(x) + 1; keep(x); }; });
+
+	// throughput, scalar api per element
+	PXL_BENCH_BINARY("mat4f operator*", mat4f, mat4f, mat4f, rndm(), rndm(), a[i] * b[i]);
+	PXL_BENCH_BINARY("mat4f mul_affine", mat4f, mat4f, mat4f, rndm(), rndm(), a[i].mul_affine(b[i]));
+	PXL_BENCH_UNARY("mat4f inverse", mat4f, mat4f, rndm(), (a[i].inverse(o[i]), o[i]));
+	PXL_BENCH_UNARY("mat4f inverse_affine", mat4f, mat4f, rndm(), (a[i].inverse_affine(o[i]), o[i]));
+	PXL_BENCH_UNARY("mat4f inverse_rigid", mat4f, mat4f, mat4f::trs(rnd3(), rndq(), { 1, 1, 1 }), a[i].inverse_rigid());
+	PXL_BENCH_UNARY("mat4f det", mat4f, float, rndm(), a[i].det());
+	PXL_BENCH_UNARY("mat4f to_rotation", mat4f, quatf, mat4f::trs(rnd3(), rndq(), { 1, 1, 1 }), mat4f::to_rotation(a[i]));
+	PXL_BENCH_UNARY("mat4f to_scale", mat4f, vec3f, rndm(), mat4f::to_scale(a[i]));
+	PXL_BENCH_BINARY("mat4f operator==", mat4f, mat4f, uint8_t, rndm(), a[i], a[i] == b[i]);
+	PXL_BENCH_BINARY("mat4f approx_equal", mat4f, mat4f, uint8_t, rndm(), a[i], approx_equal(a[i], b[i]));
+	PXL_BENCH_UNARY("mat4f hash", mat4f, size_t, rndm(), hash(a[i]));
+	PXL_BENCH_UNARY("quatf from_euler", vec3f, quatf, rnd3() * 3, quatf::from_euler(a[i]));
+	PXL_BENCH_UNARY("quatf to_euler", quatf, vec3f, rndq(), quatf::to_euler(a[i]));
+	PXL_BENCH_BINARY("quatf operator*", quatf, quatf, quatf, rndq(), rndq(), a[i] * b[i]);
+	PXL_BENCH_BINARY("quatf rotate", quatf, vec3f, vec3f, rndq(), rnd3(), a[i].rotate(b[i]));
+	PXL_BENCH_BINARY("quatf slerp", quatf, quatf, quatf, rndq(), rndq(), quatf::slerp(a[i], b[i], 0.3f));
+	PXL_BENCH_UNARY("vec2f normalized", vec2f, vec2f, (vec2f{ rnd(), rnd() }), a[i].normalized());
+	PXL_BENCH_UNARY("vec3f normalized", vec3f, vec3f, rnd3(), a[i].normalized());
+	PXL_BENCH_UNARY("vec4f normalized", vec4f, vec4f, (vec4f{ rnd(), rnd(), rnd(), rnd() }), a[i].normalized());
+	PXL_BENCH_UNARY("quatf normalized", quatf, quatf, (quatf{ rnd(), rnd(), rnd(), rnd() }), a[i].normalized());
+	PXL_BENCH_UNARY("vec2f normalize", vec2f, vec2f, (vec2f{ rnd(), rnd() }), (a[i].normalize(), a[i]));
+	PXL_BENCH_UNARY("vec3f normalize", vec3f, vec3f, rnd3(), (a[i].normalize(), a[i]));
+	PXL_BENCH_UNARY("vec4f normalize", vec4f, vec4f, (vec4f{ rnd(), rnd(), rnd(), rnd() }), (a[i].normalize(), a[i]));
+	PXL_BENCH_UNARY("quatf normalize", quatf, quatf, (quatf{ rnd(), rnd(), rnd(), rnd() }), (a[i].normalize(), a[i]));
+	PXL_BENCH_UNARY("mathf::rsqrt<fast>", float, float, rnd() + 2, mathf::rsqrt<mathf::precision::fast>(a[i]));
+	PXL_BENCH_UNARY("mathf::rsqrt<standard>", float, float, rnd() + 2, mathf::rsqrt<mathf::precision::standard>(a[i]));
+	PXL_BENCH_UNARY("mathf::rsqrt<exact>", float, float, rnd() + 2, mathf::rsqrt<mathf::precision::exact>(a[i]));
+	PXL_BENCH_UNARY("mathf::sin", float, float, rnd() * 8, mathf::sin(a[i]));
+	PXL_BENCH_UNARY("mathf::sin<standard>", float, float, rnd() * 8, mathf::sin<mathf::precision::standard>(a[i]));
+	PXL_BENCH_UNARY("mathf::exp", float, float, rnd() * 8, mathf::exp(a[i]));
+	PXL_BENCH_UNARY("mathf::exp<standard>", float, float, rnd() * 8, mathf::exp<mathf::precision::standard>(a[i]));
+	PXL_BENCH_UNARY("mathf::log", float, float, rnd() + 2, mathf::log(a[i]));
+	PXL_BENCH_UNARY("mathf::log<standard>", float, float, rnd() + 2, mathf::log<mathf::precision::standard>(a[i]));
+	throughput("mat4f trs", sizeof(vec3f) * 2 + sizeof(quatf) + sizeof(mat4f), [](arena& m, const size_t& n) {
+		vec3f* t = m.take<vec3f>(n); quatf* r = m.take<quatf>(n); vec3f* s = m.take<vec3f>(n); mat4f* o = m.take<mat4f>(n);
+		for (size_t i = 0; i < n; ++i) { t[i] = rnd3(); r[i] = rndq(); s[i] = rnd3() + 2; }
+		return [=] { for (size_t i = 0; i < n; ++i) mat4f::trs(o[i], t[i], r[i], s[i]); keep(*o); };
+	});
+
+	// throughput, batch api
+	throughput("rsqrt_n<standard>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() + 2;
+		return [=] { mathf::rsqrt_n(a, o, n); keep(*o); };
+	});
+	throughput("sin_n<fast>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() * 8;
+		return [=] { mathf::sin_n<mathf::precision::fast>(a, o, n); keep(*o); };
+	});
+	throughput("sin_n<standard>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() * 8;
+		return [=] { mathf::sin_n(a, o, n); keep(*o); };
+	});
+	throughput("sin_n<exact>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() * 8;
+		return [=] { mathf::sin_n<mathf::precision::exact>(a, o, n); keep(*o); };
+	});
+	throughput("exp_n<standard>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() * 8;
+		return [=] { mathf::exp_n(a, o, n); keep(*o); };
+	});
+	throughput("exp_n<exact>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() * 8;
+		return [=] { mathf::exp_n<mathf::precision::exact>(a, o, n); keep(*o); };
+	});
+	throughput("log_n<standard>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() + 2;
+		return [=] { mathf::log_n(a, o, n); keep(*o); };
+	});
+	throughput("log_n<exact>", 2 * sizeof(float), [](arena& m, const size_t& n) {
+		float* a = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd() + 2;
+		return [=] { mathf::log_n<mathf::precision::exact>(a, o, n); keep(*o); };
+	});
+	throughput("atan2_n<standard>", 3 * sizeof(float), [](arena& m, const size_t& n) {
+		float* y = m.take<float>(n); float* x = m.take<float>(n); float* o = m.take<float>(n);
+		for (size_t i = 0; i < n; ++i) { y[i] = rnd(); x[i] = rnd(); }
+		return [=] { mathf::atan2_n(y, x, o, n); keep(*o); };
+	});
+	throughput("transform_points", 2 * sizeof(vec3f), [](arena& m, const size_t& n) {
+		vec3f* a = m.take<vec3f>(n); vec3f* o = m.take<vec3f>(n); const mat4f k = rndm();
+		for (size_t i = 0; i < n; ++i) a[i] = rnd3();
+		return [=] { transform_points(k, a, o, n); keep(*o); };
+	});
+	throughput("rotate_n", sizeof(quatf) + 2 * sizeof(vec3f), [](arena& m, const size_t& n) {
+		quatf* q = m.take<quatf>(n); vec3f* a = m.take<vec3f>(n); vec3f* o = m.take<vec3f>(n);
+		for (size_t i = 0; i < n; ++i) { q[i] = rndq(); a[i] = rnd3(); }
+		return [=] { rotate_n(q, a, o, n); keep(*o); };
+	});
+	throughput("slerp_n", 3 * sizeof(quatf), [](arena& m, const size_t& n) {
+		quatf* a = m.take<quatf>(n); quatf* b = m.take<quatf>(n); quatf* o = m.take<quatf>(n);
+		for (size_t i = 0; i < n; ++i) { a[i] = rndq(); b[i] = rndq(); }
+		return [=] { slerp_n(a, b, 0.3f, o, n); keep(*o); };
+	});
+	throughput("from_euler_n<fast>", sizeof(vec3f) + sizeof(quatf), [](arena& m, const size_t& n) {
+		vec3f* a = m.take<vec3f>(n); quatf* o = m.take<quatf>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd3() * 3;
+		return [=] { from_euler_n<mathf::precision::fast>(a, o, n); keep(*o); };
+	});
+	throughput("from_euler_n<standard>", sizeof(vec3f) + sizeof(quatf), [](arena& m, const size_t& n) {
+		vec3f* a = m.take<vec3f>(n); quatf* o = m.take<quatf>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd3() * 3;
+		return [=] { from_euler_n(a, o, n); keep(*o); };
+	});
+	throughput("to_euler_n<fast>", sizeof(quatf) + sizeof(vec3f), [](arena& m, const size_t& n) {
+		quatf* a = m.take<quatf>(n); vec3f* o = m.take<vec3f>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rndq();
+		return [=] { to_euler_n<mathf::precision::fast>(a, o, n); keep(*o); };
+	});
+	throughput("to_euler_n<standard>", sizeof(quatf) + sizeof(vec3f), [](arena& m, const size_t& n) {
+		quatf* a = m.take<quatf>(n); vec3f* o = m.take<vec3f>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rndq();
+		return [=] { to_euler_n(a, o, n); keep(*o); };
+	});
+	throughput("trs_n", sizeof(vec3f) * 2 + sizeof(quatf) + sizeof(mat4f), [](arena& m, const size_t& n) {
+		vec3f* t = m.take<vec3f>(n); quatf* r = m.take<quatf>(n); vec3f* s = m.take<vec3f>(n); mat4f* o = m.take<mat4f>(n);
+		for (size_t i = 0; i < n; ++i) { t[i] = rnd3(); r[i] = rndq(); s[i] = rnd3() + 2; }
+		return [=] { trs_n(t, r, s, o, n); keep(*o); };
+	});
+	throughput("decompose_n", sizeof(vec3f) * 2 + sizeof(quatf) + sizeof(mat4f), [](arena& m, const size_t& n) {
+		mat4f* a = m.take<mat4f>(n); vec3f* t = m.take<vec3f>(n); quatf* r = m.take<quatf>(n); vec3f* s = m.take<vec3f>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rndm();
+		return [=] { decompose_n(a, t, r, s, n); keep(*t); keep(*r); keep(*s); };
+	});
+	throughput("convert_n vec3f to vec3h", sizeof(vec3f) + sizeof(vec3h), [](arena& m, const size_t& n) {
+		vec3f* a = m.take<vec3f>(n); vec3h* o = m.take<vec3h>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd3();
+		return [=] { convert_n(a, o, n); keep(*o); };
+	});
+	throughput("convert_n vec3h to vec3f", sizeof(vec3h) + sizeof(vec3f), [](arena& m, const size_t& n) {
+		vec3h* a = m.take<vec3h>(n); vec3f* o = m.take<vec3f>(n);
+		for (size_t i = 0; i < n; ++i) { const vec3f v = rnd3(); a[i] = { v.x, v.y, v.z }; }
+		return [=] { convert_n(a, o, n); keep(*o); };
+	});
+	throughput("convert_n vec3f to vec3sn", sizeof(vec3f) + sizeof(vec3sn), [](arena& m, const size_t& n) {
+		vec3f* a = m.take<vec3f>(n); vec3sn* o = m.take<vec3sn>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd3();
+		return [=] { convert_n(a, o, n); keep(*o); };
+	});
+	throughput("convert_n quatf to quat32", sizeof(quatf) + sizeof(quat32), [](arena& m, const size_t& n) {
+		quatf* a = m.take<quatf>(n); quat32* o = m.take<quat32>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rndq();
+		return [=] { convert_n(a, o, n); keep(*o); };
+	});
+	throughput("convert_n quat32 to quatf", sizeof(quat32) + sizeof(quatf), [](arena& m, const size_t& n) {
+		quat32* a = m.take<quat32>(n); quatf* o = m.take<quatf>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rndq();
+		return [=] { convert_n(a, o, n); keep(*o); };
+	});
+	throughput("convert_n vec3f to oct32", sizeof(vec3f) + sizeof(oct32), [](arena& m, const size_t& n) {
+		vec3f* a = m.take<vec3f>(n); oct32* o = m.take<oct32>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd3().normalized();
+		return [=] { convert_n(a, o, n); keep(*o); };
+	});
+	throughput("convert_n oct32 to vec3f", sizeof(oct32) + sizeof(vec3f), [](arena& m, const size_t& n) {
+		oct32* a = m.take<oct32>(n); vec3f* o = m.take<vec3f>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rnd3().normalized();
+		return [=] { convert_n(a, o, n); keep(*o); };
+	});
+	throughput("convert_n pos48 to vec3f", sizeof(pos48) + sizeof(vec3f), [](arena& m, const size_t& n) {
+		pos48* a = m.take<pos48>(n); vec3f* o = m.take<vec3f>(n); const pos_range r{ { -1, -1, -1 }, { 2, 2, 2 } };
+		for (size_t i = 0; i < n; ++i) a[i] = r.encode<pos48>(rnd3());
+		return [=] { convert_n(r, a, o, n); keep(*o); };
+	});
+	throughput("write_palette column_major", 2 * sizeof(mat4f), [](arena& m, const size_t& n) {
+		mat4f* a = m.take<mat4f>(n); mat4f* o = m.take<mat4f>(n);
+		for (size_t i = 0; i < n; ++i) a[i] = rndm();
+		return [=] { write_palette(a, o, n, matrix_layout::column_major); keep(*o); };
+	});
+	throughput("write_palette rows3x4", sizeof(mat4f) + 48, [](arena& m, const size_t& n) {
+		mat4f* a = m.take<mat4f>(n); float* o = m.take<float>(12 * n);
+		for (size_t i = 0; i < n; ++i) a[i] = rndm();
+		return [=] { write_palette(a, o, n, matrix_layout::rows3x4); keep(*o); };
+	});
+	PXL_BENCH_BINARY("vec3f a*s+b*t-c", vec3f, vec3f, vec3f, rnd3(), rnd3(), a[i] * 0.5f + b[i] * 0.25f - a[i]);
+	PXL_BENCH_BINARY("vec3f lazy a*s+b*t-c", vec3f, vec3f, vec3f, rnd3(), rnd3(), lazy(a[i]) * 0.5f + lazy(b[i]) * 0.25f - a[i]);
+	PXL_BENCH_BINARY("vec4f a*s+b*t-c", vec4f, vec4f, vec4f, rnd4(), rnd4(), a[i] * 0.5f + b[i] * 0.25f - a[i]);
+	PXL_BENCH_BINARY("vec4f lazy a*s+b*t-c", vec4f, vec4f, vec4f, rnd4(), rnd4(), lazy(a[i]) * 0.5f + lazy(b[i]) * 0.25f - a[i]);
+	// 32 keys at 30 Hz per track, each call steps a 60 Hz frame, with the cursors or a binary search per track
+	throughput("track<quatf> sample_n", sizeof(quatf), [](arena& m, const size_t& n) {
+		quatf* o = m.take<quatf>(n); uint32_t* c = m.take<uint32_t>(n);
+		static std::vector<track<quatf>> tracks;
+		tracks.assign(n, track<quatf>());
+		for (size_t i = 0; i < n; ++i) for (int k = 0; k < 32; ++k) tracks[i].add(k / 30.0f, rndq());
+		memset(c, 0, n * sizeof(uint32_t));
+		float t = 0;
+		return [=]() mutable { t = t < 1 ? t + 1 / 60.0f : 0; sample_n(tracks.data(), n, t, c, o); keep(*o); };
+	});
+	throughput("track<quatf> sample search", sizeof(quatf), [](arena& m, const size_t& n) {
+		quatf* o = m.take<quatf>(n);
+		static std::vector<track<quatf>> tracks;
+		tracks.assign(n, track<quatf>());
+		for (size_t i = 0; i < n; ++i) for (int k = 0; k < 32; ++k) tracks[i].add(k / 30.0f, rndq());
+		float t = 0;
+		return [=]() mutable { t = t < 1 ? t + 1 / 60.0f : 0; for (size_t i = 0; i < n; ++i) o[i] = tracks[i].sample(t); keep(*o); };
+	});
+	throughput("skin_n lbs 4", sizeof(skin_weights4) + 2 * sizeof(vec3f), [](arena& m, const size_t& n) {
+		mat4f* p = m.take<mat4f>(64); skin_weights4* w = m.take<skin_weights4>(n); vec3f* a = m.take<vec3f>(n); vec3f* o = m.take<vec3f>(n);
+		for (size_t i = 0; i < 64; ++i) p[i] = rndm();
+		for (size_t i = 0; i < n; ++i) { w[i] = { { 0.4f, 0.3f, 0.2f, 0.1f }, { uint16_t(i % 64), uint16_t(i * 7 % 64), uint16_t(i * 13 % 64), uint16_t(i * 29 % 64) } }; a[i] = rnd3(); }
+		return [=] { skin_n(p, w, a, o, n); keep(*o); };
+	});
+	throughput("skin_n dqs 4", sizeof(skin_weights4) + 2 * sizeof(vec3f), [](arena& m, const size_t& n) {
+		dualquatf* p = m.take<dualquatf>(64); skin_weights4* w = m.take<skin_weights4>(n); vec3f* a = m.take<vec3f>(n); vec3f* o = m.take<vec3f>(n);
+		for (size_t i = 0; i < 64; ++i) p[i] = dualquatf::from_rt(rndq(), rnd3());
+		for (size_t i = 0; i < n; ++i) { w[i] = { { 0.4f, 0.3f, 0.2f, 0.1f }, { uint16_t(i % 64), uint16_t(i * 7 % 64), uint16_t(i * 13 % 64), uint16_t(i * 29 % 64) } }; a[i] = rnd3(); }
+		return [=] { skin_n(p, w, a, o, n); keep(*o); };
+	});
+	throughput("cull_n aabb", sizeof(aabb), [](arena& m, const size_t& n) {
+		aabb* b = m.take<aabb>(n); uint32_t* o = m.take<uint32_t>((n + 31) / 32);
+		for (size_t i = 0; i < n; ++i) { const vec3f c = rnd3() * 50; b[i] = { c - 1, c + 1 }; }
+		mat4f view; mat4f::trs(vec3f::zero(), rndq(), { 1, 1, 1 }).inverse_affine(view);
+		const frustum f = frustum::from_matrix(mat4f::perspective(0.1f, 100, -0.1f, 0.1f, 0.1f, -0.1f) * view);
+		return [=] { cull_n(f, b, n, o); keep(*o); };
+	});
+	throughput("bvh build", sizeof(aabb), [](arena& m, const size_t& n) {
+		aabb* b = m.take<aabb>(n);
+		for (size_t i = 0; i < n; ++i) { const vec3f c = rnd3() * 50; b[i] = { c - 0.5f, c + 0.5f }; }
+		static bvh tree;
+		return [=] { tree.build(b, n); keep(tree.nodes[0]); };
+	});
+	// rays into a fixed mesh of 4096 random triangles, about half of them hit
+	throughput("raycast_n", sizeof(ray) + sizeof(ray_hit), [](arena& m, const size_t& n) {
+		vec3f* v = m.take<vec3f>(3 * 4096); uint32_t* x = m.take<uint32_t>(3 * 4096); ray* r = m.take<ray>(n); ray_hit* h = m.take<ray_hit>(n);
+		for (uint32_t i = 0; i < 3 * 4096; i += 3) {
+			const vec3f c = rnd3() * 20;
+			v[i] = c + rnd3(); v[i + 1] = c + rnd3(); v[i + 2] = c + rnd3();
+			x[i] = i; x[i + 1] = i + 1; x[i + 2] = i + 2;
+		}
+		for (size_t i = 0; i < n; ++i) r[i] = ray::from_points(rnd3() * 30, rnd3() * 10);
+		static bvh tree;
+		tree.build(v, x, 4096);
+		return [=] { for (size_t i = 0; i < n; ++i) h[i].t = 2; raycast_n(tree, v, x, r, h, n); keep(*h); };
+	});
+	return 0;
+}
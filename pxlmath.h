@@ -3,11 +3,106 @@
 #include <math.h>
 #include <float.h>
 #include <string.h>
+#include <stdint.h>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#define PXL_SIMD_NONE 0
+#define PXL_SIMD_SSE2 1
+#define PXL_SIMD_AVX2 2
+#define PXL_SIMD_NEON 3
+
+#ifndef PXL_SIMD
+#if defined(__AVX2__)
+#define PXL_SIMD PXL_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PXL_SIMD PXL_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define PXL_SIMD PXL_SIMD_NEON
+#else
+#define PXL_SIMD PXL_SIMD_NONE
+#endif
+#endif
+
+#if PXL_SIMD == PXL_SIMD_AVX2
+#include <immintrin.h>
+#elif PXL_SIMD == PXL_SIMD_SSE2
+#include <emmintrin.h>
+#elif PXL_SIMD == PXL_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// hardware binary16 conversion, f16c on x86 (implied by /arch:AVX2 on msvc) and aarch64 neon
+#ifndef PXL_SIMD_HALF
+#if (PXL_SIMD == PXL_SIMD_SSE2 || PXL_SIMD == PXL_SIMD_AVX2) && (defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define PXL_SIMD_HALF 1
+#include <immintrin.h>
+#elif PXL_SIMD == PXL_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+#define PXL_SIMD_HALF 1
+#else
+#define PXL_SIMD_HALF 0
+#endif
+#endif
+
+// hardware fused multiply-add, fma3 on x86 (implied by /arch:AVX2 on msvc) and aarch64 neon. mathf::madd and
+// simd::madd round once when it is set and stay a separate multiply and add otherwise
+#ifndef PXL_FMA
+#if (PXL_SIMD == PXL_SIMD_SSE2 || PXL_SIMD == PXL_SIMD_AVX2) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define PXL_FMA 1
+#include <immintrin.h>
+#elif PXL_SIMD == PXL_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+#define PXL_FMA 1
+#else
+#define PXL_FMA 0
+#endif
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define PXL_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#if __has_builtin(__builtin_bit_cast)
+#define PXL_BIT_CAST(T, x) __builtin_bit_cast(T, x)
+#endif
+#endif
+#if !defined(PXL_IS_CONSTANT_EVALUATED) && defined(_MSC_VER) && _MSC_VER >= 1925
+#define PXL_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#if !defined(PXL_BIT_CAST) && defined(_MSC_VER) && _MSC_VER >= 1927
+#define PXL_BIT_CAST(T, x) __builtin_bit_cast(T, x)
+#endif
+#ifndef PXL_IS_CONSTANT_EVALUATED
+#define PXL_IS_CONSTANT_EVALUATED() false
+#endif
 
 namespace pxl {
-	struct vec3f;
-	struct vec4f;
-	struct vec2f;
+	template<size_t N, typename T> struct vec;
+	template<typename T> struct quat;
+	template<size_t R, size_t C, typename T> struct mat;
+	struct half;
+	struct snorm16;
+	struct unorm16;
+
+	typedef vec<2, float> vec2f;
+	typedef vec<3, float> vec3f;
+	typedef vec<4, float> vec4f;
+	typedef quat<float> quatf;
+	typedef mat<4, 4, float> mat4f;
+	typedef vec<2, double> vec2d;
+	typedef vec<3, double> vec3d;
+	typedef vec<4, double> vec4d;
+	typedef quat<double> quatd;
+	typedef mat<4, 4, double> mat4d;
+	typedef vec<2, half> vec2h;
+	typedef vec<3, half> vec3h;
+	typedef vec<4, half> vec4h;
+	typedef vec<2, snorm16> vec2sn;
+	typedef vec<3, snorm16> vec3sn;
+	typedef vec<4, snorm16> vec4sn;
+	typedef vec<2, unorm16> vec2un;
+	typedef vec<3, unorm16> vec3un;
+	typedef vec<4, unorm16> vec4un;
 
 	namespace mathf {
 		static constexpr float epsilon{ FLT_EPSILON };
@@ -17,311 +112,1780 @@ namespace pxl {
 		static constexpr float halfpi{ 1.57079632679f };
 		static constexpr float deg2rad{ 0.01745329252f };
 		static constexpr float rad2deg{ 57.295779513f };
-		inline static float rsqrt(const float& x) {
-			int i = *(int*)&x;
-			i = 0x5f3759df - (i >> 1);
-			const float y = *(float*)&i;
+
+		template<typename To, typename From> inline constexpr To bit_cast(const From& f) {
+#ifdef PXL_BIT_CAST
+			return PXL_BIT_CAST(To, f);
+#else
+			To t{};
+			memcpy(&t, &f, sizeof(To));
+			return t;
+#endif
+		}
+
+		// double precision series behind the constexpr functions below, only meant for constant evaluation
+		namespace detail {
+			// finite x >= 0, scaled into [0.25, 4) by powers of 4 then newton from 1
+			inline constexpr double sqrt(const double& x) {
+				if (x <= 0) return 0;
+				double m = x, s = 1, y = 1;
+				while (m >= 4) { m *= 0.25; s *= 2; }
+				while (m < 0.25) { m *= 4; s *= 0.5; }
+				for (int i = 0; i < 6; ++i) y = 0.5 * (y + m / y);
+				return y * s;
+			}
+			// sin of x + q * pi / 2 for finite x, reduced to |r| <= pi / 4 and taylor series to r^19
+			inline constexpr double sin(const double& x, long long q) {
+				const double hp = 1.5707963267948966, k = x / hp;
+				const long long n = (long long)(k < 0 ? k - 0.5 : k + 0.5);
+				const double r = x - (double)n * hp, r2 = r * r;
+				q += n;
+				const bool c = q & 1;
+				double t = c ? 1 : r, sum = t;
+				for (int i = c ? 1 : 2; i < 20; i += 2) { t *= -r2 / (i * (i + 1.0)); sum += t; }
+				return q & 2 ? -sum : sum;
+			}
+			// atan(1 / x) = pi / 2 - atan(x) above 1, then atan(x) = 2 atan(x / (1 + sqrt(1 + x^2))) twice
+			// for |x| <= tan(pi / 16) and the series to x^23
+			inline constexpr double atan(const double& x) {
+				if (x < 0) return -atan(-x);
+				if (x > 1) return 1.5707963267948966 - atan(1 / x);
+				double a = x;
+				for (int i = 0; i < 2; ++i) a = a / (1 + sqrt(1 + a * a));
+				const double a2 = a * a;
+				double t = a, sum = a;
+				for (int i = 3; i < 24; i += 2) { t *= -a2; sum += t / i; }
+				return 4 * sum;
+			}
+			inline constexpr double atan2(const double& y, const double& x) {
+				if (x > 0) return atan(y / x);
+				if (x < 0) return atan(y / x) + (y < 0 ? -3.141592653589793 : 3.141592653589793);
+				return y > 0 ? 1.5707963267948966 : y < 0 ? -1.5707963267948966 : 0;
+			}
+			// e^x = 2^n e^r with |r| <= ln 2 / 2 and the taylor series to r^17, 2^n by repeated doubling
+			inline constexpr double exp(const double& x) {
+				if (x > 709.8) return INFINITY;
+				if (x < -745.2) return 0;
+				const double ln2 = 0.6931471805599453, k = x / ln2;
+				long long n = (long long)(k < 0 ? k - 0.5 : k + 0.5);
+				const double r = x - (double)n * ln2;
+				double t = 1, sum = 1;
+				for (int i = 1; i < 18; ++i) { t *= r / i; sum += t; }
+				for (; n > 0; --n) sum *= 2;
+				for (; n < 0; ++n) sum *= 0.5;
+				return sum;
+			}
+			// finite x > 0 scaled into [sqrt(1 / 2), sqrt(2)) by powers of 2, then 2 atanh((x - 1) / (x + 1)) to s^29
+			inline constexpr double log(const double& x) {
+				double m = x, e = 0;
+				while (m >= 1.4142135623730951) { m *= 0.5; ++e; }
+				while (m < 0.7071067811865476) { m *= 2; --e; }
+				const double s = (m - 1) / (m + 1), s2 = s * s;
+				double t = s, sum = s;
+				for (int i = 3; i < 30; i += 2) { t *= s2; sum += t / i; }
+				return 2 * sum + e * 0.6931471805599453;
+			}
+			// x^y through exp and log, negative x only for integer y (every double above 2^53 is an even integer)
+			inline constexpr double pow(const double& x, const double& y) {
+				if (y == 0) return 1;
+				if (x == 0) return y > 0 ? 0 : INFINITY;
+				if (x > 0) return exp(y * log(x));
+				if (y > 1e18 || y < -1e18) return exp(y * log(-x));
+				const long long n = (long long)y;
+				if ((double)n != y) return NAN;
+				const double r = exp(y * log(-x));
+				return n & 1 ? -r : r;
+			}
+		}
+
+		// sqrt, sin, cos, tan, atan, atan2, asin, acos, exp, log and pow usable in constant expressions. Constant
+		// evaluation goes through the double precision series in detail (within 1 ulp of the C library for |x| < 2^24
+		// in sin and cos, signed zeros are not preserved), at runtime they are the C library functions.
+		inline constexpr float sqrt(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > 0 && x < infinity ? (float)detail::sqrt(x) : x == 0 || x == infinity ? x : nan;
+			return sqrtf(x);
+		}
+		inline constexpr float sin(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > -infinity && x < infinity ? (float)detail::sin(x, 0) : nan;
+			return sinf(x);
+		}
+		inline constexpr float cos(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > -infinity && x < infinity ? (float)detail::sin(x, 1) : nan;
+			return cosf(x);
+		}
+		inline constexpr void sincos(const float& x, float& s, float& c) { const float a = x; s = sin(a); c = cos(a); }
+		inline constexpr float tan(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > -infinity && x < infinity ? (float)(detail::sin(x, 0) / detail::sin(x, 1)) : nan;
+			return tanf(x);
+		}
+		inline constexpr float atan(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x == x ? (float)detail::atan(x) : nan;
+			return atanf(x);
+		}
+		inline constexpr float atan2(const float& y, const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return y == y && x == x ? (float)detail::atan2(y, x) : nan;
+			return atan2f(y, x);
+		}
+		inline constexpr float asin(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x >= -1 && x <= 1 ? (float)detail::atan2(x, detail::sqrt((1.0 - x) * (1.0 + x))) : nan;
+			return asinf(x);
+		}
+		inline constexpr float acos(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x >= -1 && x <= 1 ? (float)detail::atan2(detail::sqrt((1.0 - x) * (1.0 + x)), x) : nan;
+			return acosf(x);
+		}
+		inline constexpr float exp(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x == x ? (float)detail::exp(x) : nan;
+			return expf(x);
+		}
+		inline constexpr float log(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > 0 && x < infinity ? (float)detail::log(x) : x == 0 ? -infinity : x == infinity ? x : nan;
+			return logf(x);
+		}
+		inline constexpr float pow(const float& x, const float& y) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x == x && y == y && x > -infinity && x < infinity && y > -infinity && y < infinity ? (float)detail::pow(x, y) : y == 0 ? 1 : nan;
+			return powf(x, y);
+		}
+		// a * b + c rounded once, the library fmaf is slow on targets without the instruction. Constant evaluation
+		// goes through double, where the product is exact
+		inline constexpr float fma(const float& a, const float& b, const float& c) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return float(double(a) * b + c);
+			return fmaf(a, b, c);
+		}
+		// a * b + c as one fma when PXL_FMA, otherwise a multiply and an add, so never slower than writing it out.
+		// Whether a plain a * b + c contracts depends on the compiler and its flags, msvc only does with /fp:contract
+		inline constexpr float madd(const float& a, const float& b, const float& c) {
+#if PXL_FMA
+			if (!PXL_IS_CONSTANT_EVALUATED()) return fmaf(a, b, c);
+#endif
+			return a * b + c;
+		}
+		// fabsf, fminf and fmaxf, a nan argument gives the other one
+		inline constexpr float abs(const float& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x < 0 ? -x : x == 0 ? 0 : x;
+			return fabsf(x);
+		}
+		inline constexpr float min(const float& a, const float& b) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return b < a || a != a ? b : a;
+			return fminf(a, b);
+		}
+		inline constexpr float max(const float& a, const float& b) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return b > a || a != a ? b : a;
+			return fmaxf(a, b);
+		}
+		// double forms for vec<N, double> and the like, constant evaluation is within a few ulp for |x| < 2^10
+		inline constexpr double sqrt(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > 0 && x < infinity ? detail::sqrt(x) : x == 0 || x == infinity ? x : nan;
+			return ::sqrt(x);
+		}
+		inline constexpr double sin(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > -infinity && x < infinity ? detail::sin(x, 0) : nan;
+			return ::sin(x);
+		}
+		inline constexpr double cos(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > -infinity && x < infinity ? detail::sin(x, 1) : nan;
+			return ::cos(x);
+		}
+		inline constexpr void sincos(const double& x, double& s, double& c) { const double a = x; s = sin(a); c = cos(a); }
+		inline constexpr double tan(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > -infinity && x < infinity ? detail::sin(x, 0) / detail::sin(x, 1) : nan;
+			return ::tan(x);
+		}
+		inline constexpr double atan(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x == x ? detail::atan(x) : nan;
+			return ::atan(x);
+		}
+		inline constexpr double atan2(const double& y, const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return y == y && x == x ? detail::atan2(y, x) : nan;
+			return ::atan2(y, x);
+		}
+		inline constexpr double asin(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x >= -1 && x <= 1 ? detail::atan2(x, detail::sqrt((1 - x) * (1 + x))) : nan;
+			return ::asin(x);
+		}
+		inline constexpr double acos(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x >= -1 && x <= 1 ? detail::atan2(detail::sqrt((1 - x) * (1 + x)), x) : nan;
+			return ::acos(x);
+		}
+		inline constexpr double exp(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x == x ? detail::exp(x) : nan;
+			return ::exp(x);
+		}
+		inline constexpr double log(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x > 0 && x < infinity ? detail::log(x) : x == 0 ? -infinity : x == infinity ? x : nan;
+			return ::log(x);
+		}
+		inline constexpr double pow(const double& x, const double& y) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x == x && y == y && x > -infinity && x < infinity && y > -infinity && y < infinity ? detail::pow(x, y) : y == 0 ? 1 : nan;
+			return ::pow(x, y);
+		}
+		inline constexpr double fma(const double& a, const double& b, const double& c) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return a * b + c;
+			return ::fma(a, b, c);
+		}
+		inline constexpr double madd(const double& a, const double& b, const double& c) {
+#if PXL_FMA
+			if (!PXL_IS_CONSTANT_EVALUATED()) return ::fma(a, b, c);
+#endif
+			return a * b + c;
+		}
+		inline constexpr double abs(const double& x) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return x < 0 ? -x : x == 0 ? 0 : x;
+			return ::fabs(x);
+		}
+		inline constexpr double min(const double& a, const double& b) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return b < a || a != a ? b : a;
+			return ::fmin(a, b);
+		}
+		inline constexpr double max(const double& a, const double& b) {
+			if (PXL_IS_CONSTANT_EVALUATED()) return b > a || a != a ? b : a;
+			return ::fmax(a, b);
+		}
+
+		// representable values between a and b, 0 for +0 and -0, the largest count when either is nan. The bits are
+		// mapped to offset binary so the negative and positive ranges meet at zero
+		inline constexpr uint32_t ulp_distance(const float& a, const float& b) {
+			if (a != a || b != b) return ~0u;
+			const uint32_t ia = bit_cast<uint32_t>(a), ib = bit_cast<uint32_t>(b),
+				ua = ia >> 31 ? 0x80000000u - (ia & 0x7fffffffu) : 0x80000000u + ia,
+				ub = ib >> 31 ? 0x80000000u - (ib & 0x7fffffffu) : 0x80000000u + ib;
+			return ua < ub ? ub - ua : ua - ub;
+		}
+		inline constexpr uint64_t ulp_distance(const double& a, const double& b) {
+			const uint64_t sign = uint64_t(1) << 63;
+			if (a != a || b != b) return ~uint64_t(0);
+			const uint64_t ia = bit_cast<uint64_t>(a), ib = bit_cast<uint64_t>(b),
+				ua = ia & sign ? sign - (ia & ~sign) : sign + ia,
+				ub = ib & sign ? sign - (ib & ~sign) : sign + ib;
+			return ua < ub ? ub - ua : ua - ub;
+		}
+		// within max_ulps representable values, nan is never equal. Suits results that should round the same way,
+		// not values near zero where the ulp is tiny
+		inline constexpr bool ulp_equal(const float& a, const float& b, const uint64_t& max_ulps = 4) { return a == b || (a == a && b == b && ulp_distance(a, b) <= max_ulps); }
+		inline constexpr bool ulp_equal(const double& a, const double& b, const uint64_t& max_ulps = 4) { return a == b || (a == a && b == b && ulp_distance(a, b) <= max_ulps); }
+		// |a - b| <= eps below magnitude 1 and relative to the larger magnitude above it, equal infinities included
+		inline constexpr bool approx_equal(const float& a, const float& b, const float& eps = 1e-5f) { return a == b || abs(a - b) <= eps * max(1.0f, max(abs(a), abs(b))); }
+		inline constexpr bool approx_equal(const double& a, const double& b, const double& eps = 1e-5) { return a == b || abs(a - b) <= eps * max(1.0, max(abs(a), abs(b))); }
+
+		// fast: 0x5f3759df estimate and one newton step, max relative error 1.76e-3 (simd::rsqrt<fast> is the lane
+		// estimate instead, never worse but different per backend, see simd::rsqrte)
+		// standard: hardware estimate refined by newton steps (1/sqrtf without simd), max relative error 4.8e-7 (2^-21)
+		// exact: 1 / sqrtf(x), within 1 ulp
+		// x must be positive. Constant evaluation gives 1 / sqrt(x) for standard and exact, the fast estimate needs
+		// a constexpr bit_cast there (PXL_BIT_CAST).
+		enum class precision { fast, standard, exact };
+		template<precision P = precision::standard> inline constexpr float rsqrt(const float& x) {
+			if (P == precision::fast) {
+				const float y = bit_cast<float>(0x5f3759df - (bit_cast<int>(x) >> 1));
+				return y * (1.5f - 0.5f * x * y * y);
+			}
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return 1 / sqrt(x);
+#if PXL_SIMD == PXL_SIMD_SSE2 || PXL_SIMD == PXL_SIMD_AVX2
+			const float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
 			return y * (1.5f - 0.5f * x * y * y);
+#elif PXL_SIMD == PXL_SIMD_NEON
+			const float32x2_t v = vdup_n_f32(x);
+			float32x2_t y = vrsqrte_f32(v);
+			y = vmul_f32(y, vrsqrts_f32(vmul_f32(v, y), y));
+			y = vmul_f32(y, vrsqrts_f32(vmul_f32(v, y), y));
+			return vget_lane_f32(y, 0);
+#else
+			return 1 / sqrtf(x);
+#endif
 		}
+		template<precision P = precision::standard> inline constexpr double rsqrt(const double& x) { return 1 / sqrt(x); }
 	}
 
-	struct vec2f {
-		float x, y;
-		inline constexpr float magnitude() const {
-			const float sqrmag = x * x + y * y;
+	// 4-lane float kernels shared by the sse2, avx2 and neon backends, PXL_SIMD_NONE emulates the lanes with plain
+	// arrays so the batch kernels still build (the mat4f members keep their scalar code instead).
+	// mat4_mul evaluates every dot product in the same order as the scalar path, so it is bit-identical
+	// unless the compiler contracts either side into fma. mat4_det/mat4_inverse use the 2x2 block form and land
+	// about as far from the exact result as the scalar cofactor expansion, not on it. Against the scalar path,
+	// measured on random TRS, view and projection * view matrices (tests/pxlmath_tests.cpp checks these bounds):
+	// det is within 3 ulp of the product of the row lengths, every inverse element within cond ulp of the largest
+	// one, cond = |m| |m^-1| in the frobenius norm. That is 8 ulp for TRS with scales 0.5 - 2 and for views,
+	// 24 ulp with scales 0.1 - 5 and hundreds for projections with far / near in the thousands.
+	namespace simd {
+#if PXL_SIMD == PXL_SIMD_NONE
+		struct f4 { float v[4]; };
+		inline f4 load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+		inline void store(float* p, const f4& a) { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+		inline f4 set1(const float& x) { return { { x, x, x, x } }; }
+		inline f4 setr(const float& x, const float& y, const float& z, const float& w) { return { { x, y, z, w } }; }
+		inline f4 add(const f4& a, const f4& b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+		inline f4 sub(const f4& a, const f4& b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+		inline f4 mul(const f4& a, const f4& b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+		inline f4 div(const f4& a, const f4& b) { return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } }; }
+		inline f4 sqrt(const f4& a) { return { { sqrtf(a.v[0]), sqrtf(a.v[1]), sqrtf(a.v[2]), sqrtf(a.v[3]) } }; }
+		inline f4 min(const f4& a, const f4& b) { return { { fminf(a.v[0], b.v[0]), fminf(a.v[1], b.v[1]), fminf(a.v[2], b.v[2]), fminf(a.v[3], b.v[3]) } }; }
+		inline f4 max(const f4& a, const f4& b) { return { { fmaxf(a.v[0], b.v[0]), fmaxf(a.v[1], b.v[1]), fmaxf(a.v[2], b.v[2]), fmaxf(a.v[3], b.v[3]) } }; }
+		// masks hold all bits set in the lanes that compare true
+		inline float mask(const bool& b) { const unsigned int u = b ? ~0u : 0u; float f; memcpy(&f, &u, 4); return f; }
+		inline bool lane(const float& m) { unsigned int u; memcpy(&u, &m, 4); return u != 0; }
+		inline float bits(const float& a, const float& b, const int& op) {
+			unsigned int u, v;
+			memcpy(&u, &a, 4); memcpy(&v, &b, 4);
+			u = op == 0 ? u & v : op == 1 ? u | v : u ^ v;
+			float f;
+			memcpy(&f, &u, 4);
+			return f;
+		}
+		inline f4 cmplt(const f4& a, const f4& b) { return { { mask(a.v[0] < b.v[0]), mask(a.v[1] < b.v[1]), mask(a.v[2] < b.v[2]), mask(a.v[3] < b.v[3]) } }; }
+		inline f4 cmple(const f4& a, const f4& b) { return { { mask(a.v[0] <= b.v[0]), mask(a.v[1] <= b.v[1]), mask(a.v[2] <= b.v[2]), mask(a.v[3] <= b.v[3]) } }; }
+		inline f4 cmpeq(const f4& a, const f4& b) { return { { mask(a.v[0] == b.v[0]), mask(a.v[1] == b.v[1]), mask(a.v[2] == b.v[2]), mask(a.v[3] == b.v[3]) } }; }
+		inline f4 band(const f4& a, const f4& b) { return { { bits(a.v[0], b.v[0], 0), bits(a.v[1], b.v[1], 0), bits(a.v[2], b.v[2], 0), bits(a.v[3], b.v[3], 0) } }; }
+		inline f4 bor(const f4& a, const f4& b) { return { { bits(a.v[0], b.v[0], 1), bits(a.v[1], b.v[1], 1), bits(a.v[2], b.v[2], 1), bits(a.v[3], b.v[3], 1) } }; }
+		inline f4 bxor(const f4& a, const f4& b) { return { { bits(a.v[0], b.v[0], 2), bits(a.v[1], b.v[1], 2), bits(a.v[2], b.v[2], 2), bits(a.v[3], b.v[3], 2) } }; }
+		inline int movemask(const f4& m) { return lane(m.v[0]) | lane(m.v[1]) << 1 | lane(m.v[2]) << 2 | lane(m.v[3]) << 3; }
+		inline f4 select(const f4& m, const f4& t, const f4& f) {
+			return { { lane(m.v[0]) ? t.v[0] : f.v[0], lane(m.v[1]) ? t.v[1] : f.v[1], lane(m.v[2]) ? t.v[2] : f.v[2], lane(m.v[3]) ? t.v[3] : f.v[3] } };
+		}
+		inline f4 rsqrte(const f4& a) {
+			f4 r;
+			for (int i = 0; i < 4; ++i) {
+				int b;
+				memcpy(&b, &a.v[i], 4);
+				b = 0x5f3759df - (b >> 1);
+				memcpy(&r.v[i], &b, 4);
+				r.v[i] *= 1.5f - 0.5f * a.v[i] * r.v[i] * r.v[i];
+				r.v[i] *= 1.5f - 0.5f * a.v[i] * r.v[i] * r.v[i];
+			}
+			return r;
+		}
+		inline float first(const f4& a) { return a.v[0]; }
+		template<int i0, int i1, int i2, int i3> inline f4 shuffle(const f4& a, const f4& b) { return { { a.v[i0], a.v[i1], b.v[i2], b.v[i3] } }; }
+		template<int i> inline f4 splat(const f4& a) { return set1(a.v[i]); }
+#elif PXL_SIMD == PXL_SIMD_NEON
+		typedef float32x4_t f4;
+		inline f4 load(const float* p) { return vld1q_f32(p); }
+		inline void store(float* p, const f4& v) { vst1q_f32(p, v); }
+		inline f4 set1(const float& x) { return vdupq_n_f32(x); }
+		inline f4 setr(const float& x, const float& y, const float& z, const float& w) {
+			const float v[4]{ x, y, z, w };
+			return vld1q_f32(v);
+		}
+		inline f4 add(const f4& a, const f4& b) { return vaddq_f32(a, b); }
+		inline f4 sub(const f4& a, const f4& b) { return vsubq_f32(a, b); }
+		inline f4 mul(const f4& a, const f4& b) { return vmulq_f32(a, b); }
+		inline f4 div(const f4& a, const f4& b) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+			return vdivq_f32(a, b);
+#else
+			f4 r = vrecpeq_f32(b);
+			r = vmulq_f32(r, vrecpsq_f32(b, r));
+			r = vmulq_f32(r, vrecpsq_f32(b, r));
+			return vmulq_f32(a, r);
+#endif
+		}
+		inline f4 sqrt(const f4& a) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+			return vsqrtq_f32(a);
+#else
+			float v[4];
+			vst1q_f32(v, a);
+			v[0] = sqrtf(v[0]); v[1] = sqrtf(v[1]); v[2] = sqrtf(v[2]); v[3] = sqrtf(v[3]);
+			return vld1q_f32(v);
+#endif
+		}
+		inline f4 rsqrte(const f4& a) {
+			const f4 y = vrsqrteq_f32(a);
+			return vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(a, y), y));
+		}
+		inline f4 min(const f4& a, const f4& b) { return vminq_f32(a, b); }
+		inline f4 max(const f4& a, const f4& b) { return vmaxq_f32(a, b); }
+		inline f4 cmplt(const f4& a, const f4& b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+		inline f4 cmple(const f4& a, const f4& b) { return vreinterpretq_f32_u32(vcleq_f32(a, b)); }
+		inline f4 cmpeq(const f4& a, const f4& b) { return vreinterpretq_f32_u32(vceqq_f32(a, b)); }
+		inline f4 band(const f4& a, const f4& b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline f4 bor(const f4& a, const f4& b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline f4 bxor(const f4& a, const f4& b) { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline int movemask(const f4& m) {
+			const uint32x4_t u = vshrq_n_u32(vreinterpretq_u32_f32(m), 31);
+			return (int)(vgetq_lane_u32(u, 0) | vgetq_lane_u32(u, 1) << 1 | vgetq_lane_u32(u, 2) << 2 | vgetq_lane_u32(u, 3) << 3);
+		}
+		inline f4 select(const f4& m, const f4& t, const f4& f) { return vbslq_f32(vreinterpretq_u32_f32(m), t, f); }
+		inline float first(const f4& v) { return vgetq_lane_f32(v, 0); }
+		// { a[i0], a[i1], b[i2], b[i3] }, same lane selection as _mm_shuffle_ps
+		template<int i0, int i1, int i2, int i3> inline f4 shuffle(const f4& a, const f4& b) {
+#if defined(__clang__)
+			return __builtin_shufflevector(a, b, i0, i1, i2 + 4, i3 + 4);
+#elif defined(__GNUC__)
+			return __builtin_shuffle(a, b, uint32x4_t{ i0, i1, i2 + 4, i3 + 4 });
+#else
+			f4 r = vdupq_n_f32(vgetq_lane_f32(a, i0));
+			r = vsetq_lane_f32(vgetq_lane_f32(a, i1), r, 1);
+			r = vsetq_lane_f32(vgetq_lane_f32(b, i2), r, 2);
+			return vsetq_lane_f32(vgetq_lane_f32(b, i3), r, 3);
+#endif
+		}
+		template<int i> inline f4 splat(const f4& v) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+			return vdupq_laneq_f32(v, i);
+#else
+			return vdupq_n_f32(vgetq_lane_f32(v, i));
+#endif
+		}
+#else
+		typedef __m128 f4;
+		inline f4 load(const float* p) { return _mm_loadu_ps(p); }
+		inline void store(float* p, const f4& v) { _mm_storeu_ps(p, v); }
+		inline f4 set1(const float& x) { return _mm_set1_ps(x); }
+		inline f4 setr(const float& x, const float& y, const float& z, const float& w) { return _mm_setr_ps(x, y, z, w); }
+		inline f4 add(const f4& a, const f4& b) { return _mm_add_ps(a, b); }
+		inline f4 sub(const f4& a, const f4& b) { return _mm_sub_ps(a, b); }
+		inline f4 mul(const f4& a, const f4& b) { return _mm_mul_ps(a, b); }
+		inline f4 div(const f4& a, const f4& b) { return _mm_div_ps(a, b); }
+		inline f4 sqrt(const f4& a) { return _mm_sqrt_ps(a); }
+		inline f4 rsqrte(const f4& a) { return _mm_rsqrt_ps(a); }
+		inline f4 min(const f4& a, const f4& b) { return _mm_min_ps(a, b); }
+		inline f4 max(const f4& a, const f4& b) { return _mm_max_ps(a, b); }
+		inline f4 cmplt(const f4& a, const f4& b) { return _mm_cmplt_ps(a, b); }
+		inline f4 cmple(const f4& a, const f4& b) { return _mm_cmple_ps(a, b); }
+		inline f4 cmpeq(const f4& a, const f4& b) { return _mm_cmpeq_ps(a, b); }
+		inline f4 band(const f4& a, const f4& b) { return _mm_and_ps(a, b); }
+		inline f4 bor(const f4& a, const f4& b) { return _mm_or_ps(a, b); }
+		inline f4 bxor(const f4& a, const f4& b) { return _mm_xor_ps(a, b); }
+		inline int movemask(const f4& m) { return _mm_movemask_ps(m); }
+		inline f4 select(const f4& m, const f4& t, const f4& f) { return _mm_or_ps(_mm_and_ps(m, t), _mm_andnot_ps(m, f)); }
+		inline float first(const f4& v) { return _mm_cvtss_f32(v); }
+		template<int i0, int i1, int i2, int i3> inline f4 shuffle(const f4& a, const f4& b) {
+			return _mm_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0));
+		}
+		template<int i> inline f4 splat(const f4& v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i)); }
+#endif
+		template<int i0, int i1, int i2, int i3> inline f4 swizzle(const f4& v) { return shuffle<i0, i1, i2, i3>(v, v); }
+		inline float hsum(const f4& v) { const f4 t = add(v, swizzle<2, 3, 0, 1>(v)); return first(add(t, swizzle<1, 0, 3, 2>(t))); }
+		inline float hmin(const f4& v) { const f4 t = min(v, swizzle<2, 3, 0, 1>(v)); return first(min(t, swizzle<1, 0, 3, 2>(t))); }
+		inline float hmax(const f4& v) { const f4 t = max(v, swizzle<2, 3, 0, 1>(v)); return first(max(t, swizzle<1, 0, 3, 2>(t))); }
+
+		// 8 lanes as two 128-bit halves, shuffle selects within each half like _mm256_shuffle_ps
+#if PXL_SIMD != PXL_SIMD_AVX2
+		struct f8 { f4 lo, hi; };
+		inline f8 load(const float* lo, const float* hi) { return { load(lo), load(hi) }; }
+		inline void store(float* lo, float* hi, const f8& v) { store(lo, v.lo); store(hi, v.hi); }
+		inline void store(float* p, const f8& v) { store(p, v.lo); store(p + 4, v.hi); }
+		inline f4 low(const f8& v) { return v.lo; }
+		inline f4 high(const f8& v) { return v.hi; }
+		inline f8 combine(const f4& lo, const f4& hi) { return { lo, hi }; }
+		inline f8 add(const f8& a, const f8& b) { return { add(a.lo, b.lo), add(a.hi, b.hi) }; }
+		inline f8 sub(const f8& a, const f8& b) { return { sub(a.lo, b.lo), sub(a.hi, b.hi) }; }
+		inline f8 mul(const f8& a, const f8& b) { return { mul(a.lo, b.lo), mul(a.hi, b.hi) }; }
+		inline f8 div(const f8& a, const f8& b) { return { div(a.lo, b.lo), div(a.hi, b.hi) }; }
+		inline f8 sqrt(const f8& a) { return { sqrt(a.lo), sqrt(a.hi) }; }
+		inline f8 rsqrte(const f8& a) { return { rsqrte(a.lo), rsqrte(a.hi) }; }
+		inline f8 min(const f8& a, const f8& b) { return { min(a.lo, b.lo), min(a.hi, b.hi) }; }
+		inline f8 max(const f8& a, const f8& b) { return { max(a.lo, b.lo), max(a.hi, b.hi) }; }
+		inline f8 cmplt(const f8& a, const f8& b) { return { cmplt(a.lo, b.lo), cmplt(a.hi, b.hi) }; }
+		inline f8 cmple(const f8& a, const f8& b) { return { cmple(a.lo, b.lo), cmple(a.hi, b.hi) }; }
+		inline f8 cmpeq(const f8& a, const f8& b) { return { cmpeq(a.lo, b.lo), cmpeq(a.hi, b.hi) }; }
+		inline f8 band(const f8& a, const f8& b) { return { band(a.lo, b.lo), band(a.hi, b.hi) }; }
+		inline f8 bor(const f8& a, const f8& b) { return { bor(a.lo, b.lo), bor(a.hi, b.hi) }; }
+		inline f8 bxor(const f8& a, const f8& b) { return { bxor(a.lo, b.lo), bxor(a.hi, b.hi) }; }
+		inline int movemask(const f8& m) { return movemask(m.lo) | movemask(m.hi) << 4; }
+		inline f8 select(const f8& m, const f8& t, const f8& f) { return { select(m.lo, t.lo, f.lo), select(m.hi, t.hi, f.hi) }; }
+		template<int i0, int i1, int i2, int i3> inline f8 shuffle(const f8& a, const f8& b) {
+			return { shuffle<i0, i1, i2, i3>(a.lo, b.lo), shuffle<i0, i1, i2, i3>(a.hi, b.hi) };
+		}
+#else
+		typedef __m256 f8;
+		inline f8 load(const float* lo, const float* hi) {
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+		}
+		inline void store(float* lo, float* hi, const f8& v) {
+			_mm_storeu_ps(lo, _mm256_castps256_ps128(v));
+			_mm_storeu_ps(hi, _mm256_extractf128_ps(v, 1));
+		}
+		inline f8 add(const f8& a, const f8& b) { return _mm256_add_ps(a, b); }
+		inline f8 sub(const f8& a, const f8& b) { return _mm256_sub_ps(a, b); }
+		inline f8 mul(const f8& a, const f8& b) { return _mm256_mul_ps(a, b); }
+		inline f8 div(const f8& a, const f8& b) { return _mm256_div_ps(a, b); }
+		inline f8 sqrt(const f8& a) { return _mm256_sqrt_ps(a); }
+		inline f8 rsqrte(const f8& a) { return _mm256_rsqrt_ps(a); }
+		inline f8 min(const f8& a, const f8& b) { return _mm256_min_ps(a, b); }
+		inline f8 max(const f8& a, const f8& b) { return _mm256_max_ps(a, b); }
+		inline f8 cmplt(const f8& a, const f8& b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		inline f8 cmple(const f8& a, const f8& b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		inline f8 cmpeq(const f8& a, const f8& b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+		inline f8 band(const f8& a, const f8& b) { return _mm256_and_ps(a, b); }
+		inline f8 bor(const f8& a, const f8& b) { return _mm256_or_ps(a, b); }
+		inline f8 bxor(const f8& a, const f8& b) { return _mm256_xor_ps(a, b); }
+		inline int movemask(const f8& m) { return _mm256_movemask_ps(m); }
+		inline f8 select(const f8& m, const f8& t, const f8& f) { return _mm256_blendv_ps(f, t, m); }
+		inline void store(float* p, const f8& v) { _mm256_storeu_ps(p, v); }
+		inline f4 low(const f8& v) { return _mm256_castps256_ps128(v); }
+		inline f4 high(const f8& v) { return _mm256_extractf128_ps(v, 1); }
+		inline f8 combine(const f4& lo, const f4& hi) { return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1); }
+		template<int i0, int i1, int i2, int i3> inline f8 shuffle(const f8& a, const f8& b) {
+			return _mm256_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0));
+		}
+#endif
+		template<typename V> inline V broadcast(const float& x);
+		template<typename V> inline V load(const float* p);
+		template<> inline f4 broadcast<f4>(const float& x) { return set1(x); }
+		template<> inline f4 load<f4>(const float* p) { return load(p); }
+		inline float hsum(const f8& v) { return hsum(add(low(v), high(v))); }
+		inline float hmin(const f8& v) { return hmin(min(low(v), high(v))); }
+		inline float hmax(const f8& v) { return hmax(max(low(v), high(v))); }
+#if PXL_SIMD == PXL_SIMD_AVX2
+		template<> inline f8 broadcast<f8>(const float& x) { return _mm256_set1_ps(x); }
+		template<> inline f8 load<f8>(const float* p) { return _mm256_loadu_ps(p); }
+
+		// widest native register, batch kernels step by lanes
+		typedef f8 fw;
+#else
+		template<> inline f8 broadcast<f8>(const float& x) { return { set1(x), set1(x) }; }
+		template<> inline f8 load<f8>(const float* p) { return load(p, p + 4); }
+
+		typedef f4 fw;
+#endif
+		static constexpr size_t lanes = sizeof(fw) / sizeof(float);
+		template<size_t N> struct reg;
+		template<> struct reg<4> { typedef f4 type; };
+		template<> struct reg<8> { typedef f8 type; };
+
+		// a * b + c and c - a * b, fused like mathf::madd when PXL_FMA
+#if PXL_FMA && (PXL_SIMD == PXL_SIMD_SSE2 || PXL_SIMD == PXL_SIMD_AVX2)
+		inline f4 madd(const f4& a, const f4& b, const f4& c) { return _mm_fmadd_ps(a, b, c); }
+		inline f4 nmadd(const f4& a, const f4& b, const f4& c) { return _mm_fnmadd_ps(a, b, c); }
+#elif PXL_FMA && PXL_SIMD == PXL_SIMD_NEON
+		inline f4 madd(const f4& a, const f4& b, const f4& c) { return vfmaq_f32(c, a, b); }
+		inline f4 nmadd(const f4& a, const f4& b, const f4& c) { return vfmsq_f32(c, a, b); }
+#else
+		inline f4 madd(const f4& a, const f4& b, const f4& c) { return add(mul(a, b), c); }
+		inline f4 nmadd(const f4& a, const f4& b, const f4& c) { return sub(c, mul(a, b)); }
+#endif
+#if PXL_SIMD != PXL_SIMD_AVX2
+		inline f8 madd(const f8& a, const f8& b, const f8& c) { return { madd(a.lo, b.lo, c.lo), madd(a.hi, b.hi, c.hi) }; }
+		inline f8 nmadd(const f8& a, const f8& b, const f8& c) { return { nmadd(a.lo, b.lo, c.lo), nmadd(a.hi, b.hi, c.hi) }; }
+#elif PXL_FMA
+		inline f8 madd(const f8& a, const f8& b, const f8& c) { return _mm256_fmadd_ps(a, b, c); }
+		inline f8 nmadd(const f8& a, const f8& b, const f8& c) { return _mm256_fnmadd_ps(a, b, c); }
+#else
+		inline f8 madd(const f8& a, const f8& b, const f8& c) { return add(mul(a, b), c); }
+		inline f8 nmadd(const f8& a, const f8& b, const f8& c) { return sub(c, mul(a, b)); }
+#endif
+
+		// rsqrte is the backend's estimate, max relative error: _mm_rsqrt_ps on x86 3.7e-4 (1.5 * 2^-12), vrsqrteq
+		// and one vrsqrts step on neon about 2e-5, 0x5f3759df and two newton steps without simd 4.8e-6. rsqrt<fast>
+		// returns it as is, within mathf::rsqrt<fast>'s 1.76e-3 on every backend but not bit-equal to it; standard
+		// adds one newton step (4.8e-7) and exact divides by sqrt, like mathf::rsqrt
+		template<mathf::precision P, typename V> inline V rsqrt(const V& x) {
+			if (P == mathf::precision::exact) return div(broadcast<V>(1), sqrt(x));
+			const V y = rsqrte(x);
+			if (P == mathf::precision::fast) return y;
+			return mul(y, sub(broadcast<V>(1.5f), mul(mul(broadcast<V>(0.5f), x), mul(y, y))));
+		}
+
+		// non-temporal store to 16-byte aligned p, the line goes to memory without being read into the cache first
+		// (a plain store on neon and without simd). stream_fence orders the streamed stores before the ones after it
+#if PXL_SIMD == PXL_SIMD_SSE2 || PXL_SIMD == PXL_SIMD_AVX2
+		inline void stream(float* p, const f4& a) { _mm_stream_ps(p, a); }
+		inline void stream_fence() { _mm_sfence(); }
+#else
+		inline void stream(float* p, const f4& a) { store(p, a); }
+		inline void stream_fence() {}
+#endif
+
+		// integer lanes for the storage formats. store16/store32 truncate lanes that are already in the int16, uint16
+		// or int32 range, load16/load32 widen back to float, store_half/load_half convert through binary16 when
+		// PXL_SIMD_HALF is set. ftoi keeps the truncated int32 in the lane bits and itof converts such bits back, the
+		// exponent field tricks of exp and log.
+#if PXL_SIMD == PXL_SIMD_NONE
+		inline void store16(int16_t* p, const f4& a) { for (int i = 0; i < 4; ++i) p[i] = (int16_t)a.v[i]; }
+		inline void store16(uint16_t* p, const f4& a) { for (int i = 0; i < 4; ++i) p[i] = (uint16_t)a.v[i]; }
+		inline void load16(const int16_t* p, f4& a) { for (int i = 0; i < 4; ++i) a.v[i] = p[i]; }
+		inline void load16(const uint16_t* p, f4& a) { for (int i = 0; i < 4; ++i) a.v[i] = p[i]; }
+		inline void store32(int32_t* p, const f4& a) { for (int i = 0; i < 4; ++i) p[i] = (int32_t)a.v[i]; }
+		inline void load32(const int32_t* p, f4& a) { for (int i = 0; i < 4; ++i) a.v[i] = (float)p[i]; }
+		inline f4 ftoi(const f4& a) { f4 r; for (int i = 0; i < 4; ++i) { const int32_t b = (int32_t)a.v[i]; memcpy(&r.v[i], &b, 4); } return r; }
+		inline f4 itof(const f4& a) { f4 r; for (int i = 0; i < 4; ++i) { int32_t b; memcpy(&b, &a.v[i], 4); r.v[i] = (float)b; } return r; }
+#elif PXL_SIMD == PXL_SIMD_NEON
+		inline void store16(int16_t* p, const f4& a) { vst1_s16(p, vmovn_s32(vcvtq_s32_f32(a))); }
+		inline void store16(uint16_t* p, const f4& a) { vst1_u16(p, vmovn_u32(vcvtq_u32_f32(a))); }
+		inline void load16(const int16_t* p, f4& a) { a = vcvtq_f32_s32(vmovl_s16(vld1_s16(p))); }
+		inline void load16(const uint16_t* p, f4& a) { a = vcvtq_f32_u32(vmovl_u16(vld1_u16(p))); }
+		inline void store32(int32_t* p, const f4& a) { vst1q_s32(p, vcvtq_s32_f32(a)); }
+		inline void load32(const int32_t* p, f4& a) { a = vcvtq_f32_s32(vld1q_s32(p)); }
+		inline f4 ftoi(const f4& a) { return vreinterpretq_f32_s32(vcvtq_s32_f32(a)); }
+		inline f4 itof(const f4& a) { return vcvtq_f32_s32(vreinterpretq_s32_f32(a)); }
+#if PXL_SIMD_HALF
+		inline void store_half(uint16_t* p, const f4& a) { vst1_u16(p, vreinterpret_u16_f16(vcvt_f16_f32(a))); }
+		inline void load_half(const uint16_t* p, f4& a) { a = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p))); }
+#endif
+#else
+		inline void store16(int16_t* p, const f4& a) {
+			const __m128i i = _mm_cvttps_epi32(a);
+			_mm_storel_epi64((__m128i*)p, _mm_packs_epi32(i, i));
+		}
+		inline void store16(uint16_t* p, const f4& a) {
+			// biased into the signed range for the saturating pack, sse2 has no unsigned one
+			const __m128i i = _mm_sub_epi32(_mm_cvttps_epi32(a), _mm_set1_epi32(32768));
+			_mm_storel_epi64((__m128i*)p, _mm_xor_si128(_mm_packs_epi32(i, i), _mm_set1_epi16(-32768)));
+		}
+		inline void load16(const int16_t* p, f4& a) {
+			const __m128i v = _mm_loadl_epi64((const __m128i*)p);
+			a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+		}
+		inline void load16(const uint16_t* p, f4& a) { a = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128())); }
+		inline void store32(int32_t* p, const f4& a) { _mm_storeu_si128((__m128i*)p, _mm_cvttps_epi32(a)); }
+		inline void load32(const int32_t* p, f4& a) { a = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p)); }
+		inline f4 ftoi(const f4& a) { return _mm_castsi128_ps(_mm_cvttps_epi32(a)); }
+		inline f4 itof(const f4& a) { return _mm_cvtepi32_ps(_mm_castps_si128(a)); }
+#if PXL_SIMD_HALF
+		inline void store_half(uint16_t* p, const f4& a) { _mm_storel_epi64((__m128i*)p, _mm_cvtps_ph(a, 0)); }
+		inline void load_half(const uint16_t* p, f4& a) { a = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)p)); }
+#endif
+#endif
+#if PXL_SIMD == PXL_SIMD_AVX2
+		inline void store16(int16_t* p, const f8& a) {
+			const __m256i i = _mm256_cvttps_epi32(a);
+			_mm_storeu_si128((__m128i*)p, _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+		}
+		inline void store16(uint16_t* p, const f8& a) {
+			const __m256i i = _mm256_cvttps_epi32(a);
+			_mm_storeu_si128((__m128i*)p, _mm_packus_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+		}
+		inline void load16(const int16_t* p, f8& a) { a = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+		inline void load16(const uint16_t* p, f8& a) { a = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+		inline void store32(int32_t* p, const f8& a) { _mm256_storeu_si256((__m256i*)p, _mm256_cvttps_epi32(a)); }
+		inline void load32(const int32_t* p, f8& a) { a = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p)); }
+		inline f8 ftoi(const f8& a) { return _mm256_castsi256_ps(_mm256_cvttps_epi32(a)); }
+		inline f8 itof(const f8& a) { return _mm256_cvtepi32_ps(_mm256_castps_si256(a)); }
+#if PXL_SIMD_HALF
+		inline void store_half(uint16_t* p, const f8& a) { _mm_storeu_si128((__m128i*)p, _mm256_cvtps_ph(a, 0)); }
+		inline void load_half(const uint16_t* p, f8& a) { a = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p)); }
+#endif
+#else
+		inline f8 ftoi(const f8& a) { return { ftoi(a.lo), ftoi(a.hi) }; }
+		inline f8 itof(const f8& a) { return { itof(a.lo), itof(a.hi) }; }
+#endif
+
+		// n floats to snorm16 (I of int16_t) or unorm16 (uint16_t) and back over the leading whole blocks of V,
+		// rounding like the scalar conversions, returns the count done. Lanes holding nan are unspecified on neon.
+		template<typename V, typename I> inline size_t pack_norm16(const float* in, I* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const bool sign = I(-1) < 0;
+			const V lo = broadcast<V>(sign ? -1.0f : 0.0f), hi = broadcast<V>(1), s = broadcast<V>(sign ? 32767.0f : 65535.0f),
+				zero = broadcast<V>(0), h = broadcast<V>(0.5f), nh = broadcast<V>(-0.5f);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				const V c = min(max(load<V>(in + i), lo), hi);
+				store16(out + i, add(mul(c, s), select(cmplt(c, zero), nh, h)));
+			}
+			return i;
+		}
+		template<typename V, typename I> inline size_t unpack_norm16(const I* in, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const bool sign = I(-1) < 0;
+			const V s = broadcast<V>(sign ? 1.0f / 32767 : 1.0f / 65535), lo = broadcast<V>(-1);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V v;
+				load16(in + i, v);
+				v = mul(v, s);
+				store(out + i, sign ? max(v, lo) : v);
+			}
+			return i;
+		}
+#if PXL_SIMD_HALF
+		template<typename V> inline size_t pack_half(const float* in, uint16_t* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) store_half(out + i, load<V>(in + i));
+			return i;
+		}
+		template<typename V> inline size_t unpack_half(const uint16_t* in, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V v;
+				load_half(in + i, v);
+				store(out + i, v);
+			}
+			return i;
+		}
+#endif
+
+		// { x0 y0 z0 x1 } { y1 z1 x2 y2 } { z2 x3 y3 z3 } <-> { x0 x1 x2 x3 } { y0 y1 y2 y3 } { z0 z1 z2 z3 }
+		template<typename V> inline void deinterleave3(const V& v0, const V& v1, const V& v2, V& x, V& y, V& z) {
+			x = shuffle<0, 3, 0, 3>(v0, shuffle<2, 3, 0, 1>(v1, v2));
+			y = shuffle<0, 2, 0, 2>(shuffle<1, 2, 0, 1>(v0, v1), shuffle<3, 3, 2, 2>(v1, v2));
+			z = shuffle<0, 2, 0, 2>(shuffle<2, 2, 1, 1>(v0, v1), shuffle<0, 0, 3, 3>(v2, v2));
+		}
+		template<typename V> inline void interleave3(const V& x, const V& y, const V& z, V& v0, V& v1, V& v2) {
+			v0 = shuffle<0, 2, 0, 2>(shuffle<0, 1, 0, 1>(x, y), shuffle<0, 0, 1, 1>(z, x));
+			v1 = shuffle<0, 2, 0, 2>(shuffle<1, 1, 1, 1>(y, z), shuffle<2, 2, 2, 2>(x, y));
+			v2 = shuffle<0, 2, 0, 2>(shuffle<2, 2, 3, 3>(z, x), shuffle<3, 3, 3, 3>(y, z));
+		}
+		template<typename V> inline void transpose(V& r0, V& r1, V& r2, V& r3) {
+			const V t0 = shuffle<0, 1, 0, 1>(r0, r1), t1 = shuffle<2, 3, 2, 3>(r0, r1),
+				t2 = shuffle<0, 1, 0, 1>(r2, r3), t3 = shuffle<2, 3, 2, 3>(r2, r3);
+			r0 = shuffle<0, 2, 0, 2>(t0, t2); r1 = shuffle<1, 3, 1, 3>(t0, t2);
+			r2 = shuffle<0, 2, 0, 2>(t1, t3); r3 = shuffle<1, 3, 1, 3>(t1, t3);
+		}
+		inline void load3(const float* p, f4& x, f4& y, f4& z) {
+#if PXL_SIMD == PXL_SIMD_NEON
+			const float32x4x3_t v = vld3q_f32(p);
+			x = v.val[0]; y = v.val[1]; z = v.val[2];
+#else
+			deinterleave3(load(p), load(p + 4), load(p + 8), x, y, z);
+#endif
+		}
+		inline void store3(float* p, const f4& x, const f4& y, const f4& z) {
+#if PXL_SIMD == PXL_SIMD_NEON
+			const float32x4x3_t v{ { x, y, z } };
+			vst3q_f32(p, v);
+#else
+			f4 v0, v1, v2;
+			interleave3(x, y, z, v0, v1, v2);
+			store(p, v0); store(p + 4, v1); store(p + 8, v2);
+#endif
+		}
+#if PXL_SIMD == PXL_SIMD_AVX2
+		inline void load3(const float* p, f8& x, f8& y, f8& z) {
+			deinterleave3(load(p, p + 12), load(p + 4, p + 16), load(p + 8, p + 20), x, y, z);
+		}
+		inline void store3(float* p, const f8& x, const f8& y, const f8& z) {
+			f8 v0, v1, v2;
+			interleave3(x, y, z, v0, v1, v2);
+			store(p, p + 12, v0); store(p + 4, p + 16, v1); store(p + 8, p + 20, v2);
+		}
+#else
+		inline void load3(const float* p, f8& x, f8& y, f8& z) { load3(p, x.lo, y.lo, z.lo); load3(p + 12, x.hi, y.hi, z.hi); }
+		inline void store3(float* p, const f8& x, const f8& y, const f8& z) { store3(p, x.lo, y.lo, z.lo); store3(p + 12, x.hi, y.hi, z.hi); }
+#endif
+		// { x0 y0 z0 w0 } .. { x1 y1 z1 w1 } .. <-> { x0 x1 x2 x3 } { y0 y1 y2 y3 } .., groups stride floats apart
+		inline void load4(const float* p, const size_t& stride, f4& x, f4& y, f4& z, f4& w) {
+			x = load(p); y = load(p + stride); z = load(p + 2 * stride); w = load(p + 3 * stride);
+			transpose(x, y, z, w);
+		}
+		inline void store4(float* p, const size_t& stride, f4 x, f4 y, f4 z, f4 w) {
+			transpose(x, y, z, w);
+			store(p, x); store(p + stride, y); store(p + 2 * stride, z); store(p + 3 * stride, w);
+		}
+		inline void load4(const float* p, const size_t& stride, f8& x, f8& y, f8& z, f8& w) {
+			x = load(p, p + 4 * stride); y = load(p + stride, p + 5 * stride); z = load(p + 2 * stride, p + 6 * stride); w = load(p + 3 * stride, p + 7 * stride);
+			transpose(x, y, z, w);
+		}
+		inline void store4(float* p, const size_t& stride, f8 x, f8 y, f8 z, f8 w) {
+			transpose(x, y, z, w);
+			store(p, p + 4 * stride, x); store(p + stride, p + 5 * stride, y); store(p + 2 * stride, p + 6 * stride, z); store(p + 3 * stride, p + 7 * stride, w);
+		}
+		// contiguous groups, stride 4
+		inline void load4(const float* p, f4& x, f4& y, f4& z, f4& w) {
+#if PXL_SIMD == PXL_SIMD_NEON
+			const float32x4x4_t v = vld4q_f32(p);
+			x = v.val[0]; y = v.val[1]; z = v.val[2]; w = v.val[3];
+#else
+			load4(p, 4, x, y, z, w);
+#endif
+		}
+		inline void store4(float* p, f4 x, f4 y, f4 z, f4 w) {
+#if PXL_SIMD == PXL_SIMD_NEON
+			const float32x4x4_t v{ { x, y, z, w } };
+			vst4q_f32(p, v);
+#else
+			store4(p, 4, x, y, z, w);
+#endif
+		}
+		inline void load4(const float* p, f8& x, f8& y, f8& z, f8& w) { load4(p, 4, x, y, z, w); }
+		inline void store4(float* p, f8 x, f8 y, f8 z, f8 w) { store4(p, 4, x, y, z, w); }
+
+		// 2x2 row-major blocks: a*b, adj(a)*b, a*adj(b)
+		inline f4 mat2_mul(const f4& a, const f4& b) {
+			return add(mul(a, swizzle<0, 3, 0, 3>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+		}
+		inline f4 mat2_adjmul(const f4& a, const f4& b) {
+			return sub(mul(swizzle<3, 3, 0, 0>(a), b), mul(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+		}
+		inline f4 mat2_muladj(const f4& a, const f4& b) {
+			return sub(mul(a, swizzle<3, 0, 3, 0>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+		}
+
+		inline void mat4_mul(const float* a, const float* b, float* out) {
+#if PXL_SIMD == PXL_SIMD_AVX2
+			const __m256 b0 = _mm256_broadcast_ps((const __m128*)(b + 0));
+			const __m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+			const __m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+			const __m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+			const __m256 a01 = _mm256_loadu_ps(a), a23 = _mm256_loadu_ps(a + 8);
+			__m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+			__m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+			r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xaa), b2));
+			r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xaa), b2));
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xff), b3));
+			r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xff), b3));
+			_mm256_storeu_ps(out, r01);
+			_mm256_storeu_ps(out + 8, r23);
+#else
+			const f4 b0 = load(b), b1 = load(b + 4), b2 = load(b + 8), b3 = load(b + 12);
+			f4 r[4];
+			for (int i = 0; i < 4; ++i) {
+				const f4 ai = load(a + 4 * i);
+				r[i] = mul(splat<0>(ai), b0);
+				r[i] = add(r[i], mul(splat<1>(ai), b1));
+				r[i] = add(r[i], mul(splat<2>(ai), b2));
+				r[i] = add(r[i], mul(splat<3>(ai), b3));
+			}
+			store(out, r[0]); store(out + 4, r[1]); store(out + 8, r[2]); store(out + 12, r[3]);
+#endif
+		}
+		// a * b for bottom rows 0 0 0 1
+		inline void mat4_mul_affine(const float* a, const float* b, float* out) {
+			const f4 b0 = load(b), b1 = load(b + 4), b2 = load(b + 8), w = setr(0, 0, 0, 1);
+#if PXL_SIMD == PXL_SIMD_AVX2
+			const __m256 a01 = _mm256_loadu_ps(a), w01 = _mm256_setr_ps(0, 0, 0, 1, 0, 0, 0, 1);
+			__m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), _mm256_broadcast_ps((const __m128*)(b + 0)));
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), _mm256_broadcast_ps((const __m128*)(b + 4))));
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xaa), _mm256_broadcast_ps((const __m128*)(b + 8))));
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(a01, w01));
+			const f4 a2 = load(a + 8);
+			f4 r2 = mul(splat<0>(a2), b0);
+			r2 = add(r2, mul(splat<1>(a2), b1));
+			r2 = add(r2, mul(splat<2>(a2), b2));
+			_mm256_storeu_ps(out, r01);
+			store(out + 8, add(r2, mul(a2, w))); store(out + 12, w);
+#else
+			f4 r[3];
+			for (int i = 0; i < 3; ++i) {
+				const f4 ai = load(a + 4 * i);
+				r[i] = mul(splat<0>(ai), b0);
+				r[i] = add(r[i], mul(splat<1>(ai), b1));
+				r[i] = add(r[i], mul(splat<2>(ai), b2));
+				r[i] = add(r[i], mul(ai, w));
+			}
+			store(out, r[0]); store(out + 4, r[1]); store(out + 8, r[2]); store(out + 12, w);
+#endif
+		}
+		// blocks A B / C D of m, their determinants (|A| |B| |C| |D|), adj(A)*B, adj(D)*C and |m| in every lane
+		struct mat4_blocks {
+			f4 a, b, c, d, dets, ab, dc, det;
+			inline mat4_blocks(const float* m) {
+				const f4 r0 = load(m), r1 = load(m + 4), r2 = load(m + 8), r3 = load(m + 12);
+				a = shuffle<0, 1, 0, 1>(r0, r1); b = shuffle<2, 3, 2, 3>(r0, r1);
+				c = shuffle<0, 1, 0, 1>(r2, r3); d = shuffle<2, 3, 2, 3>(r2, r3);
+				dets = sub(mul(shuffle<0, 2, 0, 2>(r0, r2), shuffle<1, 3, 1, 3>(r1, r3)),
+					mul(shuffle<1, 3, 1, 3>(r0, r2), shuffle<0, 2, 0, 2>(r1, r3)));
+				ab = mat2_adjmul(a, b);
+				dc = mat2_adjmul(d, c);
+				f4 tr = mul(ab, swizzle<0, 2, 1, 3>(dc));
+				tr = add(tr, swizzle<2, 3, 0, 1>(tr));
+				tr = add(tr, swizzle<1, 0, 3, 2>(tr));
+				det = sub(add(mul(splat<0>(dets), splat<3>(dets)), mul(splat<1>(dets), splat<2>(dets))), tr);
+			}
+		};
+		inline float mat4_det(const float* m) { return first(mat4_blocks(m).det); }
+		// every element ==, or within mathf::approx_equal
+		inline bool mat4_equal(const float* a, const float* b) {
+			const f4 e = band(band(cmpeq(load(a), load(b)), cmpeq(load(a + 4), load(b + 4))),
+				band(cmpeq(load(a + 8), load(b + 8)), cmpeq(load(a + 12), load(b + 12))));
+			return movemask(e) == 15;
+		}
+		inline bool mat4_approx_equal(const float* a, const float* b, const float& eps) {
+			const f4 abs = set1(mathf::bit_cast<float>(0x7fffffffu)), one = set1(1), e = set1(eps);
+			f4 r = set1(mathf::bit_cast<float>(~0u));
+			for (int i = 0; i < 16; i += 4) {
+				const f4 x = load(a + i), y = load(b + i), d = band(sub(x, y), abs);
+				const f4 t = mul(e, max(one, max(band(x, abs), band(y, abs))));
+				r = band(r, bor(cmpeq(x, y), cmple(d, t)));
+			}
+			return movemask(r) == 15;
+		}
+		inline float mat4_inverse(const float* m, float* out) {
+			const mat4_blocks k(m);
+			const float det = first(k.det);
+			if (det) {
+				const f4 rdet = div(setr(1, -1, -1, 1), k.det);
+				const f4 x = mul(sub(mul(splat<3>(k.dets), k.a), mat2_mul(k.b, k.dc)), rdet);
+				const f4 w = mul(sub(mul(splat<0>(k.dets), k.d), mat2_mul(k.c, k.ab)), rdet);
+				const f4 y = mul(sub(mul(splat<1>(k.dets), k.c), mat2_muladj(k.d, k.ab)), rdet);
+				const f4 z = mul(sub(mul(splat<2>(k.dets), k.b), mat2_muladj(k.a, k.dc)), rdet);
+				store(out, shuffle<3, 1, 3, 1>(x, y));
+				store(out + 4, shuffle<2, 0, 2, 0>(x, y));
+				store(out + 8, shuffle<3, 1, 3, 1>(z, w));
+				store(out + 12, shuffle<2, 0, 2, 0>(z, w));
+			}
+			return det;
+		}
+
+		// m * (v, 1) for points or m * (v, 0) for directions over the leading whole blocks of V, returns the count done
+		template<typename V, bool point> inline size_t mat4_transform3(const float* m, const float* in, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			V r[12];
+			for (int i = 0; i < 12; ++i) r[i] = broadcast<V>(m[i]);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V x, y, z;
+				load3(in + 3 * i, x, y, z);
+				V ox = add(add(mul(r[0], x), mul(r[1], y)), mul(r[2], z));
+				V oy = add(add(mul(r[4], x), mul(r[5], y)), mul(r[6], z));
+				V oz = add(add(mul(r[8], x), mul(r[9], y)), mul(r[10], z));
+				if (point) { ox = add(ox, r[3]); oy = add(oy, r[7]); oz = add(oz, r[11]); }
+				store3(out + 3 * i, ox, oy, oz);
+			}
+			return i;
+		}
+		inline void mat4_transform4(const float* m, const float* in, float* out, const size_t& n) {
+			f4 c0 = load(m), c1 = load(m + 4), c2 = load(m + 8), c3 = load(m + 12);
+			transpose(c0, c1, c2, c3);
+			size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+			const __m256 w0 = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c0, 1);
+			const __m256 w1 = _mm256_insertf128_ps(_mm256_castps128_ps256(c1), c1, 1);
+			const __m256 w2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c2), c2, 1);
+			const __m256 w3 = _mm256_insertf128_ps(_mm256_castps128_ps256(c3), c3, 1);
+			for (; i + 2 <= n; i += 2) {
+				const __m256 v = _mm256_loadu_ps(in + 4 * i);
+				__m256 o = _mm256_mul_ps(w0, _mm256_shuffle_ps(v, v, 0x00));
+				o = _mm256_add_ps(o, _mm256_mul_ps(w1, _mm256_shuffle_ps(v, v, 0x55)));
+				o = _mm256_add_ps(o, _mm256_mul_ps(w2, _mm256_shuffle_ps(v, v, 0xaa)));
+				o = _mm256_add_ps(o, _mm256_mul_ps(w3, _mm256_shuffle_ps(v, v, 0xff)));
+				_mm256_storeu_ps(out + 4 * i, o);
+			}
+#endif
+			for (; i < n; ++i) {
+				const f4 v = load(in + 4 * i);
+				f4 o = mul(c0, splat<0>(v));
+				o = add(o, mul(c1, splat<1>(v)));
+				o = add(o, mul(c2, splat<2>(v)));
+				o = add(o, mul(c3, splat<3>(v)));
+				store(out + 4 * i, o);
+			}
+		}
+
+		// |x| <= pi/2, odd taylor series to x^11, max error 6e-8
+		template<typename V> inline V sin_halfpi(const V& x) {
+			const V x2 = mul(x, x);
+			V p = broadcast<V>(-2.505210839e-8f);
+			p = add(mul(p, x2), broadcast<V>(2.755731922e-6f));
+			p = add(mul(p, x2), broadcast<V>(-1.984126984e-4f));
+			p = add(mul(p, x2), broadcast<V>(8.333333333e-3f));
+			p = add(mul(p, x2), broadcast<V>(-1.666666667e-1f));
+			return add(x, mul(mul(p, x2), x));
+		}
+		// 0 <= x <= 1, abramowitz and stegun 4.4.46, max error 2e-8
+		template<typename V> inline V acos_unit(const V& x) {
+			V p = broadcast<V>(-0.0012624911f);
+			p = add(mul(p, x), broadcast<V>(0.0066700901f));
+			p = add(mul(p, x), broadcast<V>(-0.0170881256f));
+			p = add(mul(p, x), broadcast<V>(0.0308918810f));
+			p = add(mul(p, x), broadcast<V>(-0.0501743046f));
+			p = add(mul(p, x), broadcast<V>(0.0889789874f));
+			p = add(mul(p, x), broadcast<V>(-0.2145988016f));
+			p = add(mul(p, x), broadcast<V>(1.5707963050f));
+			return mul(p, sqrt(max(sub(broadcast<V>(1), x), broadcast<V>(0))));
+		}
+		// sin and cos of |x| <= 8192 together, reduced by the nearest multiple of pi / 2 in three parts (cody-waite) to
+		// |r| <= pi / 4 with the quadrant picked by select. fast: degree 5 and 4 minimax, max error 1.3e-5;
+		// standard and exact: the cephes sinf/cosf polynomials, max error 1e-7
+		template<mathf::precision P, typename V> inline void sincos(const V& x, V& s, V& c) {
+			const V one = broadcast<V>(1), two = broadcast<V>(2), three = broadcast<V>(3), sign = broadcast<V>(-0.0f),
+				magic = broadcast<V>(12582912.0f); // 1.5 * 2^23, adding and subtracting it rounds to an integer
+			const V n = sub(add(mul(x, broadcast<V>(0.636619772f)), magic), magic);
+			const V r = sub(sub(sub(x, mul(n, broadcast<V>(1.5703125f))), mul(n, broadcast<V>(4.837512969970703125e-4f))), mul(n, broadcast<V>(7.54978995489188216e-8f)));
+			const V q = sub(n, mul(broadcast<V>(4), sub(add(sub(mul(n, broadcast<V>(0.25f)), broadcast<V>(0.375f)), magic), magic))); // n mod 4
+			const V r2 = mul(r, r);
+			V ps, pc;
+			if (P == mathf::precision::fast) {
+				ps = mul(r, add(broadcast<V>(0.99999849f), mul(r2, add(broadcast<V>(-0.16662383f), mul(r2, broadcast<V>(0.0081500694f))))));
+				pc = add(one, mul(r2, add(broadcast<V>(-0.49977631f), mul(r2, broadcast<V>(0.040488936f)))));
+			}
+			else {
+				V p = add(mul(broadcast<V>(-1.9515295891e-4f), r2), broadcast<V>(8.3321608736e-3f));
+				p = add(mul(p, r2), broadcast<V>(-1.6666654611e-1f));
+				ps = add(r, mul(mul(p, r2), r));
+				p = add(mul(broadcast<V>(2.443315711809948e-5f), r2), broadcast<V>(-1.388731625493765e-3f));
+				p = add(mul(p, r2), broadcast<V>(4.166664568298827e-2f));
+				pc = add(sub(one, mul(broadcast<V>(0.5f), r2)), mul(mul(p, r2), r2));
+			}
+			const V odd = bor(cmpeq(q, one), cmpeq(q, three));
+			s = bxor(select(odd, pc, ps), band(cmple(two, q), sign));
+			c = bxor(select(odd, ps, pc), band(bor(cmpeq(q, one), cmpeq(q, two)), sign));
+		}
+		// atan2(y, x) from the octant, atan of min(|x|, |y|) / max(|x|, |y|) in [0, 1] then mirrored by select.
+		// fast: degree 9 minimax, max error 1.2e-5; standard and exact: reduced by pi / 4 above tan(pi / 8) and the
+		// cephes atanf polynomial, within 2 ulp of libm. atan2(0, -0) is 0 rather than pi
+		template<mathf::precision P, typename V> inline V atan2(const V& y, const V& x) {
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), sign = broadcast<V>(-0.0f), abs = broadcast<V>(mathf::bit_cast<float>(0x7fffffffu));
+			const V ax = band(x, abs), ay = band(y, abs), r = div(min(ax, ay), max(max(ax, ay), broadcast<V>(FLT_MIN)));
+			V a;
+			if (P == mathf::precision::fast) {
+				const V z = mul(r, r);
+				V p = add(mul(broadcast<V>(0.020845112f), z), broadcast<V>(-0.085156348f));
+				p = add(mul(p, z), broadcast<V>(0.18015929f));
+				p = add(mul(p, z), broadcast<V>(-0.33030479f));
+				p = add(mul(p, z), broadcast<V>(0.99986633f));
+				a = mul(p, r);
+			}
+			else {
+				const V big = cmplt(broadcast<V>(0.414213562f), r), t = select(big, div(sub(r, one), add(r, one)), r), z = mul(t, t);
+				V p = add(mul(broadcast<V>(8.05374449538e-2f), z), broadcast<V>(-1.38776856032e-1f));
+				p = add(mul(p, z), broadcast<V>(1.99777106478e-1f));
+				p = add(mul(p, z), broadcast<V>(-3.33329491539e-1f));
+				a = add(select(big, broadcast<V>(0.785398163f), zero), add(t, mul(mul(p, z), t)));
+			}
+			a = select(cmplt(ax, ay), sub(broadcast<V>(mathf::halfpi), a), a);
+			a = select(cmplt(x, zero), sub(broadcast<V>(mathf::pi), a), a);
+			return bxor(a, band(y, sign));
+		}
+		template<mathf::precision P, typename V> inline V sin(const V& x) { V s, c; sincos<P>(x, s, c); return s; }
+		template<mathf::precision P, typename V> inline V cos(const V& x) { V s, c; sincos<P>(x, s, c); return c; }
+		template<mathf::precision P, typename V> inline V tan(const V& x) { V s, c; sincos<P>(x, s, c); return div(s, c); }
+		template<mathf::precision P, typename V> inline V atan(const V& x) { return atan2<P>(x, broadcast<V>(1)); }
+		// asin(s) = s + s z p(z) for 0 <= s <= 1 / 2 and z = s^2, the reduction of asin and acos. Above 1 / 2 they take
+		// s = sqrt(z) with z = (1 - |x|) / 2 and asin(|x|) = pi / 2 - 2 asin(s), acos(x) = 2 asin(s) or pi - 2 asin(s).
+		// fast: degree 2 minimax, standard and exact: the cephes asinf polynomial. |x| > 1 gives nan
+		template<mathf::precision P, typename V> inline V asin_half(const V& a, const V& big) {
+			const V half = broadcast<V>(0.5f), z = select(big, mul(half, sub(broadcast<V>(1), a)), mul(a, a)), s = select(big, sqrt(z), a);
+			V p;
+			if (P == mathf::precision::fast) {
+				p = add(mul(broadcast<V>(0.095988310f), z), broadcast<V>(0.16453878f));
+				p = add(mul(p, z), broadcast<V>(1.0000311f));
+				return mul(s, p);
+			}
+			p = add(mul(broadcast<V>(4.2163199048e-2f), z), broadcast<V>(2.4181311049e-2f));
+			p = add(mul(p, z), broadcast<V>(4.5470025998e-2f));
+			p = add(mul(p, z), broadcast<V>(7.4953002686e-2f));
+			p = add(mul(p, z), broadcast<V>(1.6666752422e-1f));
+			return add(s, mul(mul(s, z), p));
+		}
+		template<mathf::precision P, typename V> inline V asin(const V& x) {
+			const V a = band(x, broadcast<V>(mathf::bit_cast<float>(0x7fffffffu))), big = cmplt(broadcast<V>(0.5f), a), t = asin_half<P>(a, big);
+			return bxor(select(big, sub(broadcast<V>(mathf::halfpi), add(t, t)), t), band(x, broadcast<V>(-0.0f)));
+		}
+		template<mathf::precision P, typename V> inline V acos(const V& x) {
+			const V a = band(x, broadcast<V>(mathf::bit_cast<float>(0x7fffffffu))), big = cmplt(broadcast<V>(0.5f), a), t = asin_half<P>(a, big);
+			const V t2 = add(t, t), neg = cmplt(x, broadcast<V>(0));
+			return select(big, select(neg, sub(broadcast<V>(mathf::pi), t2), t2), sub(broadcast<V>(mathf::halfpi), bxor(t, band(x, broadcast<V>(-0.0f)))));
+		}
+		// e^x = 2^n e^r with n = round(x / ln 2) and |r| <= ln 2 / 2 reduced in two parts, 2^n written straight into the
+		// exponent bits (split in two at n = 128). fast: degree 4 minimax, standard and exact: the cephes expf polynomial.
+		// Overflow gives infinity, results below 2^-126 go subnormal and flush to 0 under about -87.7
+		template<mathf::precision P, typename V> inline V exp(const V& x) {
+			const V one = broadcast<V>(1), magic = broadcast<V>(12582912.0f);
+			const V xc = min(max(x, broadcast<V>(-88.0f)), broadcast<V>(89.0f));
+			const V n = sub(add(mul(xc, broadcast<V>(1.44269504f)), magic), magic);
+			const V r = sub(sub(xc, mul(n, broadcast<V>(0.693359375f))), mul(n, broadcast<V>(-2.12194440e-4f)));
+			V p;
+			if (P == mathf::precision::fast) {
+				p = add(mul(broadcast<V>(0.041277746f), r), broadcast<V>(0.16753514f));
+				p = add(mul(p, r), broadcast<V>(0.50005116f));
+			}
+			else {
+				p = add(mul(broadcast<V>(1.9875691500e-4f), r), broadcast<V>(1.3981999507e-3f));
+				p = add(mul(p, r), broadcast<V>(8.3334519073e-3f));
+				p = add(mul(p, r), broadcast<V>(4.1665795894e-2f));
+				p = add(mul(p, r), broadcast<V>(1.6666665459e-1f));
+				p = add(mul(p, r), broadcast<V>(5.0000001201e-1f));
+			}
+			const V e = add(add(one, r), mul(mul(r, r), p)), m = min(n, broadcast<V>(127));
+			const V y = mul(mul(e, add(sub(n, m), one)), ftoi(mul(add(m, broadcast<V>(127)), broadcast<V>(8388608.0f))));
+			return select(cmpeq(x, x), y, x);
+		}
+		// log of x = m 2^e with sqrt(1 / 2) <= m < sqrt(2) from the exponent and mantissa bits. fast: 2 atanh((m - 1) / (m + 1))
+		// to degree 3, standard and exact: the cephes logf polynomial in m - 1. Subnormal x is taken as 0 and gives -infinity,
+		// negative x and nan give nan
+		template<mathf::precision P, typename V> inline V log(const V& x) {
+			const V zero = broadcast<V>(0), one = broadcast<V>(1);
+			V e = sub(mul(itof(band(x, broadcast<V>(mathf::bit_cast<float>(0x7f800000u)))), broadcast<V>(1.0f / 8388608)), broadcast<V>(126));
+			V m = bor(band(x, broadcast<V>(mathf::bit_cast<float>(0x007fffffu))), broadcast<V>(0.5f));
+			const V lo = cmplt(m, broadcast<V>(0.707106781f));
+			e = sub(e, band(lo, one));
+			m = add(m, band(lo, m));
+			const V f = sub(m, one);
+			V y;
+			if (P == mathf::precision::fast) {
+				const V t = div(f, add(m, one));
+				y = add(mul(t, add(mul(mul(t, t), broadcast<V>(0.67867794f)), broadcast<V>(1.9999555f))), mul(e, broadcast<V>(0.693147181f)));
+			}
+			else {
+				const V z = mul(f, f);
+				V p = add(mul(broadcast<V>(7.0376836292e-2f), f), broadcast<V>(-1.1514610310e-1f));
+				p = add(mul(p, f), broadcast<V>(1.1676998740e-1f));
+				p = add(mul(p, f), broadcast<V>(-1.2420140846e-1f));
+				p = add(mul(p, f), broadcast<V>(1.4249322787e-1f));
+				p = add(mul(p, f), broadcast<V>(-1.6668057665e-1f));
+				p = add(mul(p, f), broadcast<V>(2.0000714765e-1f));
+				p = add(mul(p, f), broadcast<V>(-2.4999993993e-1f));
+				p = add(mul(p, f), broadcast<V>(3.3333331174e-1f));
+				y = add(mul(mul(f, z), p), mul(e, broadcast<V>(-2.12194440e-4f)));
+				y = sub(y, mul(broadcast<V>(0.5f), z));
+				y = add(add(f, y), mul(e, broadcast<V>(0.693359375f)));
+			}
+			y = select(cmplt(x, broadcast<V>(FLT_MIN)), broadcast<V>(-mathf::infinity), y);
+			y = select(cmplt(broadcast<V>(FLT_MAX), x), x, y);
+			return select(cmple(zero, x), y, broadcast<V>(mathf::nan));
+		}
+		// x^y as exp(y log |x|) with the tiers above, the error grows with |y log x| as the rounding of log is scaled by y.
+		// Negative x needs an integer y (odd ones flip the sign) or gives nan, pow(x, 0) is 1
+		template<mathf::precision P, typename V> inline V pow(const V& x, const V& y) {
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), sign = broadcast<V>(-0.0f), abs = broadcast<V>(mathf::bit_cast<float>(0x7fffffffu)),
+				magic = broadcast<V>(12582912.0f);
+			const V ay = band(y, abs), r = exp<P>(mul(y, log<P>(band(x, abs))));
+			// |y| - 2 round(|y| / 2) is 0 or +-1 for integers below 2^24, above that every float is an even integer
+			const V k = sub(add(mul(ay, broadcast<V>(0.5f)), magic), magic), d = band(sub(ay, add(k, k)), abs);
+			const V wide = cmple(broadcast<V>(16777216.0f), ay), odd = band(cmpeq(d, one), cmplt(ay, broadcast<V>(16777216.0f)));
+			const V neg = select(bor(wide, bor(cmpeq(d, zero), odd)), bxor(r, band(odd, sign)), broadcast<V>(mathf::nan));
+			return select(cmpeq(y, zero), one, select(cmplt(x, zero), neg, r));
+		}
+
+		// v += 2w(u x v) + 2u x (u x v), same as quatf::rotate
+		template<typename V> inline void quat_rotate(const V& qx, const V& qy, const V& qz, const V& qw, V& x, V& y, V& z) {
+			const V two = broadcast<V>(2);
+			const V tx = mul(two, sub(mul(qy, z), mul(qz, y)));
+			const V ty = mul(two, sub(mul(qz, x), mul(qx, z)));
+			const V tz = mul(two, sub(mul(qx, y), mul(qy, x)));
+			x = add(add(x, mul(qw, tx)), sub(mul(qy, tz), mul(qz, ty)));
+			y = add(add(y, mul(qw, ty)), sub(mul(qz, tx), mul(qx, tz)));
+			z = add(add(z, mul(qw, tz)), sub(mul(qx, ty), mul(qy, tx)));
+		}
+		// a = slerp(a, b, t) per lane along the shortest arc, 0 <= t <= 1
+		// lanes with cos(angle) > 0.9995 use nlerp, all lanes are renormalized
+		template<typename V> inline void quat_slerp(V& ax, V& ay, V& az, V& aw, const V& bx, const V& by, const V& bz, const V& bw, const V& t) {
+			const V one = broadcast<V>(1);
+			V d = add(add(add(mul(ax, bx), mul(ay, by)), mul(az, bz)), mul(aw, bw));
+			const V sign = select(cmplt(d, broadcast<V>(0)), broadcast<V>(-1), one);
+			d = mul(d, sign);
+			const V nl = cmplt(broadcast<V>(0.9995f), d);
+			const V th = acos_unit(d), u = sub(one, t);
+			const V rs = div(one, max(sqrt(max(sub(one, mul(d, d)), broadcast<V>(0))), broadcast<V>(mathf::epsilon)));
+			const V wa = select(nl, u, mul(sin_halfpi(mul(u, th)), rs));
+			const V wb = mul(select(nl, t, mul(sin_halfpi(mul(t, th)), rs)), sign);
+			ax = add(mul(ax, wa), mul(bx, wb));
+			ay = add(mul(ay, wa), mul(by, wb));
+			az = add(mul(az, wa), mul(bz, wb));
+			aw = add(mul(aw, wa), mul(bw, wb));
+			const V r = rsqrt<mathf::precision::standard>(add(add(add(mul(ax, ax), mul(ay, ay)), mul(az, az)), mul(aw, aw)));
+			ax = mul(ax, r); ay = mul(ay, r); az = mul(az, r); aw = mul(aw, r);
+		}
+		// rotates vec3f arrays by one quatf, or by q[i] when each, over the leading whole blocks of V, returns the count done
+		template<typename V, bool each> inline size_t quat_rotate3(const float* q, const float* in, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			V qx = broadcast<V>(each ? 0 : q[0]), qy = broadcast<V>(each ? 0 : q[1]), qz = broadcast<V>(each ? 0 : q[2]), qw = broadcast<V>(each ? 0 : q[3]);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				if (each) load4(q + 4 * i, qx, qy, qz, qw);
+				V x, y, z;
+				load3(in + 3 * i, x, y, z);
+				quat_rotate(qx, qy, qz, qw, x, y, z);
+				store3(out + 3 * i, x, y, z);
+			}
+			return i;
+		}
+		// slerp of quatf arrays by one t, or by t[i] when each, over the leading whole blocks of V, returns the count done
+		template<typename V, bool each> inline size_t quat_slerp4(const float* a, const float* b, const float* t, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			V tv = broadcast<V>(each ? 0 : t[0]);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				if (each) tv = load<V>(t + i);
+				V ax, ay, az, aw, bx, by, bz, bw;
+				load4(a + 4 * i, ax, ay, az, aw);
+				load4(b + 4 * i, bx, by, bz, bw);
+				quat_slerp(ax, ay, az, aw, bx, by, bz, bw, tv);
+				store4(out + 4 * i, ax, ay, az, aw);
+			}
+			return i;
+		}
+
+		// quatf::from_euler and quatf::to_euler over the leading whole blocks of V, returns the count done. The gimbal
+		// lock lanes of to_euler feed atan2(x, w) through the first atan2 and pick their angles by select
+		template<mathf::precision P, typename V> inline size_t quat_from_euler(const float* in, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V half = broadcast<V>(0.5f);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V x, y, z, x0, x1, y0, y1, z0, z1;
+				load3(in + 3 * i, x, y, z);
+				sincos<P>(mul(x, half), x1, x0);
+				sincos<P>(mul(y, half), y1, y0);
+				sincos<P>(mul(z, half), z1, z0);
+				const V y0z0 = mul(y0, z0), y0z1 = mul(y0, z1), y1z0 = mul(y1, z0), y1z1 = mul(y1, z1);
+				store4(out + 4 * i, add(mul(y0z0, x1), mul(y1z1, x0)), add(mul(y1z0, x0), mul(y0z1, x1)),
+					sub(mul(y0z1, x0), mul(y1z0, x1)), sub(mul(y0z0, x0), mul(y1z1, x1)));
+			}
+			return i;
+		}
+		template<mathf::precision P, typename V> inline size_t quat_to_euler(const float* in, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), two = broadcast<V>(2), hp = broadcast<V>(mathf::halfpi),
+				nhp = broadcast<V>(-mathf::halfpi), lock = broadcast<V>(0.499f), nlock = broadcast<V>(-0.499f);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V x, y, z, w;
+				load4(in + 4 * i, x, y, z, w);
+				const V x2 = mul(x, x), y2 = mul(y, y), z2 = mul(z, z), w2 = mul(w, w),
+					u = add(add(add(x2, y2), z2), w2), t = add(mul(x, y), mul(z, w));
+				const V up = cmplt(mul(lock, u), t), down = cmplt(t, mul(nlock, u)), locked = bor(up, down);
+				const V ex = atan2<P>(select(locked, x, sub(mul(mul(two, x), w), mul(mul(two, y), z))), select(locked, w, add(sub(add(sub(zero, x2), y2), z2), w2)));
+				const V ey = atan2<P>(sub(mul(mul(two, y), w), mul(mul(two, x), z)), add(sub(sub(x2, y2), z2), w2));
+				// asin(s) as atan2(s, sqrt((1 - s)(1 + s)))
+				const V s = min(max(div(mul(two, t), u), broadcast<V>(-1)), one), ez = atan2<P>(s, sqrt(mul(sub(one, s), add(one, s))));
+				const V a = mul(two, ex);
+				store3(out + 3 * i, select(locked, zero, ex), select(up, hp, select(down, nhp, ey)), select(up, a, select(down, sub(zero, a), ez)));
+			}
+			return i;
+		}
+
+		// mat4f::trs over the leading whole blocks of V, returns the count done
+		template<typename V> inline size_t mat4_trs(const float* t, const float* r, const float* s, float* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), two = broadcast<V>(2);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V tx, ty, tz, x, y, z, w, sx, sy, sz;
+				load3(t + 3 * i, tx, ty, tz);
+				load4(r + 4 * i, x, y, z, w);
+				load3(s + 3 * i, sx, sy, sz);
+				const V x2 = mul(x, x), y2 = mul(y, y), z2 = mul(z, z), xy = mul(x, y), xz = mul(x, z), yz = mul(y, z),
+					wx = mul(w, x), wy = mul(w, y), wz = mul(w, z);
+				float* o = out + 16 * i;
+				store4(o, 16, mul(sub(one, mul(two, add(y2, z2))), sx), mul(mul(two, sub(xy, wz)), sy), mul(mul(two, add(xz, wy)), sz), tx);
+				store4(o + 4, 16, mul(mul(two, add(xy, wz)), sx), mul(sub(one, mul(two, add(x2, z2))), sy), mul(mul(two, sub(yz, wx)), sz), ty);
+				store4(o + 8, 16, mul(mul(two, sub(xz, wy)), sx), mul(mul(two, add(yz, wx)), sy), mul(sub(one, mul(two, add(x2, y2))), sz), tz);
+				store4(o + 12, 16, zero, zero, zero, one);
+			}
+			return i;
+		}
+		// mat4f::decompose over the leading whole blocks of V, the rotation case is picked per lane with select
+		template<typename V> inline size_t mat4_decompose(const float* m, float* t, float* r, float* s, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), half = broadcast<V>(0.5f), quarter = broadcast<V>(0.25f),
+				tiny = broadcast<V>(1e-30f);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23;
+				const float* p = m + 16 * i;
+				load4(p, 16, m00, m01, m02, m03);
+				load4(p + 4, 16, m10, m11, m12, m13);
+				load4(p + 8, 16, m20, m21, m22, m23);
+				store3(t + 3 * i, m03, m13, m23);
+				const V sx = sqrt(add(add(mul(m00, m00), mul(m10, m10)), mul(m20, m20)));
+				const V sy = sqrt(add(add(mul(m01, m01), mul(m11, m11)), mul(m21, m21)));
+				const V sz = sqrt(add(add(mul(m02, m02), mul(m12, m12)), mul(m22, m22)));
+				store3(s + 3 * i, sx, sy, sz);
+				const V rx = div(one, max(sx, tiny)), ry = div(one, max(sy, tiny)), rz = div(one, max(sz, tiny));
+				m00 = mul(m00, rx); m10 = mul(m10, rx); m20 = mul(m20, rx);
+				m01 = mul(m01, ry); m11 = mul(m11, ry); m21 = mul(m21, ry);
+				m02 = mul(m02, rz); m12 = mul(m12, rz); m22 = mul(m22, rz);
+				// case masks in mat4f::to_rotation order: w, x, y, otherwise z
+				const V cw = cmplt(zero, add(add(m00, m11), m22));
+				const V cx = band(cmplt(m11, m00), cmplt(m22, m00));
+				const V cy = cmplt(m22, m11);
+				const V dw = add(one, add(add(m00, m11), m22));
+				const V dx = add(one, sub(sub(m00, m11), m22));
+				const V dy = add(one, sub(sub(m11, m00), m22));
+				const V dz = add(one, sub(sub(m22, m00), m11));
+				const V d = select(cw, dw, select(cx, dx, select(cy, dy, dz)));
+				const V a = mul(rsqrt<mathf::precision::standard>(d), half), big = div(quarter, a);
+				const V pwx = mul(sub(m21, m12), a), pwy = mul(sub(m02, m20), a), pwz = mul(sub(m10, m01), a),
+					pxy = mul(add(m01, m10), a), pxz = mul(add(m02, m20), a), pyz = mul(add(m12, m21), a);
+				const V qx = select(cw, pwx, select(cx, big, select(cy, pxy, pxz)));
+				const V qy = select(cw, pwy, select(cx, pxy, select(cy, big, pyz)));
+				const V qz = select(cw, pwz, select(cx, pxz, select(cy, pyz, big)));
+				const V qw = select(cw, big, select(cx, pwx, select(cy, pwy, pwz)));
+				store4(r + 4 * i, qx, qy, qz, qw);
+			}
+			return i;
+		}
+	}
+
+	namespace mathf {
+		// out[i] = rsqrt<P>(in[i]), out may be in
+		template<precision P = precision::standard> inline void rsqrt_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::rsqrt<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = rsqrt<P>(in[i]);
+		}
+
+		// sin, cos, tan, asin, acos, atan, atan2, exp, log and pow by precision. exact is the C library (the constexpr
+		// functions above), fast and standard run the simd polynomials on one lane so they match the batch forms and
+		// float_xn lane for lane. Max error against the correctly rounded result over the valid domain, in ulp:
+		//               fast   standard
+		//   sin, cos     220      1.6     1.6e-8 and 1e-9 absolute within 0.01 of a zero
+		//   tan          280      3.3     |x| < pi / 2, beyond that the 1e-9 of the reduction is relative near a pole
+		//   asin, acos   560      2.4
+		//   atan, atan2  2300     3.1     fast is 1.2e-5 absolute, 1.4e-4 relative near 0
+		//   exp          75       1.3     results down to 2^-126
+		//   log          390      0.9     fast is 70 once |ln x| >= 1
+		//   pow          400 k    2.2 k   k = 1 + |y ln x|
+		// sin, cos and tan need |x| <= 8192. Constant evaluation gives the exact result.
+		template<precision P = precision::standard> inline constexpr float sin(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return sin(x);
+			return simd::first(simd::sin<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float cos(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return cos(x);
+			return simd::first(simd::cos<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float tan(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return tan(x);
+			return simd::first(simd::tan<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float asin(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return asin(x);
+			return simd::first(simd::asin<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float acos(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return acos(x);
+			return simd::first(simd::acos<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float atan(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return atan(x);
+			return simd::first(simd::atan<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float atan2(const float& y, const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return atan2(y, x);
+			return simd::first(simd::atan2<P>(simd::set1(y), simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float exp(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return exp(x);
+			return simd::first(simd::exp<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float log(const float& x) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return log(x);
+			return simd::first(simd::log<P>(simd::set1(x)));
+		}
+		template<precision P = precision::standard> inline constexpr float pow(const float& x, const float& y) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) return pow(x, y);
+			return simd::first(simd::pow<P>(simd::set1(x), simd::set1(y)));
+		}
+		template<precision P = precision::standard> inline constexpr void sincos(const float& x, float& s, float& c) {
+			if (P == precision::exact || PXL_IS_CONSTANT_EVALUATED()) { sincos(x, s, c); return; }
+			simd::f4 vs, vc;
+			simd::sincos<P>(simd::set1(x), vs, vc);
+			s = simd::first(vs);
+			c = simd::first(vc);
+		}
+
+		// out[i] = f<P>(in[i]) for the functions above, out may be in. exact calls the C library per element
+		template<precision P = precision::standard> inline void sin_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::sin<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = sin<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void cos_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::cos<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = cos<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void tan_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::tan<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = tan<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void asin_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::asin<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = asin<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void acos_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::acos<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = acos<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void atan_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::atan<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = atan<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void atan2_n(const float* y, const float* x, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::atan2<P>(simd::load<simd::fw>(y + i), simd::load<simd::fw>(x + i)));
+			for (; i < n; ++i) out[i] = atan2<P>(y[i], x[i]);
+		}
+		template<precision P = precision::standard> inline void exp_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::exp<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = exp<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void log_n(const float* in, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::log<P>(simd::load<simd::fw>(in + i)));
+			for (; i < n; ++i) out[i] = log<P>(in[i]);
+		}
+		template<precision P = precision::standard> inline void pow_n(const float* x, const float* y, float* out, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) for (; i + simd::lanes <= n; i += simd::lanes) simd::store(out + i, simd::pow<P>(simd::load<simd::fw>(x + i), simd::load<simd::fw>(y + i)));
+			for (; i < n; ++i) out[i] = pow<P>(x[i], y[i]);
+		}
+		template<precision P = precision::standard> inline void sincos_n(const float* in, float* s, float* c, const size_t& n) {
+			size_t i = 0;
+			if (P != precision::exact) {
+				for (; i + simd::lanes <= n; i += simd::lanes) {
+					simd::fw vs, vc;
+					simd::sincos<P>(simd::load<simd::fw>(in + i), vs, vc);
+					simd::store(s + i, vs);
+					simd::store(c + i, vc);
+				}
+			}
+			for (; i < n; ++i) sincos<P>(in[i], s[i], c[i]);
+		}
+	}
+
+	// 16-bit storage formats for vec<N, T>, arithmetic converts through float.
+	// half is IEEE binary16 rounded to nearest even with overflow to infinity. snorm16 and unorm16 clamp to [-1, 1]
+	// and [0, 1] and round to the nearest step of the float product, which near a tie may be the other one by up to
+	// 1/512 of a step. nan stores as the low end; -32768 reads back as -1 like -32767.
+	// Conversions are constexpr where PXL_BIT_CAST is available.
+	struct half {
+		uint16_t bits;
+		half() = default;
+		inline constexpr half(const float& f) : bits(from_float(f)) {}
+		inline constexpr operator float() const { return to_float(bits); }
+
+		inline static constexpr uint16_t from_float(const float& f) {
+			const uint32_t b = mathf::bit_cast<uint32_t>(f), s = (b >> 16) & 0x8000, u = b & 0x7fffffff;
+			if (u >= 0x47800000) return uint16_t(s | (u > 0x7f800000 ? 0x7e00 : 0x7c00));
+			// below 2^-14 the float add aligns the result to the half subnormal step
+			if (u < 0x38800000) return uint16_t(s | (mathf::bit_cast<uint32_t>(mathf::bit_cast<float>(u) + 0.5f) - 0x3f000000));
+			return uint16_t(s | ((u + 0xc8000fff + ((u >> 13) & 1)) >> 13));
+		}
+		inline static constexpr float to_float(const uint16_t& h) {
+			uint32_t u = uint32_t(h & 0x7fff) << 13;
+			const uint32_t e = u & 0x0f800000;
+			u += 0x38000000;
+			if (e == 0x0f800000) u += 0x38000000;
+			else if (!e) u = mathf::bit_cast<uint32_t>(mathf::bit_cast<float>(u + 0x800000) - 6.103515625e-05f);
+			return mathf::bit_cast<float>(u | uint32_t(h & 0x8000) << 16);
+		}
+	};
+	struct snorm16 {
+		int16_t v;
+		snorm16() = default;
+		inline constexpr snorm16(const float& f) : v(from_float(f)) {}
+		inline constexpr operator float() const { return to_float(v); }
+
+		inline static constexpr int16_t from_float(const float& f) {
+			const float c = f > -1 ? (f < 1 ? f : 1) : -1;
+			return int16_t(c * 32767 + (c < 0 ? -0.5f : 0.5f));
+		}
+		inline static constexpr float to_float(const int16_t& v) { return v < -32767 ? -1 : v * (1.0f / 32767); }
+	};
+	struct unorm16 {
+		uint16_t v;
+		unorm16() = default;
+		inline constexpr unorm16(const float& f) : v(from_float(f)) {}
+		inline constexpr operator float() const { return to_float(v); }
+
+		inline static constexpr uint16_t from_float(const float& f) { return uint16_t((f > 0 ? (f < 1 ? f : 1) : 0) * 65535 + 0.5f); }
+		inline static constexpr float to_float(const uint16_t& v) { return v * (1.0f / 65535); }
+	};
+
+	namespace detail {
+		// f over each component of a, or over the leading components a and b share with the rest of a kept
+		template<size_t N, typename T, typename F, size_t... I> inline constexpr vec<N, T> map(const vec<N, T>& a, const F& f, std::index_sequence<I...>) {
+			return { T(f(a[I]))... };
+		}
+		template<size_t N, size_t M, typename T, typename F, size_t... I> inline constexpr vec<N, T> zip(const vec<N, T>& a, const vec<M, T>& b, const F& f, std::index_sequence<I...>) {
+			return { (I < M ? T(f(a[I], b[I % M])) : a[I])... };
+		}
+		template<size_t N, typename T, typename F> inline constexpr vec<N, T> map(const vec<N, T>& a, const F& f) { return map(a, f, std::make_index_sequence<N>()); }
+		template<size_t N, size_t M, typename T, typename F> inline constexpr vec<N, T> zip(const vec<N, T>& a, const vec<M, T>& b, const F& f) {
+			return zip(a, b, f, std::make_index_sequence<N>());
+		}
+	}
+
+	// vec<N, T> for N of 2, 3 and 4. The specializations hold the components, the length functions and the constants,
+	// the elementwise operators below are shared. real is the type arithmetic on T produces (float for the 16-bit formats).
+	template<typename T> struct vec<2, T> {
+		typedef T scalar;
+		typedef decltype(T() * T()) real;
+		T x, y;
+		inline constexpr real magnitude() const {
+			const real sqrmag = x * x + y * y;
 			if (sqrmag < mathf::epsilon) return 0;
-			return sqrtf(sqrmag);
+			return mathf::sqrt(sqrmag);
 		}
-		inline const vec2f& normalize() {
-			const float sqrmag = x * x + y * y;
-			if (sqrmag < mathf::epsilon) x = y = 0;
-			const float rmag = mathf::rsqrt(sqrmag);
-			x *= rmag; y *= rmag;
+		inline constexpr const vec& normalize() {
+			const real sqrmag = x * x + y * y;
+			if (sqrmag < mathf::epsilon) { x = y = 0; return *this; }
+			const real rmag = mathf::rsqrt(sqrmag);
+			x = x * rmag; y = y * rmag;
 			return *this;
 		}
-		inline constexpr vec2f normalized() const {
-			const float sqrmag = x * x + y * y;
-			if (sqrmag < mathf::epsilon) return { 0 };
-			const float rmag = mathf::rsqrt(sqrmag);
+		inline constexpr vec normalized() const {
+			const real sqrmag = x * x + y * y;
+			if (sqrmag < mathf::epsilon) return {};
+			const real rmag = mathf::rsqrt(sqrmag);
 			return { x * rmag, y * rmag };
 		}
-		inline constexpr vec2f operator+() const { return *this; }
-		inline constexpr vec2f operator-() const { return (*this) * -1; }
-		inline vec2f& operator++() { ++x; ++y; return *this; }
-		inline constexpr vec2f operator++(int) { return { x++, y++ }; }
-		inline vec2f& operator--() { --x; --y; return *this; }
-		inline constexpr vec2f operator--(int) { return { x--, y-- }; }
-		inline constexpr vec2f operator+(const float& o) const { return { x + o, y + o }; }
-		inline friend constexpr vec2f operator+(const float& l, const vec2f& r) { return { l + r.x, l + r.y }; }
-		inline constexpr vec2f operator+(const vec2f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator+(const vec3f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator+(const vec4f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator-(const float& o) const { return { x - o, y - o }; }
-		inline friend constexpr vec2f operator-(const float& l, const vec2f& r) { return { l - r.x, l - r.y }; }
-		inline constexpr vec2f operator-(const vec2f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator-(const vec3f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator-(const vec4f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator*(const float& o) const { return { x * o, y * o }; }
-		inline friend constexpr vec2f operator*(const float& l, const vec2f& r) { return { l * r.x, l * r.y }; }
-		inline constexpr vec2f operator*(const vec2f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator*(const vec3f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator*(const vec4f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator/(const float& o) const { return { x / o, y / o }; }
-		inline friend constexpr vec2f operator/(const float& l, const vec2f& r) { return { l / r.x, l / r.y }; }
-		inline constexpr vec2f operator/(const vec2f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator/(const vec3f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1) }; }
-		inline constexpr vec2f operator/(const vec4f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1) }; }
-		inline vec2f& operator =(const float& o) { x = o; y = o; return *this; }
-		//inline vec2f& operator =(const vec2f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator =(const vec3f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator =(const vec4f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator+=(const float& o) { x += o; y += o; return *this; }
-		inline vec2f& operator+=(const vec2f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator+=(const vec3f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator+=(const vec4f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator-=(const float& o) { x -= o; y -= o; return *this; }
-		inline vec2f& operator-=(const vec2f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator-=(const vec3f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator-=(const vec4f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator*=(const float& o) { x *= o; y *= o; return *this; }
-		inline vec2f& operator*=(const vec2f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator*=(const vec3f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator*=(const vec4f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator/=(const float& o) { x /= o; y /= o; return *this; }
-		inline vec2f& operator/=(const vec2f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator/=(const vec3f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); return *this; }
-		inline vec2f& operator/=(const vec4f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); return *this; }
-		inline bool operator==(const vec2f& o) { return memcmp(this, &o, sizeof(vec2f)); }
-		inline bool operator!=(const vec2f& o) { return !memcmp(this, &o, sizeof(vec2f)); }
-		inline float& operator[](const size_t& i) { return ((float*)this)[i]; }
-		inline const float& operator[](const size_t& i) const { return ((float*)this)[i]; }
-
-		inline static constexpr vec2f zero() { return { 0 }; }
-		inline static constexpr vec2f left() { return { -1, 0 }; }
-		inline static constexpr vec2f right() { return { 1, 0 }; }
-		inline static constexpr vec2f up() { return { 0, 1 }; }
-		inline static constexpr vec2f down() { return { 0, -1 }; }
-		inline static constexpr vec2f infinity() { return { INFINITY, INFINITY }; }
+		inline constexpr vec& operator++() { return *this += 1; }
+		inline constexpr vec operator++(int) { const vec r = *this; ++*this; return r; }
+		inline constexpr vec& operator--() { return *this -= 1; }
+		inline constexpr vec operator--(int) { const vec r = *this; --*this; return r; }
+		inline constexpr vec& operator =(const scalar& o) { x = o; y = o; return *this; }
+		template<size_t M> inline constexpr vec& operator =(const vec<M, T>& o) { x = o.x; y = o.y; return *this; }
+		inline constexpr T& operator[](const size_t& i) { return PXL_IS_CONSTANT_EVALUATED() ? (i ? y : x) : (&x)[i]; }
+		inline constexpr const T& operator[](const size_t& i) const { return PXL_IS_CONSTANT_EVALUATED() ? (i ? y : x) : (&x)[i]; }
+
+		inline static constexpr vec zero() { return {}; }
+		inline static constexpr vec left() { return { -1, 0 }; }
+		inline static constexpr vec right() { return { 1, 0 }; }
+		inline static constexpr vec up() { return { 0, 1 }; }
+		inline static constexpr vec down() { return { 0, -1 }; }
+		inline static constexpr vec infinity() { return { INFINITY, INFINITY }; }
+		inline static constexpr real dot(const vec& l, const vec& r) { return l.x * r.x + l.y * r.y; }
 	};
 
-	struct vec3f {
-		float x, y, z;
-		inline constexpr float magnitude() const {
-			const float sqrmag = x * x + y * y + z * z;
+	template<typename T> struct vec<3, T> {
+		typedef T scalar;
+		typedef decltype(T() * T()) real;
+		T x, y, z;
+		inline constexpr real magnitude() const {
+			const real sqrmag = x * x + y * y + z * z;
 			if (sqrmag < mathf::epsilon) return 0;
-			return sqrtf(sqrmag);
+			return mathf::sqrt(sqrmag);
 		}
-		inline const vec3f& normalize() {
-			const float sqrmag = x * x + y * y + z * z;
-			if (sqrmag < mathf::epsilon) x = y = z = 0;
-			const float rmag = mathf::rsqrt(sqrmag);
-			x *= rmag; y *= rmag; z *= rmag;
+		inline constexpr const vec& normalize() {
+			const real sqrmag = x * x + y * y + z * z;
+			if (sqrmag < mathf::epsilon) { x = y = z = 0; return *this; }
+			const real rmag = mathf::rsqrt(sqrmag);
+			x = x * rmag; y = y * rmag; z = z * rmag;
 			return *this;
 		}
-		inline constexpr vec3f normalized() const {
-			const float sqrmag = x * x + y * y + z * z;
-			if (sqrmag < mathf::epsilon) return { 0 };
-			const float rmag = mathf::rsqrt(sqrmag);
+		inline constexpr vec normalized() const {
+			const real sqrmag = x * x + y * y + z * z;
+			if (sqrmag < mathf::epsilon) return {};
+			const real rmag = mathf::rsqrt(sqrmag);
 			return { x * rmag, y * rmag, z * rmag };
 		}
-		inline constexpr vec3f operator+() const { return *this; }
-		inline constexpr vec3f operator-() const { return (*this) * -1; }
-		inline vec3f& operator++() { ++x; ++y; ++z; return *this; }
-		inline constexpr vec3f operator++(int) { return { x++, y++, z++ }; }
-		inline vec3f& operator--() { --x; --y; --z; return *this; }
-		inline constexpr vec3f operator--(int) { return { x--, y--, z-- }; }
-		inline constexpr vec3f operator+(const float& o) const { return { x + o, y + o, z + o }; }
-		inline friend constexpr vec3f operator+(const float& l, const vec3f& r) { return { l + r.x, l + r.y, l + r.z }; }
-		inline constexpr vec3f operator+(const vec2f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1), z }; }
-		inline constexpr vec3f operator+(const vec3f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1), z + *(((float*)&o) + 2) }; }
-		inline constexpr vec3f operator+(const vec4f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1), z + *(((float*)&o) + 2) }; }
-		inline constexpr vec3f operator-(const float& o) const { return { x - o, y - o, z - o }; }
-		inline friend constexpr vec3f operator-(const float& l, const vec3f& r) { return { l - r.x, l - r.y, l - r.z }; }
-		inline constexpr vec3f operator-(const vec2f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1), z }; }
-		inline constexpr vec3f operator-(const vec3f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1), z - *(((float*)&o) + 2) }; }
-		inline constexpr vec3f operator-(const vec4f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1), z - *(((float*)&o) + 2) }; }
-		inline constexpr vec3f operator*(const float& o) const { return { x * o, y * o, z * o }; }
-		inline friend constexpr vec3f operator*(const float& l, const vec3f& r) { return { l * r.x, l * r.y, l * r.z }; }
-		inline constexpr vec3f operator*(const vec2f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1), z }; }
-		inline constexpr vec3f operator*(const vec3f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1), z * *(((float*)&o) + 2) }; }
-		inline constexpr vec3f operator*(const vec4f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1), z * *(((float*)&o) + 2) }; }
-		inline constexpr vec3f operator/(const float& o) const { return { x / o, y / o, z / o }; }
-		inline friend constexpr vec3f operator/(const float& l, const vec3f& r) { return { l / r.x, l / r.y, l / r.z }; }
-		inline constexpr vec3f operator/(const vec2f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1), z }; }
-		inline constexpr vec3f operator/(const vec3f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1), z / *(((float*)&o) + 2) }; }
-		inline constexpr vec3f operator/(const vec4f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1), z / *(((float*)&o) + 2) }; }
-		inline vec3f& operator =(const float& o) { x = o; y = o; z = o; return *this; }
-		inline vec3f& operator =(const vec2f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); return *this; }
-		//inline vec3f& operator =(const vec3f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); z = *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator =(const vec4f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); z = *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator+=(const float& o) { x += o; y += o; z += o; return *this; }
-		inline vec3f& operator+=(const vec2f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); return *this; }
-		inline vec3f& operator+=(const vec3f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); z += *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator+=(const vec4f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); z += *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator-=(const float& o) { x -= o; y -= o; z -= o; return *this; }
-		inline vec3f& operator-=(const vec2f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); return *this; }
-		inline vec3f& operator-=(const vec3f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); z -= *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator-=(const vec4f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); z -= *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator*=(const float& o) { x *= o; y *= o; z *= o; return *this; }
-		inline vec3f& operator*=(const vec2f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); return *this; }
-		inline vec3f& operator*=(const vec3f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); z *= *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator*=(const vec4f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); z *= *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator/=(const float& o) { x /= o; y /= o; z /= o; return *this; }
-		inline vec3f& operator/=(const vec2f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); return *this; }
-		inline vec3f& operator/=(const vec3f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); z /= *(((float*)&o) + 2); return *this; }
-		inline vec3f& operator/=(const vec4f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); z /= *(((float*)&o) + 2); return *this; }
-		inline bool operator==(const vec3f& o) { return memcmp(this, &o, sizeof(vec3f)); }
-		inline bool operator!=(const vec3f& o) { return !memcmp(this, &o, sizeof(vec3f)); }
-		inline float& operator[](const size_t& i) { return ((float*)this)[i]; }
-		inline const float& operator[](const size_t& i) const { return ((float*)this)[i]; }
-
-		inline static constexpr vec3f zero() { return { 0 }; }
-		inline static constexpr vec3f left() { return { -1, 0, 0 }; }
-		inline static constexpr vec3f right() { return { 1, 0, 0 }; }
-		inline static constexpr vec3f up() { return { 0, 1, 0 }; }
-		inline static constexpr vec3f down() { return { 0, -1, 0 }; }
-		inline static constexpr vec3f forward() { return { 0, 0, 1 }; }
-		inline static constexpr vec3f back() { return { 0, 0, -1 }; }
-		inline static constexpr vec3f infinity() { return { INFINITY, INFINITY, INFINITY }; }
+		inline constexpr vec& operator++() { return *this += 1; }
+		inline constexpr vec operator++(int) { const vec r = *this; ++*this; return r; }
+		inline constexpr vec& operator--() { return *this -= 1; }
+		inline constexpr vec operator--(int) { const vec r = *this; --*this; return r; }
+		inline constexpr vec& operator =(const scalar& o) { x = o; y = o; z = o; return *this; }
+		template<size_t M> inline constexpr vec& operator =(const vec<M, T>& o) { return *this = detail::zip(*this, o, [](const T&, const T& r) { return r; }); }
+		inline constexpr T& operator[](const size_t& i) { return PXL_IS_CONSTANT_EVALUATED() ? (i == 0 ? x : i == 1 ? y : z) : (&x)[i]; }
+		inline constexpr const T& operator[](const size_t& i) const { return PXL_IS_CONSTANT_EVALUATED() ? (i == 0 ? x : i == 1 ? y : z) : (&x)[i]; }
+
+		inline static constexpr vec zero() { return {}; }
+		inline static constexpr vec left() { return { -1, 0, 0 }; }
+		inline static constexpr vec right() { return { 1, 0, 0 }; }
+		inline static constexpr vec up() { return { 0, 1, 0 }; }
+		inline static constexpr vec down() { return { 0, -1, 0 }; }
+		inline static constexpr vec forward() { return { 0, 0, 1 }; }
+		inline static constexpr vec back() { return { 0, 0, -1 }; }
+		inline static constexpr vec infinity() { return { INFINITY, INFINITY, INFINITY }; }
+		inline static constexpr real dot(const vec& l, const vec& r) { return l.x * r.x + l.y * r.y + l.z * r.z; }
+		inline static constexpr vec cross(const vec& l, const vec& r) {
+			return { l.y * r.z - l.z * r.y, l.z * r.x - l.x * r.z, l.x * r.y - l.y * r.x };
+		}
 	};
 
-	struct vec4f {
-		float x, y, z, w;
-		inline constexpr float magnitude() const {
-			const float sqrmag = x * x + y * y + z * z + w * w;
+	template<typename T> struct vec<4, T> {
+		typedef T scalar;
+		typedef decltype(T() * T()) real;
+		T x, y, z, w;
+		inline constexpr real magnitude() const {
+			const real sqrmag = x * x + y * y + z * z + w * w;
 			if (sqrmag < mathf::epsilon) return 0;
-			return sqrtf(sqrmag);
+			return mathf::sqrt(sqrmag);
 		}
-		inline const vec4f& normalize() {
-			const float sqrmag = x * x + y * y + z * z + w * w;
-			if (sqrmag < mathf::epsilon) x = y = z = w = 0;
-			const float rmag = mathf::rsqrt(sqrmag);
-			x *= rmag; y *= rmag; z *= rmag; w *= rmag;
+		inline constexpr const vec& normalize() {
+			const real sqrmag = x * x + y * y + z * z + w * w;
+			if (sqrmag < mathf::epsilon) { x = y = z = w = 0; return *this; }
+			const real rmag = mathf::rsqrt(sqrmag);
+			x = x * rmag; y = y * rmag; z = z * rmag; w = w * rmag;
 			return *this;
 		}
-		inline constexpr vec4f normalized() const {
-			const float sqrmag = x * x + y * y + z * z + w * w;
-			if (sqrmag < mathf::epsilon) return { 0 };
-			const float rmag = mathf::rsqrt(sqrmag);
+		inline constexpr vec normalized() const {
+			const real sqrmag = x * x + y * y + z * z + w * w;
+			if (sqrmag < mathf::epsilon) return {};
+			const real rmag = mathf::rsqrt(sqrmag);
 			return { x * rmag, y * rmag, z * rmag, w * rmag };
 		}
-		inline constexpr vec4f operator+() const { return *this; }
-		inline constexpr vec4f operator-() const { return (*this) * -1; }
-		inline vec4f& operator++() { ++x; ++y; ++z; ++w; return *this; }
-		inline constexpr vec4f operator++(int) { return { x++, y++, z++, w++ }; }
-		inline vec4f& operator--() { --x; --y; --z; --w; return *this; }
-		inline constexpr vec4f operator--(int) { return { x--, y--, z--, w-- }; }
-		inline constexpr vec4f operator+(const float& o) const { return { x + o, y + o, z + o, w + o }; }
-		inline friend constexpr vec4f operator+(const float& l, const vec4f& r) { return { l + r.x, l + r.y, l + r.z, l + r.w }; }
-		inline constexpr vec4f operator+(const vec2f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1), z, w }; }
-		inline constexpr vec4f operator+(const vec3f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1), z + *(((float*)&o) + 2), w }; }
-		inline constexpr vec4f operator+(const vec4f& o) const { return { x + *((float*)&o), y + *(((float*)&o) + 1), z + *(((float*)&o) + 2), w + *(((float*)&o) + 3) }; }
-		inline constexpr vec4f operator-(const float& o) const { return { x - o, y - o, z - o, w - o }; }
-		inline friend constexpr vec4f operator-(const float& l, const vec4f& r) { return { l - r.x, l - r.y, l - r.z, l - r.w }; }
-		inline constexpr vec4f operator-(const vec2f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1), z, w }; }
-		inline constexpr vec4f operator-(const vec3f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1), z - *(((float*)&o) + 2), w }; }
-		inline constexpr vec4f operator-(const vec4f& o) const { return { x - *((float*)&o), y - *(((float*)&o) + 1), z - *(((float*)&o) + 2), w - *(((float*)&o) + 3) }; }
-		inline constexpr vec4f operator*(const float& o) const { return { x * o, y * o, z * o, w * o }; }
-		inline friend constexpr vec4f operator*(const float& l, const vec4f& r) { return { l * r.x, l * r.y, l * r.z, l * r.w }; }
-		inline constexpr vec4f operator*(const vec2f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1), z, w }; }
-		inline constexpr vec4f operator*(const vec3f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1), z * *(((float*)&o) + 2), w }; }
-		inline constexpr vec4f operator*(const vec4f& o) const { return { x * *((float*)&o), y * *(((float*)&o) + 1), z * *(((float*)&o) + 2), w * *(((float*)&o) + 3) }; }
-		inline constexpr vec4f operator/(const float& o) const { return { x / o, y / o, z / o, w / o }; }
-		inline friend constexpr vec4f operator/(const float& l, const vec4f& r) { return { l / r.x, l / r.y, l / r.z, l / r.w }; }
-		inline constexpr vec4f operator/(const vec2f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1), z, w }; }
-		inline constexpr vec4f operator/(const vec3f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1), z / *(((float*)&o) + 2), w }; }
-		inline constexpr vec4f operator/(const vec4f& o) const { return { x / *((float*)&o), y / *(((float*)&o) + 1), z / *(((float*)&o) + 2), w / *(((float*)&o) + 3) }; }
-		inline vec4f& operator =(const float& o) { x = o; y = o; z = o; w = o; return *this; }
-		inline vec4f& operator =(const vec2f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); return *this; }
-		inline vec4f& operator =(const vec3f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); z = *(((float*)&o) + 2); return *this; }
-		//inline vec4f& operator =(const vec4f& o) { x = *((float*)&o); y = *(((float*)&o) + 1); z = *(((float*)&o) + 2); w = *(((float*)&o) + 3); return *this; }
-		inline vec4f& operator+=(const float& o) { x += o; y += o; z += o; w += o; return *this; }
-		inline vec4f& operator+=(const vec2f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); return *this; }
-		inline vec4f& operator+=(const vec3f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); z += *(((float*)&o) + 2); return *this; }
-		inline vec4f& operator+=(const vec4f& o) { x += *((float*)&o); y += *(((float*)&o) + 1); z += *(((float*)&o) + 2); w += *(((float*)&o) + 3); return *this; }
-		inline vec4f& operator-=(const float& o) { x -= o; y -= o; z -= o; w -= o; return *this; }
-		inline vec4f& operator-=(const vec2f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); return *this; }
-		inline vec4f& operator-=(const vec3f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); z -= *(((float*)&o) + 2); return *this; }
-		inline vec4f& operator-=(const vec4f& o) { x -= *((float*)&o); y -= *(((float*)&o) + 1); z -= *(((float*)&o) + 2); w -= *(((float*)&o) + 3); return *this; }
-		inline vec4f& operator*=(const float& o) { x *= o; y *= o; z *= o; w *= o; return *this; }
-		inline vec4f& operator*=(const vec2f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); return *this; }
-		inline vec4f& operator*=(const vec3f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); z *= *(((float*)&o) + 2); return *this; }
-		inline vec4f& operator*=(const vec4f& o) { x *= *((float*)&o); y *= *(((float*)&o) + 1); z *= *(((float*)&o) + 2); w *= *(((float*)&o) + 3); return *this; }
-		inline vec4f& operator/=(const float& o) { x /= o; y /= o; z /= o; w /= o; return *this; }
-		inline vec4f& operator/=(const vec2f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); return *this; }
-		inline vec4f& operator/=(const vec3f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); z /= *(((float*)&o) + 2); return *this; }
-		inline vec4f& operator/=(const vec4f& o) { x /= *((float*)&o); y /= *(((float*)&o) + 1); z /= *(((float*)&o) + 2); w /= *(((float*)&o) + 3); return *this; }
-		inline bool operator==(const vec4f& o) { return memcmp(this, &o, sizeof(vec4f)); }
-		inline bool operator!=(const vec4f& o) { return !memcmp(this, &o, sizeof(vec4f)); }
-		inline float& operator[](const size_t& i) { return ((float*)this)[i]; }
-		inline const float& operator[](const size_t& i) const { return ((float*)this)[i]; }
-
-		inline static constexpr vec4f zero() { return { 0 }; }
-		inline static constexpr vec4f infinity() { return { INFINITY, INFINITY, INFINITY, INFINITY }; }
+		inline constexpr vec& operator++() { return *this += 1; }
+		inline constexpr vec operator++(int) { const vec r = *this; ++*this; return r; }
+		inline constexpr vec& operator--() { return *this -= 1; }
+		inline constexpr vec operator--(int) { const vec r = *this; --*this; return r; }
+		inline constexpr vec& operator =(const scalar& o) { x = o; y = o; z = o; w = o; return *this; }
+		template<size_t M> inline constexpr vec& operator =(const vec<M, T>& o) { return *this = detail::zip(*this, o, [](const T&, const T& r) { return r; }); }
+		inline constexpr T& operator[](const size_t& i) { return PXL_IS_CONSTANT_EVALUATED() ? (i == 0 ? x : i == 1 ? y : i == 2 ? z : w) : (&x)[i]; }
+		inline constexpr const T& operator[](const size_t& i) const { return PXL_IS_CONSTANT_EVALUATED() ? (i == 0 ? x : i == 1 ? y : i == 2 ? z : w) : (&x)[i]; }
+
+		inline static constexpr vec zero() { return {}; }
+		inline static constexpr vec infinity() { return { INFINITY, INFINITY, INFINITY, INFINITY }; }
+		inline static constexpr real dot(const vec& l, const vec& r) { return l.x * r.x + l.y * r.y + l.z * r.z + l.w * r.w; }
 	};
 
-	struct quatf {
-		float x, y, z, w;
-		inline constexpr float magnitude() const {
-			const float sqrmag = x * x + y * y + z * z + w * w;
+	template<size_t N, typename T> inline constexpr vec<N, T> operator+(const vec<N, T>& a) { return a; }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator-(const vec<N, T>& a) { return detail::map(a, [](const T& v) { return -v; }); }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T> operator+(const vec<N, T>& a, const vec<M, T>& b) { return detail::zip(a, b, [](const T& l, const T& r) { return l + r; }); }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T> operator-(const vec<N, T>& a, const vec<M, T>& b) { return detail::zip(a, b, [](const T& l, const T& r) { return l - r; }); }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T> operator*(const vec<N, T>& a, const vec<M, T>& b) { return detail::zip(a, b, [](const T& l, const T& r) { return l * r; }); }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T> operator/(const vec<N, T>& a, const vec<M, T>& b) { return detail::zip(a, b, [](const T& l, const T& r) { return l / r; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator+(const vec<N, T>& a, const typename vec<N, T>::scalar& b) { return detail::map(a, [&](const T& l) { return l + b; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator-(const vec<N, T>& a, const typename vec<N, T>::scalar& b) { return detail::map(a, [&](const T& l) { return l - b; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator*(const vec<N, T>& a, const typename vec<N, T>::scalar& b) { return detail::map(a, [&](const T& l) { return l * b; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator/(const vec<N, T>& a, const typename vec<N, T>::scalar& b) { return detail::map(a, [&](const T& l) { return l / b; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator+(const typename vec<N, T>::scalar& a, const vec<N, T>& b) { return detail::map(b, [&](const T& r) { return a + r; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator-(const typename vec<N, T>::scalar& a, const vec<N, T>& b) { return detail::map(b, [&](const T& r) { return a - r; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator*(const typename vec<N, T>::scalar& a, const vec<N, T>& b) { return detail::map(b, [&](const T& r) { return a * r; }); }
+	template<size_t N, typename T> inline constexpr vec<N, T> operator/(const typename vec<N, T>::scalar& a, const vec<N, T>& b) { return detail::map(b, [&](const T& r) { return a / r; }); }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T>& operator+=(vec<N, T>& a, const vec<M, T>& b) { return a = a + b; }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T>& operator-=(vec<N, T>& a, const vec<M, T>& b) { return a = a - b; }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T>& operator*=(vec<N, T>& a, const vec<M, T>& b) { return a = a * b; }
+	template<size_t N, size_t M, typename T> inline constexpr vec<N, T>& operator/=(vec<N, T>& a, const vec<M, T>& b) { return a = a / b; }
+	template<size_t N, typename T> inline constexpr vec<N, T>& operator+=(vec<N, T>& a, const typename vec<N, T>::scalar& b) { return a = a + b; }
+	template<size_t N, typename T> inline constexpr vec<N, T>& operator-=(vec<N, T>& a, const typename vec<N, T>::scalar& b) { return a = a - b; }
+	template<size_t N, typename T> inline constexpr vec<N, T>& operator*=(vec<N, T>& a, const typename vec<N, T>::scalar& b) { return a = a * b; }
+	template<size_t N, typename T> inline constexpr vec<N, T>& operator/=(vec<N, T>& a, const typename vec<N, T>::scalar& b) { return a = a / b; }
+	// a * b + c per component through mathf::madd, one fma each when PXL_FMA
+	template<size_t N, typename T> inline constexpr vec<N, T> madd(const vec<N, T>& a, const vec<N, T>& b, const vec<N, T>& c) {
+		typedef typename vec<N, T>::real R;
+		vec<N, T> r{};
+		for (size_t i = 0; i < N; ++i) r[i] = T(mathf::madd(R(a[i]), R(b[i]), R(c[i])));
+		return r;
+	}
+	template<size_t N, typename T> inline constexpr vec<N, T> madd(const vec<N, T>& a, const typename vec<N, T>::scalar& b, const vec<N, T>& c) {
+		typedef typename vec<N, T>::real R;
+		vec<N, T> r{};
+		for (size_t i = 0; i < N; ++i) r[i] = T(mathf::madd(R(a[i]), R(b), R(c[i])));
+		return r;
+	}
+	template<size_t N, typename T> inline constexpr bool operator==(const vec<N, T>& a, const vec<N, T>& b) {
+		for (size_t i = 0; i < N; ++i) if (!(a[i] == b[i])) return false;
+		return true;
+	}
+	template<size_t N, typename T> inline constexpr bool operator!=(const vec<N, T>& a, const vec<N, T>& b) { return !(a == b); }
+	// mathf::approx_equal and mathf::ulp_equal on every component
+	template<size_t N, typename T> inline constexpr bool approx_equal(const vec<N, T>& a, const vec<N, T>& b, const typename vec<N, T>::real& eps = 1e-5f) {
+		typedef typename vec<N, T>::real R;
+		for (size_t i = 0; i < N; ++i) if (!mathf::approx_equal(R(a[i]), R(b[i]), eps)) return false;
+		return true;
+	}
+	template<size_t N, typename T> inline constexpr bool ulp_equal(const vec<N, T>& a, const vec<N, T>& b, const uint64_t& max_ulps = 4) {
+		typedef typename vec<N, T>::real R;
+		for (size_t i = 0; i < N; ++i) if (!mathf::ulp_equal(R(a[i]), R(b[i]), max_ulps)) return false;
+		return true;
+	}
+
+	// quat and mat are meant for float and double
+	template<typename T> struct quat {
+		T x, y, z, w;
+		inline constexpr T magnitude() const {
+			const T sqrmag = x * x + y * y + z * z + w * w;
 			if (sqrmag < mathf::epsilon) return 0;
-			return sqrtf(sqrmag);
+			return mathf::sqrt(sqrmag);
 		}
-		inline quatf& normalize() {
-			const float sqrmag = x * x + y * y + z * z + w * w;
-			if (sqrmag < mathf::epsilon) x = y = z = w = 0;
-			const float rmag = mathf::rsqrt(sqrmag);
+		inline constexpr quat& normalize() {
+			const T sqrmag = x * x + y * y + z * z + w * w;
+			if (sqrmag < mathf::epsilon) { x = y = z = w = 0; return *this; }
+			const T rmag = mathf::rsqrt(sqrmag);
 			x *= rmag; y *= rmag; z *= rmag; w *= rmag;
 			return *this;
 		}
-		inline constexpr quatf normalized() const {
-			const float sqrmag = x * x + y * y + z * z + w * w;
-			if (sqrmag < mathf::epsilon) return { 0 };
-			const float rmag = mathf::rsqrt(sqrmag);
+		inline constexpr quat normalized() const {
+			const T sqrmag = x * x + y * y + z * z + w * w;
+			if (sqrmag < mathf::epsilon) return {};
+			const T rmag = mathf::rsqrt(sqrmag);
 			return { x * rmag, y * rmag, z * rmag, w * rmag };
 		}
-		inline quatf& conjugate() { x = -x; y = -y, z = -z; return *this; }
-		inline constexpr quatf conjugated() const { return { -x, -y, -z, w }; }
-		inline quatf& euler(const vec3f& rad) { return *this = from_euler(rad); }
-		inline vec3f euler() const { return to_euler(*this); }
-		inline constexpr quatf operator*(const quatf& o) const {
+		inline constexpr quat& conjugate() { x = -x; y = -y, z = -z; return *this; }
+		inline constexpr quat conjugated() const { return { -x, -y, -z, w }; }
+		inline constexpr quat& euler(const vec<3, T>& rad) { return *this = from_euler(rad); }
+		inline constexpr vec<3, T> euler() const { return to_euler(*this); }
+		// q * v * conj(q) for unit q, as v + 2w(u x v) + 2u x (u x v)
+		inline constexpr vec<3, T> rotate(const vec<3, T>& v) const {
+			const vec<3, T> u{ x, y, z }, t{ vec<3, T>::cross(u, v) * 2 }, c{ vec<3, T>::cross(u, t) };
+			return { v.x + w * t.x + c.x, v.y + w * t.y + c.y, v.z + w * t.z + c.z };
+		}
+		inline constexpr vec<3, T> operator*(const vec<3, T>& v) const { return rotate(v); }
+		inline constexpr quat operator*(const quat& o) const {
 			return { x * o.w + y * o.z - z * o.y + w * o.x,
 			-x * o.z + y * o.w + z * o.x + w * o.y,
 			x * o.y - y * o.x + z * o.w + w * o.z,
 			-x * o.x - y * o.y - z * o.z + w * o.w };
 		}
-		inline constexpr quatf& operator*=(const quatf& o)
+		inline constexpr quat& operator*=(const quat& o)
 		{
-			const float x = this->x, y = this->y, z = this->z, w = this->w;
+			const T x = this->x, y = this->y, z = this->z, w = this->w;
 			this->x = x * o.w + y * o.z - z * o.y + w * o.x;
 			this->y = -x * o.z + y * o.w + z * o.x + w * o.y;
 			this->z = x * o.y - y * o.x + z * o.w + w * o.z;
 			this->w = -x * o.x - y * o.y - z * o.z + w * o.w;
 			return *this;
 		}
-		inline float& operator[](const size_t& i) { return ((float*)this)[i]; }
-		inline const float& operator[](const size_t& i) const { return ((float*)this)[i]; }
+		// componentwise, q and -q are the same rotation but not equal
+		inline constexpr bool operator==(const quat& o) const { return x == o.x && y == o.y && z == o.z && w == o.w; }
+		inline constexpr bool operator!=(const quat& o) const { return !(*this == o); }
+		inline constexpr T& operator[](const size_t& i) { return PXL_IS_CONSTANT_EVALUATED() ? (i == 0 ? x : i == 1 ? y : i == 2 ? z : w) : (&x)[i]; }
+		inline constexpr const T& operator[](const size_t& i) const { return PXL_IS_CONSTANT_EVALUATED() ? (i == 0 ? x : i == 1 ? y : i == 2 ? z : w) : (&x)[i]; }
 
-		inline static constexpr quatf zero() { return { 0 }; }
-		inline static constexpr quatf identity() { return { 0, 0, 0, 1 }; }
+		inline static constexpr quat zero() { return {}; }
+		inline static constexpr quat identity() { return { 0, 0, 0, 1 }; }
+		inline static constexpr T dot(const quat& l, const quat& r) { return l.x * r.x + l.y * r.y + l.z * r.z + l.w * r.w; }
 
-		inline static vec3f to_euler(const quatf& q) {
-			const float x2 = q.x * q.x, y2 = q.y * q.y, z2 = q.z * q.z, w2 = q.w * q.w,
+		// normalized lerp along the shortest arc
+		inline static constexpr quat nlerp(const quat& a, const quat& b, const T& t) {
+			const T u = 1 - t, s = dot(a, b) < 0 ? -t : t;
+			return quat{ a.x * u + b.x * s, a.y * u + b.y * s, a.z * u + b.z * s, a.w * u + b.w * s }.normalize();
+		}
+		// spherical lerp along the shortest arc, falls back to nlerp below ~3.6 degrees where the two agree to 1e-6
+		inline static constexpr quat slerp(const quat& a, const quat& b, const T& t) {
+			return dot(a, b) < 0 ? slerp_arc(a, { -b.x, -b.y, -b.z, -b.w }, t) : slerp_arc(a, b, t);
+		}
+		// spherical lerp from a to b as given, the long way round when dot(a, b) < 0
+		inline static constexpr quat slerp_arc(const quat& a, const quat& b, const T& t) {
+			const T d = dot(a, b);
+			if (d > 0.9995f) {
+				const T u = 1 - t;
+				return quat{ a.x * u + b.x * t, a.y * u + b.y * t, a.z * u + b.z * t, a.w * u + b.w * t }.normalize();
+			}
+			const T th = mathf::acos(mathf::max(d, T(-1))), rs = 1 / mathf::sin(th);
+			const T wa = mathf::sin((1 - t) * th) * rs, wb = mathf::sin(t * th) * rs;
+			return { a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb };
+		}
+		// cubic interpolation from q1 to q2, s1 and s2 from squad_control at q1 and q2. q2 and s1 are taken on q1's
+		// side and s2 on q2's, then every slerp follows its arc as given: picking the shorter arc per slerp lets the
+		// inner one jump to the other side mid segment and the result snap by half a turn
+		inline static constexpr quat squad(const quat& q1, const quat& q2, const quat& s1, const quat& s2, const T& t) {
+			const quat b = dot(q1, q2) < 0 ? quat{ -q2.x, -q2.y, -q2.z, -q2.w } : q2,
+				c = dot(q1, s1) < 0 ? quat{ -s1.x, -s1.y, -s1.z, -s1.w } : s1,
+				d = dot(b, s2) < 0 ? quat{ -s2.x, -s2.y, -s2.z, -s2.w } : s2;
+			return slerp_arc(slerp_arc(q1, b, t), slerp_arc(c, d, t), 2 * t * (1 - t));
+		}
+		// inner control point of q between its neighbours, q * exp(-(log(q^-1 next) + log(q^-1 prev)) / 4)
+		inline static constexpr quat squad_control(const quat& prev, const quat& q, const quat& next) {
+			const quat qi = q.conjugated(),
+				a = log(qi * (dot(q, next) < 0 ? quat{ -next.x, -next.y, -next.z, -next.w } : next)),
+				b = log(qi * (dot(q, prev) < 0 ? quat{ -prev.x, -prev.y, -prev.z, -prev.w } : prev));
+			return q * exp({ (a.x + b.x) * -0.25f, (a.y + b.y) * -0.25f, (a.z + b.z) * -0.25f, 0 });
+		}
+		// unit q to a pure quaternion (axis * half angle, 0) and back
+		inline static constexpr quat log(const quat& q) {
+			const T s = mathf::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+			if (s < mathf::epsilon) return { q.x, q.y, q.z, 0 };
+			const T k = mathf::atan2(s, q.w) / s;
+			return { q.x * k, q.y * k, q.z * k, 0 };
+		}
+		inline static constexpr quat exp(const quat& q) {
+			const T th = mathf::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+			if (th < mathf::epsilon) return { q.x, q.y, q.z, 1 };
+			const T k = mathf::sin(th) / th;
+			return { q.x * k, q.y * k, q.z * k, mathf::cos(th) };
+		}
+
+		inline static constexpr vec<3, T> to_euler(const quat& q) {
+			const T x2 = q.x * q.x, y2 = q.y * q.y, z2 = q.z * q.z, w2 = q.w * q.w,
 				u = x2 + y2 + z2 + w2, t = q.x * q.y + q.z * q.w;
-			if (t > 0.499f * u) return { 0, mathf::halfpi, 2 * atan2f(q.x, q.w) };
-			if (t < -0.499f * u) return { 0, -mathf::halfpi, -2 * atan2f(q.x, q.w) };
+			if (t > 0.499f * u) return { 0, mathf::halfpi, 2 * mathf::atan2(q.x, q.w) };
+			if (t < -0.499f * u) return { 0, -mathf::halfpi, -2 * mathf::atan2(q.x, q.w) };
 			return {
-				atan2f(2 * q.x * q.w - 2 * q.y * q.z, -x2 + y2 - z2 + w2),
-				atan2f(2 * q.y * q.w - 2 * q.x * q.z, x2 - y2 - z2 + w2),
-				asinf(2 * t / u) };
-		}
-		inline static quatf from_euler(const vec3f& r /* radians */) {
-			//const vec3f hr{ r * 0.00872664625f };
-			const vec3f hr{ r * 0.5f };
-			const float
-				x0 = cosf(hr.x), x1 = sinf(hr.x),
-				y0 = cosf(hr.y), y1 = sinf(hr.y),
-				z0 = cosf(hr.z), z1 = sinf(hr.z),
+				mathf::atan2(2 * q.x * q.w - 2 * q.y * q.z, -x2 + y2 - z2 + w2),
+				mathf::atan2(2 * q.y * q.w - 2 * q.x * q.z, x2 - y2 - z2 + w2),
+				mathf::asin(2 * t / u) };
+		}
+		inline static constexpr quat from_euler(const vec<3, T>& r /* radians */) {
+			//const vec<3, T> hr{ r * 0.00872664625f };
+			const vec<3, T> hr{ r * 0.5f };
+			const T
+				x0 = mathf::cos(hr.x), x1 = mathf::sin(hr.x),
+				y0 = mathf::cos(hr.y), y1 = mathf::sin(hr.y),
+				z0 = mathf::cos(hr.z), z1 = mathf::sin(hr.z),
 				y0z0 = y0 * z0, y0z1 = y0 * z1,
 				y1z0 = y1 * z0, y1z1 = y1 * z1;
 			return {
@@ -331,63 +1895,125 @@ namespace pxl {
 				y0z0 * x0 - y1z1 * x1 };
 		}
 	};
+	template<typename T> inline constexpr bool approx_equal(const quat<T>& a, const quat<T>& b, const T& eps = T(1e-5f)) {
+		return mathf::approx_equal(a.x, b.x, eps) && mathf::approx_equal(a.y, b.y, eps) && mathf::approx_equal(a.z, b.z, eps) && mathf::approx_equal(a.w, b.w, eps);
+	}
+	template<typename T> inline constexpr bool ulp_equal(const quat<T>& a, const quat<T>& b, const uint64_t& max_ulps = 4) {
+		return mathf::ulp_equal(a.x, b.x, max_ulps) && mathf::ulp_equal(a.y, b.y, max_ulps) && mathf::ulp_equal(a.z, b.z, max_ulps) && mathf::ulp_equal(a.w, b.w, max_ulps);
+	}
+	// batch forms of quatf::rotate and quatf::slerp, by one quaternion or t, or elementwise
+	// out may be the same array as an input but must not partially overlap it, batch slerp expects 0 <= t <= 1
+	inline void rotate_n(const quatf& q, const vec3f* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::quat_rotate3<simd::f8, false>(&q.x, (const float*)in, (float*)out, n);
+#endif
+#if PXL_SIMD
+		i += simd::quat_rotate3<simd::f4, false>(&q.x, (const float*)(in + i), (float*)(out + i), n - i);
+#endif
+		for (; i < n; ++i) out[i] = q.rotate(in[i]);
+	}
+	inline void rotate_n(const quatf* q, const vec3f* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD
+		i += simd::quat_rotate3<simd::fw, true>(&q->x, (const float*)in, (float*)out, n);
+#endif
+		for (; i < n; ++i) out[i] = q[i].rotate(in[i]);
+	}
+	inline void slerp_n(const quatf* a, const quatf* b, const float& t, quatf* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD
+		i += simd::quat_slerp4<simd::fw, false>(&a->x, &b->x, &t, (float*)out, n);
+#endif
+		for (; i < n; ++i) out[i] = quatf::slerp(a[i], b[i], t);
+	}
+	inline void slerp_n(const quatf* a, const quatf* b, const float* t, quatf* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD
+		i += simd::quat_slerp4<simd::fw, true>(&a->x, &b->x, t, (float*)out, n);
+#endif
+		for (; i < n; ++i) out[i] = quatf::slerp(a[i], b[i], t[i]);
+	}
+	// batch forms of quatf::from_euler and quatf::to_euler with the polynomial simd::sincos and simd::atan2 and the
+	// gimbal lock cases picked per lane. standard is as accurate as the scalar functions, fast is within 4e-5 (to_euler
+	// in radians), exact runs the scalar functions. out must not overlap in
+	template<mathf::precision P = mathf::precision::standard> inline void from_euler_n(const vec3f* in, quatf* out, const size_t& n) {
+		size_t i = 0;
+		if (P != mathf::precision::exact) {
+#if PXL_SIMD == PXL_SIMD_AVX2
+			i += simd::quat_from_euler<P, simd::f8>((const float*)in, (float*)out, n);
+#endif
+#if PXL_SIMD
+			i += simd::quat_from_euler<P, simd::f4>((const float*)(in + i), (float*)(out + i), n - i);
+#endif
+		}
+		for (; i < n; ++i) out[i] = quatf::from_euler(in[i]);
+	}
+	template<mathf::precision P = mathf::precision::standard> inline void to_euler_n(const quatf* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+		if (P != mathf::precision::exact) {
+#if PXL_SIMD == PXL_SIMD_AVX2
+			i += simd::quat_to_euler<P, simd::f8>((const float*)in, (float*)out, n);
+#endif
+#if PXL_SIMD
+			i += simd::quat_to_euler<P, simd::f4>((const float*)(in + i), (float*)(out + i), n - i);
+#endif
+		}
+		for (; i < n; ++i) out[i] = quatf::to_euler(in[i]);
+	}
 
-	struct mat4f {
-		float
+	template<typename T> struct mat<4, 4, T> {
+		T
 			m00, m01, m02, m03,
 			m10, m11, m12, m13,
 			m20, m21, m22, m23,
 			m30, m31, m32, m33;
-		inline constexpr float det() const {
-			const float m2323 = m22 * m33 - m23 * m32;
-			const float m1323 = m21 * m33 - m23 * m31;
-			const float m1223 = m21 * m32 - m22 * m31;
-			const float m0323 = m20 * m33 - m23 * m30;
-			const float m0223 = m20 * m32 - m22 * m30;
-			const float m0123 = m20 * m31 - m21 * m30;
-			const float m2313 = m12 * m33 - m13 * m32;
-			const float m1313 = m11 * m33 - m13 * m31;
-			const float m1213 = m11 * m32 - m12 * m31;
-			const float m2312 = m12 * m23 - m13 * m22;
-			const float m1312 = m11 * m23 - m13 * m21;
-			const float m1212 = m11 * m22 - m12 * m21;
-			const float m0313 = m10 * m33 - m13 * m30;
-			const float m0213 = m10 * m32 - m12 * m30;
-			const float m0312 = m10 * m23 - m13 * m20;
-			const float m0212 = m10 * m22 - m12 * m20;
-			const float m0113 = m10 * m31 - m11 * m30;
-			const float m0112 = m10 * m21 - m11 * m20;
-			float det = m00 * (m11 * m2323 - m12 * m1323 + m13 * m1223)
+		// float matrices go through the simd kernels at runtime
+		static constexpr bool simd_kernels = std::is_same<T, float>::value;
+		inline constexpr T det() const {
+#if PXL_SIMD
+			if constexpr (simd_kernels) if (!PXL_IS_CONSTANT_EVALUATED()) return simd::mat4_det(&m00);
+#endif
+			const T m2323 = m22 * m33 - m23 * m32;
+			const T m1323 = m21 * m33 - m23 * m31;
+			const T m1223 = m21 * m32 - m22 * m31;
+			const T m0323 = m20 * m33 - m23 * m30;
+			const T m0223 = m20 * m32 - m22 * m30;
+			const T m0123 = m20 * m31 - m21 * m30;
+			T det = m00 * (m11 * m2323 - m12 * m1323 + m13 * m1223)
 				- m01 * (m10 * m2323 - m12 * m0323 + m13 * m0223)
 				+ m02 * (m10 * m1323 - m11 * m0323 + m13 * m0123)
 				- m03 * (m10 * m1223 - m11 * m0223 + m12 * m0123);
 			return det;
 		}
-		inline float inverse(mat4f& out) const {
-			const float m2323 = m22 * m33 - m23 * m32;
-			const float m1323 = m21 * m33 - m23 * m31;
-			const float m1223 = m21 * m32 - m22 * m31;
-			const float m0323 = m20 * m33 - m23 * m30;
-			const float m0223 = m20 * m32 - m22 * m30;
-			const float m0123 = m20 * m31 - m21 * m30;
-			const float m2313 = m12 * m33 - m13 * m32;
-			const float m1313 = m11 * m33 - m13 * m31;
-			const float m1213 = m11 * m32 - m12 * m31;
-			const float m2312 = m12 * m23 - m13 * m22;
-			const float m1312 = m11 * m23 - m13 * m21;
-			const float m1212 = m11 * m22 - m12 * m21;
-			const float m0313 = m10 * m33 - m13 * m30;
-			const float m0213 = m10 * m32 - m12 * m30;
-			const float m0312 = m10 * m23 - m13 * m20;
-			const float m0212 = m10 * m22 - m12 * m20;
-			const float m0113 = m10 * m31 - m11 * m30;
-			const float m0112 = m10 * m21 - m11 * m20;
-			const float det = m00 * (m11 * m2323 - m12 * m1323 + m13 * m1223)
+		inline constexpr T inverse(mat& out) const {
+#if PXL_SIMD
+			if constexpr (simd_kernels) if (!PXL_IS_CONSTANT_EVALUATED()) return simd::mat4_inverse(&m00, &out.m00);
+#endif
+			const T m2323 = m22 * m33 - m23 * m32;
+			const T m1323 = m21 * m33 - m23 * m31;
+			const T m1223 = m21 * m32 - m22 * m31;
+			const T m0323 = m20 * m33 - m23 * m30;
+			const T m0223 = m20 * m32 - m22 * m30;
+			const T m0123 = m20 * m31 - m21 * m30;
+			const T m2313 = m12 * m33 - m13 * m32;
+			const T m1313 = m11 * m33 - m13 * m31;
+			const T m1213 = m11 * m32 - m12 * m31;
+			const T m2312 = m12 * m23 - m13 * m22;
+			const T m1312 = m11 * m23 - m13 * m21;
+			const T m1212 = m11 * m22 - m12 * m21;
+			const T m0313 = m10 * m33 - m13 * m30;
+			const T m0213 = m10 * m32 - m12 * m30;
+			const T m0312 = m10 * m23 - m13 * m20;
+			const T m0212 = m10 * m22 - m12 * m20;
+			const T m0113 = m10 * m31 - m11 * m30;
+			const T m0112 = m10 * m21 - m11 * m20;
+			const T det = m00 * (m11 * m2323 - m12 * m1323 + m13 * m1223)
 				- m01 * (m10 * m2323 - m12 * m0323 + m13 * m0223)
 				+ m02 * (m10 * m1323 - m11 * m0323 + m13 * m0123)
 				- m03 * (m10 * m1223 - m11 * m0223 + m12 * m0123);
 			if (det) {
-				const float rdet = 1 / det;
+				const T rdet = 1 / det;
 				out.m00 = rdet * (m11 * m2323 - m12 * m1323 + m13 * m1223);
 				out.m01 = rdet * -(m01 * m2323 - m02 * m1323 + m03 * m1223);
 				out.m02 = rdet * (m01 * m2313 - m02 * m1313 + m03 * m1213);
@@ -407,14 +2033,66 @@ namespace pxl {
 			}
 			return det;
 		}
-		inline constexpr mat4f operator*(const float& o) const {
+		// inverse for a bottom row of 0 0 0 1, the 3x3 block is inverted and the translation mapped through it
+		// returns the 3x3 determinant and leaves out untouched when it is 0, same as inverse
+		inline constexpr T inverse_affine(mat& out) const {
+			const T c00 = m11 * m22 - m12 * m21, c01 = m12 * m20 - m10 * m22, c02 = m10 * m21 - m11 * m20;
+			const T det = m00 * c00 + m01 * c01 + m02 * c02;
+			if (det) {
+				const T rdet = 1 / det;
+				out.m00 = c00 * rdet; out.m01 = (m02 * m21 - m01 * m22) * rdet; out.m02 = (m01 * m12 - m02 * m11) * rdet;
+				out.m10 = c01 * rdet; out.m11 = (m00 * m22 - m02 * m20) * rdet; out.m12 = (m02 * m10 - m00 * m12) * rdet;
+				out.m20 = c02 * rdet; out.m21 = (m01 * m20 - m00 * m21) * rdet; out.m22 = (m00 * m11 - m01 * m10) * rdet;
+				const T x = m03, y = m13, z = m23;
+				out.m03 = -(out.m00 * x + out.m01 * y + out.m02 * z);
+				out.m13 = -(out.m10 * x + out.m11 * y + out.m12 * z);
+				out.m23 = -(out.m20 * x + out.m21 * y + out.m22 * z);
+				out.m30 = 0; out.m31 = 0; out.m32 = 0; out.m33 = 1;
+			}
+			return det;
+		}
+		// inverse for rotation and translation only (orthonormal 3x3, bottom row 0 0 0 1)
+		inline constexpr mat inverse_rigid() const {
+			return {
+				m00, m10, m20, -(m00 * m03 + m10 * m13 + m20 * m23),
+				m01, m11, m21, -(m01 * m03 + m11 * m13 + m21 * m23),
+				m02, m12, m22, -(m02 * m03 + m12 * m13 + m22 * m23),
+				0, 0, 0, 1 };
+		}
+		inline constexpr vec<3, T> transform_point(const vec<3, T>& p) const {
+			return {
+				m00 * p.x + m01 * p.y + m02 * p.z + m03,
+				m10 * p.x + m11 * p.y + m12 * p.z + m13,
+				m20 * p.x + m21 * p.y + m22 * p.z + m23 };
+		}
+		inline constexpr vec<3, T> transform_dir(const vec<3, T>& d) const {
+			return {
+				m00 * d.x + m01 * d.y + m02 * d.z,
+				m10 * d.x + m11 * d.y + m12 * d.z,
+				m20 * d.x + m21 * d.y + m22 * d.z };
+		}
+		inline constexpr vec<4, T> operator*(const vec<4, T>& v) const {
+			return {
+				m00 * v.x + m01 * v.y + m02 * v.z + m03 * v.w,
+				m10 * v.x + m11 * v.y + m12 * v.z + m13 * v.w,
+				m20 * v.x + m21 * v.y + m22 * v.z + m23 * v.w,
+				m30 * v.x + m31 * v.y + m32 * v.z + m33 * v.w };
+		}
+		inline constexpr mat operator*(const T& o) const {
 			return {
 				m00 * o, m01 * o, m02 * o, m03 * o,
 				m10 * o, m11 * o, m12 * o, m13 * o,
 				m20 * o, m21 * o, m22 * o, m23 * o,
 				m30 * o, m31 * o, m32 * o, m33 * o };
 		}
-		inline constexpr mat4f operator*(const mat4f& o) const {
+		inline constexpr mat operator*(const mat& o) const {
+#if PXL_SIMD
+			if constexpr (simd_kernels) if (!PXL_IS_CONSTANT_EVALUATED()) {
+				mat r{};
+				simd::mat4_mul(&m00, &o.m00, &r.m00);
+				return r;
+			}
+#endif
 			return {
 				m00 * o.m00 + m01 * o.m10 + m02 * o.m20 + m03 * o.m30,
 				m00 * o.m01 + m01 * o.m11 + m02 * o.m21 + m03 * o.m31,
@@ -436,43 +2114,99 @@ namespace pxl {
 				m30 * o.m02 + m31 * o.m12 + m32 * o.m22 + m33 * o.m32,
 				m30 * o.m03 + m31 * o.m13 + m32 * o.m23 + m33 * o.m33 };
 		}
-		inline const mat4f& operator =(const float& o) {
+		// *this * o for bottom rows 0 0 0 1 (trs, view), 27 multiplies instead of 64
+		inline constexpr mat mul_affine(const mat& o) const {
+#if PXL_SIMD
+			if constexpr (simd_kernels) if (!PXL_IS_CONSTANT_EVALUATED()) {
+				mat r{};
+				simd::mat4_mul_affine(&m00, &o.m00, &r.m00);
+				return r;
+			}
+#endif
+			return {
+				m00 * o.m00 + m01 * o.m10 + m02 * o.m20,
+				m00 * o.m01 + m01 * o.m11 + m02 * o.m21,
+				m00 * o.m02 + m01 * o.m12 + m02 * o.m22,
+				m00 * o.m03 + m01 * o.m13 + m02 * o.m23 + m03,
+
+				m10 * o.m00 + m11 * o.m10 + m12 * o.m20,
+				m10 * o.m01 + m11 * o.m11 + m12 * o.m21,
+				m10 * o.m02 + m11 * o.m12 + m12 * o.m22,
+				m10 * o.m03 + m11 * o.m13 + m12 * o.m23 + m13,
+
+				m20 * o.m00 + m21 * o.m10 + m22 * o.m20,
+				m20 * o.m01 + m21 * o.m11 + m22 * o.m21,
+				m20 * o.m02 + m21 * o.m12 + m22 * o.m22,
+				m20 * o.m03 + m21 * o.m13 + m22 * o.m23 + m23,
+
+				0, 0, 0, 1 };
+		}
+		inline constexpr const mat& operator =(const T& o) {
 			m00 = o; m01 = o; m02 = o; m03 = o;
 			m10 = o; m11 = o; m12 = o; m13 = o;
 			m20 = o; m21 = o; m22 = o; m23 = o;
 			m30 = o; m31 = o; m32 = o; m33 = o;
 			return *this;
 		}
-		/*inline const mat4f& operator =(const mat4f& o) {
+		/*inline const mat& operator =(const mat& o) {
 			m00 = o.m00; m01 = o.m01; m02 = o.m02; m03 = o.m03;
 			m10 = o.m10; m11 = o.m11; m12 = o.m12; m13 = o.m13;
 			m20 = o.m20; m21 = o.m21; m22 = o.m22; m23 = o.m23;
 			m30 = o.m30; m31 = o.m31; m32 = o.m32; m33 = o.m33;
 			return *this;
 		}*/
-		inline const mat4f& operator*=(const float& o) {
+		inline constexpr const mat& operator*=(const T& o) {
 			m00 *= o; m01 *= o; m02 *= o; m03 *= o;
 			m10 *= o; m11 *= o; m12 *= o; m13 *= o;
 			m20 *= o; m21 *= o; m22 *= o; m23 *= o;
 			m30 *= o; m31 *= o; m32 *= o; m33 *= o;
 			return *this;
 		}
-		inline const mat4f& operator*=(const mat4f& o) { return *this = *this * o; }
-		inline bool operator==(const mat4f& o) { return memcmp(this, &o, sizeof(mat4f)); }
-		inline bool operator!=(const mat4f& o) { return !memcmp(this, &o, sizeof(mat4f)); }
-		inline float& operator[](const size_t& i) { return ((float*)this)[i]; }
-		inline const float& operator[](const size_t& i) const { return ((float*)this)[i]; }
-		inline float& operator()(const size_t& r, const size_t& c) { return *(((float*)this) + (c << 2) + r); }
-		inline const float& operator()(const size_t& r, const size_t& c) const { return *(((float*)this) + (c << 2) + r); }
+		inline constexpr const mat& operator*=(const mat& o) { return *this = *this * o; }
+		inline constexpr bool operator==(const mat& o) const {
+#if PXL_SIMD
+			if constexpr (simd_kernels) if (!PXL_IS_CONSTANT_EVALUATED()) return simd::mat4_equal(&m00, &o.m00);
+#endif
+			return m00 == o.m00 && m01 == o.m01 && m02 == o.m02 && m03 == o.m03 &&
+				m10 == o.m10 && m11 == o.m11 && m12 == o.m12 && m13 == o.m13 &&
+				m20 == o.m20 && m21 == o.m21 && m22 == o.m22 && m23 == o.m23 &&
+				m30 == o.m30 && m31 == o.m31 && m32 == o.m32 && m33 == o.m33;
+		}
+		inline constexpr bool operator!=(const mat& o) const { return !(*this == o); }
+		inline constexpr T& operator[](const size_t& i) { return PXL_IS_CONSTANT_EVALUATED() ? element<T>(*this, i) : (&m00)[i]; }
+		inline constexpr const T& operator[](const size_t& i) const { return PXL_IS_CONSTANT_EVALUATED() ? element<const T>(*this, i) : (&m00)[i]; }
+		inline constexpr T& operator()(const size_t& r, const size_t& c) { return (*this)[(c << 2) + r]; }
+		inline constexpr const T& operator()(const size_t& r, const size_t& c) const { return (*this)[(c << 2) + r]; }
 
-		inline static constexpr mat4f zero() { return { 0 }; }
-		inline static constexpr mat4f identity() { return { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 }; }
+		inline static constexpr mat zero() { return {}; }
+		inline static constexpr mat identity() { return { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 }; }
+		// member i in storage order, operator[] in constant evaluation where members can't be indexed through a pointer
+		template<typename F, typename M> inline static constexpr F& element(M& m, const size_t& i) {
+			switch (i) {
+			case 0: return m.m00;
+			case 1: return m.m01;
+			case 2: return m.m02;
+			case 3: return m.m03;
+			case 4: return m.m10;
+			case 5: return m.m11;
+			case 6: return m.m12;
+			case 7: return m.m13;
+			case 8: return m.m20;
+			case 9: return m.m21;
+			case 10: return m.m22;
+			case 11: return m.m23;
+			case 12: return m.m30;
+			case 13: return m.m31;
+			case 14: return m.m32;
+			default: return m.m33;
+			}
+		}
 
-		inline static vec3f to_translation(const mat4f& m) { return { m.m03, m.m13, m.m23 }; }
-		inline static quatf to_rotation(const mat4f& m) {
-			float e = m.m00 + m.m11 + m.m22;
+		inline static constexpr vec<3, T> to_translation(const mat& m) { return { m.m03, m.m13, m.m23 }; }
+		inline static constexpr quat<T> to_rotation(const mat& m) {
+			T e = m.m00 + m.m11 + m.m22;
 			if (e > 0) {
-				const float a = mathf::rsqrt(e + 1.0) * 0.5f; // S=4*qw 
+				const T a = mathf::rsqrt(T(e + 1)) * 0.5f; // S=4*qw 
 				return {
 					(m.m21 - m.m12) * a,
 					(m.m02 - m.m20) * a,
@@ -480,7 +2214,7 @@ namespace pxl {
 					0.25f / a };
 			}
 			else if ((m.m00 > m.m11) && (m.m00 > m.m22)) {
-				float a = mathf::rsqrt(1.0 + m.m00 - m.m11 - m.m22) * 0.5f; // S=4*qx 
+				T a = mathf::rsqrt(T(1 + m.m00 - m.m11 - m.m22)) * 0.5f; // S=4*qx 
 				return {
 					0.25f / a,
 					(m.m01 + m.m10) * a,
@@ -489,7 +2223,7 @@ namespace pxl {
 
 			}
 			else if (m.m11 > m.m22) {
-				float a = mathf::rsqrt(1.0 + m.m11 - m.m00 - m.m22) * 0.5f; // S=4*qy
+				T a = mathf::rsqrt(T(1 + m.m11 - m.m00 - m.m22)) * 0.5f; // S=4*qy
 				return {
 					(m.m01 + m.m10) * a,
 					0.25f / a,
@@ -497,7 +2231,7 @@ namespace pxl {
 					(m.m02 - m.m20) * a };
 			}
 			else {
-				float a = mathf::rsqrt(1.0 + m.m22 - m.m00 - m.m11) * 0.5f; // S=4*qz
+				T a = mathf::rsqrt(T(1 + m.m22 - m.m00 - m.m11)) * 0.5f; // S=4*qz
 				return {
 					(m.m02 + m.m20) * a,
 					(m.m12 + m.m21) * a,
@@ -505,14 +2239,26 @@ namespace pxl {
 					(m.m10 - m.m01) * a };
 			}
 		}
-		inline static vec3f to_scale(const mat4f& m) {
+		// column lengths, scales are assumed positive
+		inline static constexpr vec<3, T> to_scale(const mat& m) {
 			return {
-				m.m00 * m.m00 + m.m10 * m.m10 + m.m20 * m.m20,
-				m.m01 * m.m01 + m.m11 * m.m11 + m.m21 * m.m21,
-				m.m02 * m.m02 + m.m12 * m.m12 + m.m22 * m.m22 };
+				mathf::sqrt(m.m00 * m.m00 + m.m10 * m.m10 + m.m20 * m.m20),
+				mathf::sqrt(m.m01 * m.m01 + m.m11 * m.m11 + m.m21 * m.m21),
+				mathf::sqrt(m.m02 * m.m02 + m.m12 * m.m12 + m.m22 * m.m22) };
+		}
+		// inverse of trs for positive scales, the rotation is taken after dividing the scale out
+		inline static constexpr void decompose(const mat& m, vec<3, T>& t, quat<T>& r, vec<3, T>& s) {
+			t = to_translation(m);
+			s = to_scale(m);
+			const T x = 1 / mathf::max(s.x, T(1e-30f)), y = 1 / mathf::max(s.y, T(1e-30f)), z = 1 / mathf::max(s.z, T(1e-30f));
+			r = to_rotation({
+				m.m00 * x, m.m01 * y, m.m02 * z, 0,
+				m.m10 * x, m.m11 * y, m.m12 * z, 0,
+				m.m20 * x, m.m21 * y, m.m22 * z, 0,
+				0, 0, 0, 1 });
 		}
-		inline static constexpr mat4f trs(const vec3f& t, const quatf& r, const vec3f& s) {
-			const float x = r.x, y = r.y, z = r.z, w = r.w,
+		inline static constexpr mat trs(const vec<3, T>& t, const quat<T>& r, const vec<3, T>& s) {
+			const T x = r.x, y = r.y, z = r.z, w = r.w,
 				x2 = x * x, y2 = y * y, z2 = z * z, xy = x * y, xz = x * z, yz = y * z,
 				wx = w * x, wy = w * y, wz = w * z;
 			return {
@@ -521,8 +2267,8 @@ namespace pxl {
 				(2.0f * (xz - wy)) * s.x, (2.0f * (yz + wx)) * s.y, (1.0f - 2.0f * (x2 + y2)) * s.z, t.z,
 				0, 0, 0, 1 };
 		}
-		inline static void trs(mat4f& m, const vec3f& t, const quatf& r, const vec3f& s) {
-			const float x = r.x, y = r.y, z = r.z, w = r.w,
+		inline static constexpr void trs(mat& m, const vec<3, T>& t, const quat<T>& r, const vec<3, T>& s) {
+			const T x = r.x, y = r.y, z = r.z, w = r.w,
 				x2 = x * x, y2 = y * y, z2 = z * z, xy = x * y, xz = x * z, yz = y * z,
 				wx = w * x, wy = w * y, wz = w * z;
 
@@ -531,8 +2277,8 @@ namespace pxl {
 			m.m20 = (2.0f * (xz - wy)) * s.x; m.m21 = (2.0f * (yz + wx)) * s.y; m.m22 = (1.0f - 2.0f * (x2 + y2)) * s.z; m.m23 = t.z;
 			m.m30 = 0; m.m31 = 0; m.m32 = 0; m.m33 = 1;
 		}
-		inline static constexpr mat4f view(const vec3f& t, const quatf& r, const vec3f& s) {
-			const float x = r.x, y = r.y, z = r.z, w = r.w,
+		inline static constexpr mat view(const vec<3, T>& t, const quat<T>& r, const vec<3, T>& s) {
+			const T x = r.x, y = r.y, z = r.z, w = r.w,
 				x2 = x * x, y2 = y * y, z2 = z * z, xy = x * y, xz = x * z, yz = y * z,
 				wx = w * x, wy = w * y, wz = w * z;
 			return {
@@ -541,8 +2287,8 @@ namespace pxl {
 				(2.0f * (xz - wy)) * s.x, (2.0f * (yz + wx)) * s.y, (1.0f - 2.0f * (x2 + y2)) * s.z, t.z,
 				0, 0, 0, 1 };
 		}
-		inline static void view(mat4f& m, const vec3f& t, const quatf& r, const vec3f& s) {
-			const float x = r.x, y = r.y, z = r.z, w = r.w,
+		inline static constexpr void view(mat& m, const vec<3, T>& t, const quat<T>& r, const vec<3, T>& s) {
+			const T x = r.x, y = r.y, z = r.z, w = r.w,
 				x2 = x * x, y2 = y * y, z2 = z * z, xy = x * y, xz = x * z, yz = y * z,
 				wx = w * x, wy = w * y, wz = w * z;
 
@@ -551,24 +2297,24 @@ namespace pxl {
 			m.m20 = (2.0f * (xz - wy)) * s.x; m.m21 = (2.0f * (yz + wx)) * s.y; m.m22 = (1.0f - 2.0f * (x2 + y2)) * s.z; m.m23 = t.z;
 			m.m30 = 0; m.m31 = 0; m.m32 = 0; m.m33 = 1;
 		}
-		inline static constexpr mat4f orthographic(const float& n /*near*/, const float& f /*far*/,
-			const float& l /*left*/, const float& r /*right*/, const float& t /*top*/, const float& b /*bottom*/, const float& s = 1 /*size*/) {
+		inline static constexpr mat orthographic(const T& n /*near*/, const T& f /*far*/,
+			const T& l /*left*/, const T& r /*right*/, const T& t /*top*/, const T& b /*bottom*/, const T& s = 1 /*size*/) {
 			return {
 				2 / (r - l) * s, 0, 0, -((r + l) / (r - l)), // (1-1)/(1+1)
 				0, 2 / (t - b) * s, 0, -((t + b) / (t - b)),
 				0, 0, -2 / (f - n) * s, -((f + n) / (f - n)),
 				0, 0, 0, 1 };
 		}
-		inline static void orthographic(mat4f& m, const float& n /*near*/, const float& f /*far*/,
-			const float& l /*left*/, const float& r /*right*/, const float& t /*top*/, const float& b /*bottom*/, const float& s = 1 /*size*/)
+		inline static constexpr void orthographic(mat& m, const T& n /*near*/, const T& f /*far*/,
+			const T& l /*left*/, const T& r /*right*/, const T& t /*top*/, const T& b /*bottom*/, const T& s = 1 /*size*/)
 		{
 			m.m00 = 2 / (r - l) * s; m.m01 = 0; m.m02 = 0; m.m03 = -((r + l) / (r - l));
 			m.m10 = 0; m.m11 = 2 / (t - b) * s; m.m12 = 0; m.m13 = -((t + b) / (t - b));
 			m.m20 = 0; m.m21 = 0; m.m22 = -2 / (f - n) * s; m.m23 = -((f + n) / (f - n));
 			m.m30 = 0; m.m31 = 0; m.m32 = 0; m.m33 = 1;
 		}
-		inline static constexpr mat4f perspective(const float& n /*near*/, const float& f /*far*/,
-			const float& l /*left*/, const float& r /*right*/, const float& t /*top*/, const float& b /*bottom*/)
+		inline static constexpr mat perspective(const T& n /*near*/, const T& f /*far*/,
+			const T& l /*left*/, const T& r /*right*/, const T& t /*top*/, const T& b /*bottom*/)
 		{
 			return {
 				(2 * n) / (r - l), 0, (r + l) / (r - l), 0,
@@ -576,12 +2322,185 @@ namespace pxl {
 				0, 0, (f + n) / (n - f), (2 * f * n) / (n - f),
 				0, 0, -1, 0 };
 		}
-		inline static void perspective(mat4f& m, const float& n /*near*/, const float& f /*far*/,
-			const float& l /*left*/, const float& r /*right*/, const float& t /*top*/, const float& b /*bottom*/) {
+		inline static constexpr void perspective(mat& m, const T& n /*near*/, const T& f /*far*/,
+			const T& l /*left*/, const T& r /*right*/, const T& t /*top*/, const T& b /*bottom*/) {
 			m.m00 = (2 * n) / (r - l); m.m01 = 0; m.m02 = (r + l) / (r - l); m.m03 = 0;
 			m.m10 = 0; m.m11 = (2 * n) / (t - b); m.m12 = (t + b) / (t - b); m.m13 = 0;
 			m.m20 = 0; m.m21 = 0; m.m22 = -(f + n) / (f - n); m.m23 = (-2 * f * n) / (f - n);
 			m.m30 = 0; m.m31 = 0; m.m32 = -1; m.m33 = 0;
 		}
 	};
+
+	template<typename T> inline constexpr bool approx_equal(const mat<4, 4, T>& a, const mat<4, 4, T>& b, const T& eps = T(1e-5f)) {
+#if PXL_SIMD
+		if constexpr (mat<4, 4, T>::simd_kernels) if (!PXL_IS_CONSTANT_EVALUATED()) return simd::mat4_approx_equal(&a.m00, &b.m00, eps);
+#endif
+		for (size_t i = 0; i < 16; ++i) if (!mathf::approx_equal(a[i], b[i], eps)) return false;
+		return true;
+	}
+	template<typename T> inline constexpr bool ulp_equal(const mat<4, 4, T>& a, const mat<4, 4, T>& b, const uint64_t& max_ulps = 4) {
+		for (size_t i = 0; i < 16; ++i) if (!mathf::ulp_equal(a[i], b[i], max_ulps)) return false;
+		return true;
+	}
+
+	// batch forms of mat4f::transform_point/transform_dir/operator*(vec4f), the bottom row is ignored for vec3f
+	// out may be the same array as in but must not partially overlap it
+	inline void transform_points(const mat4f& m, const vec3f* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::mat4_transform3<simd::f8, true>(&m.m00, (const float*)in, (float*)out, n);
+#endif
+#if PXL_SIMD
+		i += simd::mat4_transform3<simd::f4, true>(&m.m00, (const float*)(in + i), (float*)(out + i), n - i);
+#endif
+		for (; i < n; ++i) out[i] = m.transform_point(in[i]);
+	}
+	inline void transform_dirs(const mat4f& m, const vec3f* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::mat4_transform3<simd::f8, false>(&m.m00, (const float*)in, (float*)out, n);
+#endif
+#if PXL_SIMD
+		i += simd::mat4_transform3<simd::f4, false>(&m.m00, (const float*)(in + i), (float*)(out + i), n - i);
+#endif
+		for (; i < n; ++i) out[i] = m.transform_dir(in[i]);
+	}
+	inline void transform(const mat4f& m, const vec4f* in, vec4f* out, const size_t& n) {
+#if PXL_SIMD
+		simd::mat4_transform4(&m.m00, (const float*)in, (float*)out, n);
+#else
+		for (size_t i = 0; i < n; ++i) out[i] = m * in[i];
+#endif
+	}
+
+	// batch forms of mat4f::trs and mat4f::decompose over parallel arrays, without data-dependent branches
+	inline void trs_n(const vec3f* t, const quatf* r, const vec3f* s, mat4f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::mat4_trs<simd::f8>((const float*)t, (const float*)r, (const float*)s, (float*)out, n);
+#endif
+#if PXL_SIMD
+		i += simd::mat4_trs<simd::f4>((const float*)(t + i), (const float*)(r + i), (const float*)(s + i), (float*)(out + i), n - i);
+#endif
+		for (; i < n; ++i) mat4f::trs(out[i], t[i], r[i], s[i]);
+	}
+	inline void decompose_n(const mat4f* m, vec3f* t, quatf* r, vec3f* s, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::mat4_decompose<simd::f8>((const float*)m, (float*)t, (float*)r, (float*)s, n);
+#endif
+#if PXL_SIMD
+		i += simd::mat4_decompose<simd::f4>((const float*)(m + i), (float*)(t + i), (float*)(r + i), (float*)(s + i), n - i);
+#endif
+		for (; i < n; ++i) mat4f::decompose(m[i], t[i], r[i], s[i]);
+	}
+
+	// n floats to a 16-bit storage format and back, vec<N, T> arrays convert as n * N scalars
+	// out must not overlap in
+	inline void convert_n(const float* in, half* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD_HALF && PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::pack_half<simd::f8>(in, (uint16_t*)out, n);
+#endif
+#if PXL_SIMD_HALF
+		i += simd::pack_half<simd::f4>(in + i, (uint16_t*)(out + i), n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const half* in, float* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD_HALF && PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::unpack_half<simd::f8>((const uint16_t*)in, out, n);
+#endif
+#if PXL_SIMD_HALF
+		i += simd::unpack_half<simd::f4>((const uint16_t*)(in + i), out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const float* in, snorm16* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::pack_norm16<simd::f8>(in, (int16_t*)out, n);
+#endif
+#if PXL_SIMD
+		i += simd::pack_norm16<simd::f4>(in + i, (int16_t*)(out + i), n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const snorm16* in, float* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::unpack_norm16<simd::f8>((const int16_t*)in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::unpack_norm16<simd::f4>((const int16_t*)(in + i), out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const float* in, unorm16* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::pack_norm16<simd::f8>(in, (uint16_t*)out, n);
+#endif
+#if PXL_SIMD
+		i += simd::pack_norm16<simd::f4>(in + i, (uint16_t*)(out + i), n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const unorm16* in, float* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::unpack_norm16<simd::f8>((const uint16_t*)in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::unpack_norm16<simd::f4>((const uint16_t*)(in + i), out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	template<size_t N, typename T, typename U> inline void convert_n(const vec<N, T>* in, vec<N, U>* out, const size_t& n) {
+		convert_n((const T*)in, (U*)out, n * N);
+	}
+
+	// hashes that agree with ==, +0 and -0 hash alike and the 16-bit formats by their float value, meant for unordered
+	// containers and memoization keys (std::hash is specialized below), not for anything adversarial. Floats go in as
+	// pairs, one multiply per 64 bits on two alternating chains, and a final mix spreads every bit over the result
+	namespace detail {
+		struct hasher {
+			uint64_t h[2]{ 0x9e3779b97f4a7c15ull, 0x6a09e667f3bcc909ull };
+			size_t n{ 0 };
+			inline constexpr void word(const uint64_t& w) { uint64_t& x = h[n++ & 1]; x = (x ^ w) * 0xff51afd7ed558ccdull; }
+			inline constexpr void add(const float& a) { word(mathf::bit_cast<uint32_t>(a + 0.0f)); }
+			inline constexpr void add(const float& a, const float& b) { word(mathf::bit_cast<uint32_t>(a + 0.0f) | uint64_t(mathf::bit_cast<uint32_t>(b + 0.0f)) << 32); }
+			inline constexpr void add(const double& a) { word(mathf::bit_cast<uint64_t>(a + 0.0)); }
+			inline constexpr void add(const double& a, const double& b) { add(a); add(b); }
+			inline constexpr size_t finish() const {
+				uint64_t x = h[0] ^ (h[1] << 32 | h[1] >> 32);
+				x ^= x >> 33; x *= 0xff51afd7ed558ccdull; x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull; x ^= x >> 33;
+				return size_t(x);
+			}
+		};
+	}
+	template<size_t N, typename T> inline constexpr size_t hash(const vec<N, T>& v) {
+		typedef typename vec<N, T>::real R;
+		detail::hasher h;
+		for (size_t i = 0; i + 1 < N; i += 2) h.add(R(v[i]), R(v[i + 1]));
+		if (N & 1) h.add(R(v[N - 1]));
+		return h.finish();
+	}
+	template<typename T> inline constexpr size_t hash(const quat<T>& q) {
+		detail::hasher h;
+		h.add(q.x, q.y); h.add(q.z, q.w);
+		return h.finish();
+	}
+	template<typename T> inline constexpr size_t hash(const mat<4, 4, T>& m) {
+		detail::hasher h;
+		for (size_t i = 0; i < 16; i += 2) h.add(m[i], m[i + 1]);
+		return h.finish();
+	}
+}
+
+namespace std {
+	template<size_t N, typename T> struct hash<pxl::vec<N, T>> { inline size_t operator()(const pxl::vec<N, T>& v) const { return pxl::hash(v); } };
+	template<typename T> struct hash<pxl::quat<T>> { inline size_t operator()(const pxl::quat<T>& q) const { return pxl::hash(q); } };
+	template<typename T> struct hash<pxl::mat<4, 4, T>> { inline size_t operator()(const pxl::mat<4, 4, T>& m) const { return pxl::hash(m); } };
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "pxlmath.h"
+#include "pxlmath_jobs.h"
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+namespace pxl {
+	// step holds the earlier key. linear is a lerp for vec3f and an nlerp along the shortest arc for quatf. cubic is
+	// a hermite spline for vec3f, through the track's own tangents or catmull-rom ones from the neighbouring keys,
+	// and squad for quatf
+	enum class interpolation : uint8_t { step, linear, cubic };
+
+	// what a track without keys gives: zero for vec3f, identity for quatf
+	template<typename T> inline T rest_value() { return T{}; }
+	template<> inline quatf rest_value<quatf>() { return quatf::identity(); }
+
+	// keyframes of one channel, times ascending in seconds. tangents is empty or holds an in and an out tangent per
+	// key (tangents[2i] and tangents[2i + 1], in value per second) for cubic vec3f tracks. Before the first and after
+	// the last key the track holds that key's value. A playback instance keeps one cursor per track, starting at 0:
+	// it remembers the segment of the last sample, so forward playback finds the next one in O(1) and only jumps
+	// search. Tracks without keys give rest
+	template<typename T> struct track {
+		std::vector<float> times;
+		std::vector<T> values, tangents;
+		interpolation mode{ interpolation::linear };
+		T rest{ rest_value<T>() };
+
+		inline size_t size() const { return times.size(); }
+		inline bool empty() const { return times.empty(); }
+		inline float start() const { return empty() ? 0 : times.front(); }
+		inline float end() const { return empty() ? 0 : times.back(); }
+		inline void add(const float& t, const T& v) { times.push_back(t); values.push_back(v); }
+
+		inline T sample(const float& t, uint32_t& cursor) const {
+			const uint32_t n = (uint32_t)times.size();
+			if (!n) return rest;
+			if (n == 1 || !(t > times[0])) return values[0];
+			if (t >= times[n - 1]) return values[n - 1];
+			const uint32_t k = seek(times.data(), n, t, cursor);
+			return interpolate(k, (t - times[k]) / (times[k + 1] - times[k]));
+		}
+		// without a cursor, a binary search every time
+		inline T sample(const float& t) const {
+			uint32_t cursor = 0;
+			return sample(t, cursor);
+		}
+
+		// segment k with times[k] <= t < times[k + 1] for times[0] < t < times[n - 1]. The cursor's segment and the
+		// one after it are tried first, anything else is a binary search
+		inline static uint32_t seek(const float* times, const uint32_t& n, const float& t, uint32_t& cursor) {
+			const uint32_t k = cursor;
+			if (k + 1 < n && times[k] <= t) {
+				if (t < times[k + 1]) return k;
+				if (k + 2 < n && t < times[k + 2]) return cursor = k + 1;
+			}
+			return cursor = uint32_t(std::upper_bound(times + 1, times + n - 1, t) - times) - 1;
+		}
+
+	private:
+		// value between keys k and k + 1 at u in [0, 1)
+		inline T interpolate(const uint32_t& k, const float& u) const;
+	};
+
+	template<> inline vec3f track<vec3f>::interpolate(const uint32_t& k, const float& u) const {
+		const vec3f& p0 = values[k];
+		const vec3f& p1 = values[k + 1];
+		if (mode == interpolation::step) return p0;
+		if (mode == interpolation::linear) return madd(p1 - p0, u, p0);
+		const uint32_t n = (uint32_t)values.size();
+		const float dt = times[k + 1] - times[k];
+		vec3f m0, m1;
+		if (tangents.size() >= 2 * size_t(n)) {
+			m0 = tangents[2 * k + 1];
+			m1 = tangents[2 * k + 2];
+		}
+		else {
+			// catmull-rom over uneven key spacing, one-sided at the ends
+			const uint32_t a = k ? k - 1 : k, b = k + 2 < n ? k + 2 : k + 1;
+			m0 = (p1 - values[a]) / (times[k + 1] - times[a]);
+			m1 = (values[b] - p0) / (times[b] - times[k]);
+		}
+		const float u2 = u * u, u3 = u2 * u;
+		const float h00 = 2 * u3 - 3 * u2 + 1, h10 = (u3 - 2 * u2 + u) * dt, h01 = 3 * u2 - 2 * u3, h11 = (u3 - u2) * dt;
+		return madd(p0, h00, madd(m0, h10, madd(p1, h01, m1 * h11)));
+	}
+	template<> inline quatf track<quatf>::interpolate(const uint32_t& k, const float& u) const {
+		const quatf& q1 = values[k];
+		const quatf& q2 = values[k + 1];
+		if (mode == interpolation::step) return q1;
+		if (mode == interpolation::linear) return quatf::nlerp(q1, q2, u);
+		const uint32_t n = (uint32_t)values.size();
+		const quatf& q0 = values[k ? k - 1 : k];
+		const quatf& q3 = values[k + 2 < n ? k + 2 : k + 1];
+		return quatf::squad(q1, q2, quatf::squad_control(q0, q1, q2), quatf::squad_control(q1, q2, q3), u);
+	}
+
+	// every track at time t through its cursor, tracks[i] into out[i]. Runs of grain tracks go to pool
+	template<typename T> inline void sample_n(const track<T>* tracks, const size_t& n, const float& t, uint32_t* cursors, T* out,
+		job_pool* pool = nullptr, const size_t& grain = 256) {
+		const auto run = [&](const size_t& b, const size_t& e) {
+			for (size_t i = b; i < e; ++i) out[i] = tracks[i].sample(t, cursors[i]);
+		};
+		if (pool) pool->parallel_for(n, grain, run);
+		else if (n) run(0, n);
+	}
+
+	// one animation, a translation, rotation and scale track per joint. sample writes straight into the arrays
+	// trs_n and scene_graph::position / rotation / scale take, with 3 * size() cursors per playback instance.
+	// Tracks without keys hold the identity, resize gives new scale tracks a rest of 1
+	struct clip {
+		std::vector<track<vec3f>> translation, scale;
+		std::vector<track<quatf>> rotation;
+
+		inline size_t size() const { return rotation.size(); }
+		inline void resize(const size_t& joints) {
+			translation.resize(joints); rotation.resize(joints);
+			track<vec3f> unit;
+			unit.rest = { 1, 1, 1 };
+			scale.resize(joints, unit);
+		}
+		// last key over all tracks
+		inline float duration() const {
+			float d = 0;
+			for (size_t i = 0; i < size(); ++i) d = std::max(d, std::max(translation[i].end(), std::max(rotation[i].end(), scale[i].end())));
+			return d;
+		}
+		inline void sample(const float& t, uint32_t* cursors, vec3f* out_t, quatf* out_r, vec3f* out_s, job_pool* pool = nullptr, const size_t& grain = 256) const {
+			const size_t n = size();
+			sample_n(translation.data(), n, t, cursors, out_t, pool, grain);
+			sample_n(rotation.data(), n, t, cursors + n, out_r, pool, grain);
+			sample_n(scale.data(), n, t, cursors + 2 * n, out_s, pool, grain);
+		}
+	};
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "pxlmath.h"
+#include <atomic>
+#include <new>
+
+namespace pxl {
+	// opt-in over-aligned T, the plain types keep their natural alignment so existing layouts do not change.
+	// aligned<T, A> derives from T and converts both ways; when A divides sizeof(T) an array of it has the same
+	// layout as an array of T, so a span of it views as a span of T with no copy. mat4f goes to a full cache line,
+	// every row load then stays inside it
+	template<typename T, size_t A> struct alignas(A) aligned : T {
+		aligned() = default;
+		inline constexpr aligned(const T& v) : T(v) {}
+		inline constexpr aligned& operator =(const T& v) { static_cast<T&>(*this) = v; return *this; }
+	};
+	typedef aligned<vec4f, 16> vec4f_aligned;
+	typedef aligned<quatf, 16> quatf_aligned;
+	typedef aligned<mat4f, 64> mat4f_aligned;
+
+	// pointer and count, what the batch functions take. span<U> converts to span<T> when a U* is a T* and the
+	// elements have the same size (span<mat4f_aligned> to span<const mat4f> and the like)
+	template<typename T> struct span {
+		T* ptr{ nullptr };
+		size_t count{ 0 };
+
+		inline constexpr span() {}
+		inline constexpr span(T* p, const size_t& n) : ptr(p), count(n) {}
+		template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value && sizeof(U) == sizeof(T)>::type>
+		inline constexpr span(const span<U>& o) : ptr(o.ptr), count(o.count) {}
+
+		inline constexpr T* data() const { return ptr; }
+		inline constexpr size_t size() const { return count; }
+		inline constexpr bool empty() const { return count == 0; }
+		inline constexpr T* begin() const { return ptr; }
+		inline constexpr T* end() const { return ptr + count; }
+		inline constexpr T& operator[](const size_t& i) const { return ptr[i]; }
+		// the n elements from offset, clamped to the end
+		inline constexpr span subspan(const size_t& offset, const size_t& n = ~size_t(0)) const {
+			const size_t o = offset < count ? offset : count;
+			return { ptr + o, n < count - o ? n : count - o };
+		}
+	};
+
+	// bump allocator for per-frame buffers. One 64-byte aligned block is reserved up front, take<T>(n) hands out
+	// cache-line aligned spans of uninitialized T and reset() drops all of them at once, so a frame allocates
+	// nothing. take is a single atomic add and may be called from job_pool workers; an exhausted block gives an
+	// empty span. peak() is the high water mark over the resets so far, failed takes included, to size the next reserve
+	struct frame_arena {
+		static constexpr size_t alignment = 64;
+
+		inline frame_arena() {}
+		inline explicit frame_arena(const size_t& bytes) { reserve(bytes); }
+		inline ~frame_arena() { release(); }
+		frame_arena(const frame_arena&) = delete;
+		frame_arena& operator =(const frame_arena&) = delete;
+
+		// replaces the block, every span taken before is invalid
+		inline void reserve(const size_t& bytes) {
+			release();
+			capacity = (bytes + alignment - 1) & ~(alignment - 1);
+			if (capacity) base = (unsigned char*)::operator new(capacity, std::align_val_t(alignment));
+		}
+		inline void release() {
+			if (base) ::operator delete(base, std::align_val_t(alignment));
+			base = nullptr;
+			capacity = 0;
+			used = 0;
+		}
+		template<typename T> inline span<T> take(const size_t& n) {
+			static_assert(std::is_trivially_destructible<T>::value, "frame_arena never runs destructors");
+			static_assert(alignof(T) <= alignment, "frame_arena aligns to a cache line");
+			if (n > capacity / sizeof(T)) return {};
+			const size_t bytes = (n * sizeof(T) + alignment - 1) & ~(alignment - 1);
+			const size_t at = used.fetch_add(bytes, std::memory_order_relaxed);
+			if (at + bytes > capacity) return {};
+			return { (T*)(base + at), n };
+		}
+		// not concurrent with take
+		inline void reset() {
+			const size_t u = used.load(std::memory_order_relaxed);
+			if (u > high) high = u;
+			used.store(0, std::memory_order_relaxed);
+		}
+		inline size_t size() const { return capacity; }
+		inline size_t in_use() const { const size_t u = used.load(std::memory_order_relaxed); return u < capacity ? u : capacity; }
+		inline size_t peak() const { const size_t u = used.load(std::memory_order_relaxed); return u > high ? u : high; }
+
+	private:
+		unsigned char* base{ nullptr };
+		size_t capacity{ 0 }, high{ 0 };
+		std::atomic<size_t> used{ 0 };
+	};
+
+	// span forms of the batch functions, n is out.size() and the inputs must hold at least that many
+	inline void transform_points(const mat4f& m, const span<const vec3f>& in, const span<vec3f>& out) { transform_points(m, in.data(), out.data(), out.size()); }
+	inline void transform_dirs(const mat4f& m, const span<const vec3f>& in, const span<vec3f>& out) { transform_dirs(m, in.data(), out.data(), out.size()); }
+	inline void transform(const mat4f& m, const span<const vec4f>& in, const span<vec4f>& out) { transform(m, in.data(), out.data(), out.size()); }
+	inline void trs_n(const span<const vec3f>& t, const span<const quatf>& r, const span<const vec3f>& s, const span<mat4f>& out) {
+		trs_n(t.data(), r.data(), s.data(), out.data(), out.size());
+	}
+	inline void decompose_n(const span<const mat4f>& m, const span<vec3f>& t, const span<quatf>& r, const span<vec3f>& s) {
+		decompose_n(m.data(), t.data(), r.data(), s.data(), m.size());
+	}
+}
@@ -0,0 +1,399 @@
+#pragma once
+
+#include "pxlmath_geom.h"
+#include "pxlmath_jobs.h"
+#include <algorithm>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace pxl {
+	// bounding volume hierarchy over n boxes, built top down with the binned surface area heuristic. Nodes are 32
+	// bytes and the two children of a node share a 64-byte line, so each traversal step tests both with one miss.
+	// Leaves are ranges of order, the primitive indices, of at most leaf_size. The build hands subtrees to pool
+	struct bvh {
+		static constexpr uint32_t none = ~0u;
+		static constexpr size_t bins = 16, max_depth = 48, stack_size = 128;
+		// count 0 is an inner node with children index and index + 1, otherwise a leaf over order[index, index + count)
+		struct node {
+			aabb box;
+			uint32_t index, count;
+		};
+		struct alignas(64) node_pair { node child[2]; };
+
+		std::vector<node_pair> nodes; // node i is nodes[i / 2].child[i % 2], the root is node 0 and node 1 is unused
+		std::vector<uint32_t> order;
+
+		inline const node& operator[](const uint32_t& i) const { return nodes[i >> 1].child[i & 1]; }
+		inline bool empty() const { return order.empty(); }
+		inline size_t size() const { return order.size(); }
+		inline aabb bounds() const { return empty() ? aabb::empty() : (*this)[0].box; }
+
+		// replaces the tree, bounds need only stay alive for the call
+		inline void build(const aabb* bounds, const size_t& n, job_pool* pool = nullptr, const size_t& leaf_size = 4) {
+			order.resize(n);
+			nodes.assign(n, node_pair{}); // 2n - 1 nodes with the unused node 1
+			if (!n) return;
+			builder b{ bounds, std::vector<vec3f>(n), *this, pool, leaf_size ? leaf_size : 1 };
+			const auto init = [&](const size_t& s, const size_t& e) {
+				for (size_t i = s; i < e; ++i) {
+					order[i] = (uint32_t)i;
+					b.centers[i] = bounds[i].center();
+				}
+			};
+			if (pool) pool->parallel_for(n, 4096, init);
+			else init(0, n);
+			b.split(0, 0, (uint32_t)n, 0);
+		}
+		// over triangles, 3 indices each
+		inline void build(const vec3f* vertices, const uint32_t* indices, const size_t& triangles, job_pool* pool = nullptr, const size_t& leaf_size = 4) {
+			std::vector<aabb> boxes(triangles);
+			for (size_t i = 0; i < triangles; ++i) {
+				const uint32_t* t = indices + 3 * i;
+				boxes[i] = aabb{ vertices[t[0]], vertices[t[0]] }.expand(vertices[t[1]]).expand(vertices[t[2]]);
+			}
+			build(boxes.data(), triangles, pool, leaf_size);
+		}
+
+		// closest hit, prim(i, r, t) tests primitive i and lowers t on a hit, returns whether any did. Children are
+		// visited nearest first and subtrees entered beyond the current t are skipped
+		template<typename F> inline bool intersect(const ray& r, float& t, const F& prim) const {
+			if (empty()) return false;
+			const vec3f inv = r.inv_dir();
+			float tn = t;
+			if (!r.intersects((*this)[0].box, inv, tn)) return false;
+			struct entry { uint32_t i; float near; } stack[stack_size];
+			size_t sp = 0;
+			uint32_t i = 0;
+			bool hit = false;
+			for (;;) {
+				const node& nd = (*this)[i];
+				if (nd.count) {
+					for (uint32_t k = 0; k < nd.count; ++k) hit |= prim(order[nd.index + k], r, t);
+				}
+				else {
+					const node* c = &(*this)[nd.index];
+					float n0 = t, n1 = t;
+					const bool h0 = r.intersects(c[0].box, inv, n0), h1 = r.intersects(c[1].box, inv, n1);
+					if (h0 && h1) {
+						const bool f = n1 < n0;
+						stack[sp++] = { nd.index + !f, f ? n0 : n1 };
+						i = nd.index + f;
+						continue;
+					}
+					if (h0 || h1) {
+						i = nd.index + h1;
+						continue;
+					}
+				}
+				for (;;) {
+					if (!sp) return hit;
+					const entry& e = stack[--sp];
+					if (e.near <= t) { i = e.i; break; }
+				}
+			}
+		}
+		// any hit within t, prim as in intersect and given a copy of t
+		template<typename F> inline bool occluded(const ray& r, const float& t, const F& prim) const {
+			if (empty()) return false;
+			const vec3f inv = r.inv_dir();
+			uint32_t stack[stack_size];
+			size_t sp = 0;
+			stack[sp++] = 0;
+			while (sp) {
+				const node& nd = (*this)[stack[--sp]];
+				float tn = t;
+				if (!r.intersects(nd.box, inv, tn)) continue;
+				if (nd.count) {
+					for (uint32_t k = 0; k < nd.count; ++k) {
+						float h = t;
+						if (prim(order[nd.index + k], r, h)) return true;
+					}
+				}
+				else {
+					stack[sp++] = nd.index + 1;
+					stack[sp++] = nd.index;
+				}
+			}
+			return false;
+		}
+
+		// packet forms, the rays go down together while any lane enters a node. prim(i, r, t) returns the lanes that
+		// hit primitive i with t lowered in those
+		template<size_t N, typename F> inline mask_xn<N> intersect(const ray_xn<N>& r, float_xn<N>& t, const F& prim) const {
+			typedef typename simd::reg<N>::type V;
+			mask_xn<N> hit{ simd::broadcast<V>(0) };
+			if (empty()) return hit;
+			const vec3f_xn<N> inv = r.inv_dir();
+			V n0, n1;
+			if (!simd::movemask(box(r, inv, (*this)[0], t.v, n0))) return hit;
+			struct entry { uint32_t i; float near; } stack[stack_size];
+			size_t sp = 0;
+			uint32_t i = 0;
+			for (;;) {
+				const node& nd = (*this)[i];
+				if (nd.count) {
+					for (uint32_t k = 0; k < nd.count; ++k) hit = hit | prim(order[nd.index + k], r, t);
+				}
+				else {
+					const node* c = &(*this)[nd.index];
+					const V m0 = box(r, inv, c[0], t.v, n0), m1 = box(r, inv, c[1], t.v, n1);
+					const int b0 = simd::movemask(m0), b1 = simd::movemask(m1);
+					if (b0 && b1) {
+						// nearest first by the earliest entry over the lanes that enter
+						const V far = simd::broadcast<V>(INFINITY);
+						const float d0 = simd::hmin(simd::select(m0, n0, far)), d1 = simd::hmin(simd::select(m1, n1, far));
+						const bool f = d1 < d0;
+						stack[sp++] = { nd.index + !f, f ? d0 : d1 };
+						i = nd.index + f;
+						continue;
+					}
+					if (b0 || b1) {
+						i = nd.index + (b0 == 0);
+						continue;
+					}
+				}
+				for (;;) {
+					if (!sp) return hit;
+					const entry& e = stack[--sp];
+					if (e.near <= t.hmax()) { i = e.i; break; }
+				}
+			}
+		}
+		// lanes with any hit within t, each lane stops taking part once it has one
+		template<size_t N, typename F> inline mask_xn<N> occluded(const ray_xn<N>& r, const float_xn<N>& t, const F& prim) const {
+			typedef typename simd::reg<N>::type V;
+			mask_xn<N> hit{ simd::broadcast<V>(0) };
+			if (empty()) return hit;
+			const vec3f_xn<N> inv = r.inv_dir();
+			mask_xn<N> active = ~hit;
+			uint32_t stack[stack_size];
+			size_t sp = 0;
+			stack[sp++] = 0;
+			while (sp) {
+				const node& nd = (*this)[stack[--sp]];
+				V near;
+				if (!(active & mask_xn<N>{ box(r, inv, nd, t.v, near) }).any()) continue;
+				if (nd.count) {
+					for (uint32_t k = 0; k < nd.count; ++k) {
+						float_xn<N> h = t;
+						hit = hit | (active & prim(order[nd.index + k], r, h));
+						active = ~hit;
+						if (active.none()) return hit;
+					}
+				}
+				else {
+					stack[sp++] = nd.index + 1;
+					stack[sp++] = nd.index;
+				}
+			}
+			return hit;
+		}
+
+	private:
+		template<size_t N, typename V> inline static V box(const ray_xn<N>& r, const vec3f_xn<N>& inv, const node& nd, const V& t, V& near) {
+			return simd::ray_box(r.origin.x, r.origin.y, r.origin.z, inv.x, inv.y, inv.z, &nd.box.min.x, &nd.box.max.x, t, near);
+		}
+		inline static float area(const aabb& b) {
+			const float x = b.max.x - b.min.x, y = b.max.y - b.min.y, z = b.max.z - b.min.z;
+			return x * y + y * z + z * x;
+		}
+
+		struct builder {
+			const aabb* bounds;
+			std::vector<vec3f> centers;
+			bvh& tree;
+			job_pool* pool;
+			size_t leaf_size;
+			std::atomic<uint32_t> next{ 2 };
+
+			inline node& at(const uint32_t& i) { return tree.nodes[i >> 1].child[i & 1]; }
+			// aabb::expand without the fminf and fmaxf calls, the inputs are finite
+			inline static void grow(aabb& b, const vec3f& lo, const vec3f& hi) {
+				b.min.x = lo.x < b.min.x ? lo.x : b.min.x; b.min.y = lo.y < b.min.y ? lo.y : b.min.y; b.min.z = lo.z < b.min.z ? lo.z : b.min.z;
+				b.max.x = hi.x > b.max.x ? hi.x : b.max.x; b.max.y = hi.y > b.max.y ? hi.y : b.max.y; b.max.z = hi.z > b.max.z ? hi.z : b.max.z;
+			}
+			inline size_t bin(const float& c, const float& lo, const float& scale) const {
+				const size_t b = (size_t)((c - lo) * scale);
+				return b < bins ? b : bins - 1;
+			}
+			// node i over order[b, e)
+			inline void split(const uint32_t& i, const uint32_t& b, const uint32_t& e, const size_t& depth) {
+				uint32_t* o = tree.order.data();
+				aabb box = aabb::empty(), cb = aabb::empty();
+				for (uint32_t k = b; k < e; ++k) {
+					grow(box, bounds[o[k]].min, bounds[o[k]].max);
+					grow(cb, centers[o[k]], centers[o[k]]);
+				}
+				node& nd = at(i);
+				nd.box = box;
+				const uint32_t count = e - b;
+				if (count == 1) {
+					nd.index = b;
+					nd.count = 1;
+					return;
+				}
+
+				// cheapest plane between bins over the three axes, costs in units of a primitive test times area
+				size_t axis = 3, plane = 0;
+				float best = INFINITY;
+				for (size_t a = 0; a < 3 && depth < max_depth; ++a) {
+					const float extent = cb.max[a] - cb.min[a];
+					if (!(extent > 0)) continue;
+					const float scale = bins / extent;
+					aabb bb[bins];
+					uint32_t bc[bins] = {};
+					for (size_t j = 0; j < bins; ++j) bb[j] = aabb::empty();
+					for (uint32_t k = b; k < e; ++k) {
+						const size_t j = bin(centers[o[k]][a], cb.min[a], scale);
+						grow(bb[j], bounds[o[k]].min, bounds[o[k]].max);
+						++bc[j];
+					}
+					float right[bins];
+					aabb acc = aabb::empty();
+					uint32_t n = 0;
+					for (size_t j = bins - 1; j > 0; --j) {
+						grow(acc, bb[j].min, bb[j].max);
+						n += bc[j];
+						right[j] = n ? area(acc) * n : INFINITY;
+					}
+					acc = aabb::empty();
+					n = 0;
+					for (size_t j = 0; j + 1 < bins; ++j) {
+						grow(acc, bb[j].min, bb[j].max);
+						n += bc[j];
+						const float cost = n ? area(acc) * n + right[j + 1] : INFINITY;
+						if (cost < best) { best = cost; axis = a; plane = j; }
+					}
+				}
+
+				uint32_t mid;
+				if (axis < 3) {
+					if (count <= leaf_size && count * area(box) <= area(box) + best) {
+						nd.index = b;
+						nd.count = count;
+						return;
+					}
+					const float lo = cb.min[axis], scale = bins / (cb.max[axis] - lo);
+					mid = (uint32_t)(std::partition(o + b, o + e, [&](const uint32_t& p) { return bin(centers[p][axis], lo, scale) <= plane; }) - o);
+				}
+				else {
+					// coincident centers or too deep, halves by the longest center extent
+					if (count <= leaf_size) {
+						nd.index = b;
+						nd.count = count;
+						return;
+					}
+					const vec3f d{ cb.max.x - cb.min.x, cb.max.y - cb.min.y, cb.max.z - cb.min.z };
+					const size_t a = d.x >= d.y && d.x >= d.z ? 0 : d.y >= d.z ? 1 : 2;
+					mid = b + count / 2;
+					std::nth_element(o + b, o + mid, o + e, [&](const uint32_t& p, const uint32_t& q) { return centers[p][a] < centers[q][a]; });
+				}
+
+				const uint32_t c = next.fetch_add(2, std::memory_order_relaxed);
+				nd.index = c;
+				nd.count = 0;
+				if (pool && count >= 4096) {
+					pool->parallel_for(2, 1, [&](const size_t& s, const size_t& f) {
+						for (size_t k = s; k < f; ++k) {
+							if (k) split(c + 1, mid, e, depth + 1);
+							else split(c, b, mid, depth + 1);
+						}
+					});
+				}
+				else {
+					split(c, b, mid, depth + 1);
+					split(c + 1, mid, e, depth + 1);
+				}
+			}
+		};
+	};
+
+	// closest hit of a ray against triangles, t is the largest distance to accept on the way in. prim is the
+	// triangle index or bvh::none on a miss, u and v the barycentric weights of its second and third vertex
+	struct ray_hit {
+		float t, u, v;
+		uint32_t prim;
+	};
+
+	namespace detail {
+		inline bool ray_triangle(const vec3f* vertices, const uint32_t* indices, const uint32_t& i, const ray& r, float& t, float& u, float& v) {
+			const uint32_t* x = indices + 3 * i;
+			return r.intersects(vertices[x[0]], vertices[x[1]], vertices[x[2]], t, u, v);
+		}
+		template<size_t N> inline mask_xn<N> ray_triangle(const vec3f* vertices, const uint32_t* indices, const uint32_t& i, const ray_xn<N>& r,
+			float_xn<N>& t, float_xn<N>& u, float_xn<N>& v) {
+			const uint32_t* x = indices + 3 * i;
+			return r.intersects(vertices[x[0]], vertices[x[1]], vertices[x[2]], t, u, v);
+		}
+	}
+
+	// closest hits of n rays against the triangles tree was built over, 3 indices each. Packets of simd::lanes
+	// rays traverse together, runs of grain rays go to pool
+	inline void raycast_n(const bvh& tree, const vec3f* vertices, const uint32_t* indices, const ray* rays, ray_hit* hits, const size_t& n,
+		job_pool* pool = nullptr, const size_t& grain = 256) {
+		const auto run = [&](const size_t& b, const size_t& e) {
+			size_t i = b;
+#if PXL_SIMD
+			typedef simd::fw V;
+			constexpr size_t L = simd::lanes;
+			for (; i + L <= e; i += L) {
+				const ray_xn<L> r = ray_xn<L>::load(rays + i);
+				float_xn<L> t, u, v, p;
+				simd::load4((const float*)(hits + i), 4, t.v, u.v, v.v, p.v);
+				u.v = v.v = simd::broadcast<V>(0);
+				p.v = simd::broadcast<V>(mathf::bit_cast<float>(bvh::none));
+				tree.intersect(r, t, [&](const uint32_t& k, const ray_xn<L>& q, float_xn<L>& h) {
+					const mask_xn<L> m = detail::ray_triangle(vertices, indices, k, q, h, u, v);
+					p.v = simd::select(m.m, simd::broadcast<V>(mathf::bit_cast<float>(k)), p.v);
+					return m;
+				});
+				simd::store4((float*)(hits + i), 4, t.v, u.v, v.v, p.v);
+			}
+#endif
+			for (; i < e; ++i) {
+				ray_hit& h = hits[i];
+				h.u = h.v = 0;
+				h.prim = bvh::none;
+				tree.intersect(rays[i], h.t, [&](const uint32_t& k, const ray& q, float& t) {
+					if (!detail::ray_triangle(vertices, indices, k, q, t, h.u, h.v)) return false;
+					h.prim = k;
+					return true;
+				});
+			}
+		};
+		if (pool) pool->parallel_for(n, grain, run);
+		else if (n) run(0, n);
+	}
+
+	// occlusion of n rays within tmax as bits of (n + 31) / 32 mask words like cull_n, bit i % 32 of mask[i / 32]
+	// set when ray i hits a triangle, for shadow and visibility rays. grain is rounded up to whole mask words so
+	// no two runs share one
+	inline void occluded_n(const bvh& tree, const vec3f* vertices, const uint32_t* indices, const ray* rays, const float* tmax, const size_t& n,
+		uint32_t* mask, job_pool* pool = nullptr, const size_t& grain = 256) {
+		memset(mask, 0, (n + 31) / 32 * sizeof(uint32_t));
+		const auto run = [&](const size_t& b, const size_t& e) {
+			size_t i = b;
+#if PXL_SIMD
+			constexpr size_t L = simd::lanes;
+			for (; i + L <= e; i += L) {
+				const ray_xn<L> r = ray_xn<L>::load(rays + i);
+				const mask_xn<L> m = tree.occluded(r, float_xn<L>::load(tmax + i), [&](const uint32_t& k, const ray_xn<L>& q, float_xn<L>& h) {
+					float_xn<L> u, v;
+					return detail::ray_triangle(vertices, indices, k, q, h, u, v);
+				});
+				mask[i >> 5] |= (uint32_t)m.bits() << (i & 31);
+			}
+#endif
+			for (; i < e; ++i) {
+				const bool hit = tree.occluded(rays[i], tmax[i], [&](const uint32_t& k, const ray& q, float& t) {
+					float u, v;
+					return detail::ray_triangle(vertices, indices, k, q, t, u, v);
+				});
+				mask[i >> 5] |= (uint32_t)hit << (i & 31);
+			}
+		};
+		if (pool) pool->parallel_for(n, ((grain ? grain : 1) + 31) & ~size_t(31), run);
+		else if (n) run(0, n);
+	}
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "pxlmath.h"
+#include <type_traits>
+
+namespace pxl {
+	// opt-in expression templates for vec2f, vec3f, vec4f and mat4f. lazy(a) * s + lazy(b) * t - c builds the chain
+	// as one expression instead of a temporary per operator; converting it to the result type evaluates it in a
+	// single pass, with every product that feeds an add or a subtract fused through madd / nmadd. vec4f and mat4f
+	// go four components at a time through simd::f4, vec2f and vec3f one component at a time. Operands are wrapped
+	// as needed once one side is an expression, but a product of two plain vectors is evaluated before it gets
+	// there, so wrap the left operand of every product. Leaves point at their vectors: keep an expression only
+	// within the statement that builds it, never in an auto. mat4f expressions are elementwise blends, * takes a
+	// scalar there and mat4f::operator* stays the matrix product
+	namespace expr {
+		struct node {};
+		template<typename E> struct is_node : std::is_base_of<node, E> {};
+
+		template<size_t N> struct result;
+		template<> struct result<2> { typedef vec2f type; };
+		template<> struct result<3> { typedef vec3f type; };
+		template<> struct result<4> { typedef vec4f type; };
+		template<> struct result<16> { typedef mat4f type; };
+		inline float* data(vec2f& v) { return &v.x; }
+		inline float* data(vec3f& v) { return &v.x; }
+		inline float* data(vec4f& v) { return &v.x; }
+		inline float* data(mat4f& m) { return &m.m00; }
+		inline const float* data(const vec2f& v) { return &v.x; }
+		inline const float* data(const vec3f& v) { return &v.x; }
+		inline const float* data(const vec4f& v) { return &v.x; }
+		inline const float* data(const mat4f& m) { return &m.m00; }
+
+		// E::size floats, four at a time when the size allows it and there are simd lanes. Also found unqualified
+		// through the expression, auto r = eval(lazy(a) * s + b) where no conversion is implied
+		template<typename E, size_t... I> inline void eval(const E& e, float* o, std::index_sequence<I...>) { ((o[I] = e.at(I)), ...); }
+		template<typename E> inline typename result<E::size>::type eval(const E& e) {
+			typename result<E::size>::type r;
+			float* o = data(r);
+#if PXL_SIMD
+			if constexpr (E::size % 4 == 0) {
+				for (size_t i = 0; i < E::size; i += 4) simd::store(o + i, e.at4(i));
+				return r;
+			}
+#endif
+			eval(e, o, std::make_index_sequence<E::size>());
+			return r;
+		}
+
+		// converts to the result type, evaluating the expression
+		template<typename E, size_t N> struct base : node {
+			static constexpr size_t size = N;
+			inline operator typename result<N>::type() const { return eval(static_cast<const E&>(*this)); }
+		};
+
+		template<size_t N> struct leaf : base<leaf<N>, N> {
+			const float* p;
+			inline explicit leaf(const float* p) : p(p) {}
+			inline float at(const size_t& i) const { return p[i]; }
+			inline simd::f4 at4(const size_t& i) const { return simd::load(p + i); }
+		};
+		template<size_t N> struct scalar : base<scalar<N>, N> {
+			float s;
+			inline explicit scalar(const float& s) : s(s) {}
+			inline float at(const size_t&) const { return s; }
+			inline simd::f4 at4(const size_t&) const { return simd::set1(s); }
+		};
+		template<typename E> struct neg : base<neg<E>, E::size> {
+			E e;
+			inline explicit neg(const E& e) : e(e) {}
+			inline float at(const size_t& i) const { return -e.at(i); }
+			inline simd::f4 at4(const size_t& i) const { return simd::bxor(e.at4(i), simd::set1(-0.0f)); }
+		};
+		template<typename L, typename R> struct mul : base<mul<L, R>, L::size> {
+			L l;
+			R r;
+			inline mul(const L& l, const R& r) : l(l), r(r) {}
+			inline float at(const size_t& i) const { return l.at(i) * r.at(i); }
+			inline simd::f4 at4(const size_t& i) const { return simd::mul(l.at4(i), r.at4(i)); }
+		};
+		template<typename L, typename R> struct div : base<div<L, R>, L::size> {
+			L l;
+			R r;
+			inline div(const L& l, const R& r) : l(l), r(r) {}
+			inline float at(const size_t& i) const { return l.at(i) / r.at(i); }
+			inline simd::f4 at4(const size_t& i) const { return simd::div(l.at4(i), r.at4(i)); }
+		};
+		template<typename E> struct is_mul : std::false_type {};
+		template<typename L, typename R> struct is_mul<mul<L, R>> : std::true_type {};
+
+		// a product on either side becomes the multiply of a madd
+		template<typename L, typename R> struct add : base<add<L, R>, L::size> {
+			L l;
+			R r;
+			inline add(const L& l, const R& r) : l(l), r(r) {}
+			inline float at(const size_t& i) const {
+				if constexpr (is_mul<L>::value) return mathf::madd(l.l.at(i), l.r.at(i), r.at(i));
+				else if constexpr (is_mul<R>::value) return mathf::madd(r.l.at(i), r.r.at(i), l.at(i));
+				else return l.at(i) + r.at(i);
+			}
+			inline simd::f4 at4(const size_t& i) const {
+				if constexpr (is_mul<L>::value) return simd::madd(l.l.at4(i), l.r.at4(i), r.at4(i));
+				else if constexpr (is_mul<R>::value) return simd::madd(r.l.at4(i), r.r.at4(i), l.at4(i));
+				else return simd::add(l.at4(i), r.at4(i));
+			}
+		};
+		// c - a * b is nmadd, a * b - c a madd of -c
+		template<typename L, typename R> struct sub : base<sub<L, R>, L::size> {
+			L l;
+			R r;
+			inline sub(const L& l, const R& r) : l(l), r(r) {}
+			inline float at(const size_t& i) const {
+				if constexpr (is_mul<R>::value) return mathf::madd(-r.l.at(i), r.r.at(i), l.at(i));
+				else if constexpr (is_mul<L>::value) return mathf::madd(l.l.at(i), l.r.at(i), -r.at(i));
+				else return l.at(i) - r.at(i);
+			}
+			inline simd::f4 at4(const size_t& i) const {
+				if constexpr (is_mul<R>::value) return simd::nmadd(r.l.at4(i), r.r.at4(i), l.at4(i));
+				else if constexpr (is_mul<L>::value) return simd::madd(l.l.at4(i), l.r.at4(i), simd::bxor(r.at4(i), simd::set1(-0.0f)));
+				else return simd::sub(l.at4(i), r.at4(i));
+			}
+		};
+
+		// what an operand becomes next to an expression of size N: itself, a leaf or a broadcast scalar
+		template<typename T, size_t N, typename = void> struct operand;
+		template<typename T, size_t N> struct operand<T, N, typename std::enable_if<is_node<T>::value>::type> {
+			typedef T type;
+			inline static const T& make(const T& e) { return e; }
+		};
+		template<typename T, size_t N> struct operand<T, N, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+			typedef scalar<N> type;
+			inline static type make(const T& s) { return type(float(s)); }
+		};
+		template<size_t N> struct operand<vec2f, N> { typedef leaf<2> type; inline static type make(const vec2f& v) { return type(data(v)); } };
+		template<size_t N> struct operand<vec3f, N> { typedef leaf<3> type; inline static type make(const vec3f& v) { return type(data(v)); } };
+		template<size_t N> struct operand<vec4f, N> { typedef leaf<4> type; inline static type make(const vec4f& v) { return type(data(v)); } };
+		template<size_t N> struct operand<mat4f, N> { typedef leaf<16> type; inline static type make(const mat4f& m) { return type(data(m)); } };
+
+		// the size an expression of l and r has, when at least one of them is an expression
+		template<typename L, typename R, typename = void> struct shape {};
+		template<typename L, typename R> struct shape<L, R, typename std::enable_if<is_node<L>::value>::type> { static constexpr size_t size = L::size; };
+		template<typename L, typename R> struct shape<L, R, typename std::enable_if<!is_node<L>::value && is_node<R>::value>::type> { static constexpr size_t size = R::size; };
+
+		template<template<typename, typename> class Op, typename L, typename R> struct binary {
+			static constexpr size_t size = shape<L, R>::size;
+			typedef typename operand<L, size>::type left;
+			typedef typename operand<R, size>::type right;
+			typedef Op<left, right> type;
+			static_assert(left::size == right::size, "operands of different sizes");
+			inline static type make(const L& l, const R& r) { return type(operand<L, size>::make(l), operand<R, size>::make(r)); }
+		};
+
+		template<typename L, typename R> using either = typename std::enable_if<is_node<L>::value || is_node<R>::value>::type;
+		template<typename L, typename R, typename = either<L, R>> inline typename binary<add, L, R>::type operator+(const L& l, const R& r) { return binary<add, L, R>::make(l, r); }
+		template<typename L, typename R, typename = either<L, R>> inline typename binary<sub, L, R>::type operator-(const L& l, const R& r) { return binary<sub, L, R>::make(l, r); }
+		template<typename L, typename R, typename = either<L, R>> inline typename binary<mul, L, R>::type operator*(const L& l, const R& r) {
+			static_assert(shape<L, R>::size != 16 || std::is_arithmetic<L>::value || std::is_arithmetic<R>::value, "mat4f expressions scale by scalars");
+			return binary<mul, L, R>::make(l, r);
+		}
+		template<typename L, typename R, typename = either<L, R>> inline typename binary<div, L, R>::type operator/(const L& l, const R& r) {
+			static_assert(shape<L, R>::size != 16 || std::is_arithmetic<R>::value, "mat4f expressions scale by scalars");
+			return binary<div, L, R>::make(l, r);
+		}
+		template<typename E, typename = typename std::enable_if<is_node<E>::value>::type> inline neg<E> operator-(const E& e) { return neg<E>(e); }
+
+		// x += lazy(v) * dt and the like, evaluated into a temporary first so the expression may read x
+		template<typename T, typename E, typename = typename std::enable_if<is_node<E>::value && std::is_same<T, typename result<E::size>::type>::value>::type>
+		inline T& operator+=(T& a, const E& e) { return a = eval(a + e); }
+		template<typename T, typename E, typename = typename std::enable_if<is_node<E>::value && std::is_same<T, typename result<E::size>::type>::value>::type>
+		inline T& operator-=(T& a, const E& e) { return a = eval(a - e); }
+	}
+
+	// starts an expression, see pxl::expr
+	inline expr::leaf<2> lazy(const vec2f& v) { return expr::leaf<2>(&v.x); }
+	inline expr::leaf<3> lazy(const vec3f& v) { return expr::leaf<3>(&v.x); }
+	inline expr::leaf<4> lazy(const vec4f& v) { return expr::leaf<4>(&v.x); }
+	inline expr::leaf<16> lazy(const mat4f& m) { return expr::leaf<16>(&m.m00); }
+}
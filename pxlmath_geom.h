@@ -0,0 +1,296 @@
+#pragma once
+
+#include "pxlmath.h"
+#include "pxlmath_wide.h"
+#include <stdint.h>
+
+namespace pxl {
+	// points p with dot(n, p) + d >= 0 are on the inner side
+	struct plane {
+		vec3f n;
+		float d;
+		inline constexpr float distance(const vec3f& p) const { return n.x * p.x + n.y * p.y + n.z * p.z + d; }
+		inline constexpr plane& normalize() {
+			const float mag = n.magnitude();
+			if (mag > 0) { const float r = 1 / mag; n.x *= r; n.y *= r; n.z *= r; d *= r; }
+			return *this;
+		}
+		inline constexpr plane normalized() const { plane p = *this; return p.normalize(); }
+
+		inline static constexpr plane from_point(const vec3f& n /* unit */, const vec3f& p) { return { n, -vec3f::dot(n, p) }; }
+	};
+
+	struct aabb {
+		vec3f min, max;
+		inline constexpr vec3f center() const { return { (min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f }; }
+		inline constexpr vec3f extents() const { return { (max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f }; }
+		inline constexpr bool contains(const vec3f& p) const {
+			return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z;
+		}
+		inline constexpr bool intersects(const aabb& o) const {
+			return min.x <= o.max.x && max.x >= o.min.x && min.y <= o.max.y && max.y >= o.min.y && min.z <= o.max.z && max.z >= o.min.z;
+		}
+		inline constexpr aabb& expand(const vec3f& p) {
+			min.x = mathf::min(min.x, p.x); min.y = mathf::min(min.y, p.y); min.z = mathf::min(min.z, p.z);
+			max.x = mathf::max(max.x, p.x); max.y = mathf::max(max.y, p.y); max.z = mathf::max(max.z, p.z);
+			return *this;
+		}
+		inline constexpr aabb& expand(const aabb& o) { expand(o.min); return expand(o.max); }
+		// bounds of the box under an affine m, from the transformed center and |m| * extents
+		inline constexpr aabb transformed(const mat4f& m) const {
+			const vec3f c = m.transform_point(center()), e = extents();
+			const vec3f r{
+				mathf::abs(m.m00) * e.x + mathf::abs(m.m01) * e.y + mathf::abs(m.m02) * e.z,
+				mathf::abs(m.m10) * e.x + mathf::abs(m.m11) * e.y + mathf::abs(m.m12) * e.z,
+				mathf::abs(m.m20) * e.x + mathf::abs(m.m21) * e.y + mathf::abs(m.m22) * e.z };
+			return { { c.x - r.x, c.y - r.y, c.z - r.z }, { c.x + r.x, c.y + r.y, c.z + r.z } };
+		}
+
+		// min = +inf and max = -inf, expand from here
+		inline static constexpr aabb empty() { return { { INFINITY, INFINITY, INFINITY }, { -INFINITY, -INFINITY, -INFINITY } }; }
+	};
+
+	struct sphere {
+		vec3f center;
+		float radius;
+		inline constexpr bool contains(const vec3f& p) const {
+			const float x = p.x - center.x, y = p.y - center.y, z = p.z - center.z;
+			return x * x + y * y + z * z <= radius * radius;
+		}
+		inline constexpr bool intersects(const sphere& o) const {
+			const float x = o.center.x - center.x, y = o.center.y - center.y, z = o.center.z - center.z, r = radius + o.radius;
+			return x * x + y * y + z * z <= r * r;
+		}
+	};
+
+	// origin + dir * t for t >= 0, dir need not be unit length (t is then in units of |dir|, from_points gives t in
+	// [0, 1] along the segment). The tests take t as the largest distance to accept and lower it to the hit distance
+	// when they return true
+	struct ray {
+		vec3f origin, dir;
+		inline constexpr vec3f at(const float& t) const { return { origin.x + dir.x * t, origin.y + dir.y * t, origin.z + dir.z * t }; }
+		// 1 / dir with components below 1e-20 pushed away from zero, the slab products then never meet 0 * inf
+		inline constexpr vec3f inv_dir() const { return { rcp(dir.x), rcp(dir.y), rcp(dir.z) }; }
+		// slab test, the entry distance or 0 from inside the box
+		inline constexpr bool intersects(const aabb& b, float& t) const { return intersects(b, inv_dir(), t); }
+		inline constexpr bool intersects(const aabb& b, const vec3f& inv, float& t) const {
+			float tn = 0, tf = t;
+			for (size_t i = 0; i < 3; ++i) {
+				// compares, fminf and fmaxf are calls outside constant evaluation; a nan t0 or t1 is skipped
+				const float t0 = (b.min[i] - origin[i]) * inv[i], t1 = (b.max[i] - origin[i]) * inv[i];
+				const float lo = t0 < t1 ? t0 : t1, hi = t0 < t1 ? t1 : t0;
+				tn = lo > tn ? lo : tn;
+				tf = hi < tf ? hi : tf;
+			}
+			if (tn > tf) return false;
+			t = tn;
+			return true;
+		}
+		// the nearest crossing of the surface, the far one from inside the sphere
+		inline constexpr bool intersects(const sphere& s, float& t) const {
+			const vec3f oc{ origin.x - s.center.x, origin.y - s.center.y, origin.z - s.center.z };
+			const float a = vec3f::dot(dir, dir), b = vec3f::dot(oc, dir), c = vec3f::dot(oc, oc) - s.radius * s.radius, disc = b * b - a * c;
+			if (disc < 0) return false;
+			const float q = mathf::sqrt(disc), t0 = (-b - q) / a, h = t0 < 0 ? (-b + q) / a : t0;
+			if (!(h >= 0 && h <= t)) return false;
+			t = h;
+			return true;
+		}
+		// moller-trumbore against triangle a b c from either side, u and v the barycentric weights of b and c.
+		// Edge-on and degenerate triangles miss
+		inline constexpr bool intersects(const vec3f& a, const vec3f& b, const vec3f& c, float& t, float& u, float& v) const {
+			const vec3f e1{ b.x - a.x, b.y - a.y, b.z - a.z }, e2{ c.x - a.x, c.y - a.y, c.z - a.z }, p{ vec3f::cross(dir, e2) };
+			const float r = 1 / vec3f::dot(e1, p);
+			const vec3f s{ origin.x - a.x, origin.y - a.y, origin.z - a.z }, q{ vec3f::cross(s, e1) };
+			const float hu = vec3f::dot(s, p) * r, hv = vec3f::dot(dir, q) * r, h = vec3f::dot(e2, q) * r;
+			if (!(hu >= 0 && hv >= 0 && hu + hv <= 1 && h >= 0 && h <= t)) return false;
+			t = h; u = hu; v = hv;
+			return true;
+		}
+
+		inline static constexpr ray from_points(const vec3f& from, const vec3f& to) { return { from, { to.x - from.x, to.y - from.y, to.z - from.z } }; }
+		inline static constexpr float rcp(const float& d) {
+			return 1 / (mathf::abs(d) >= 1e-20f ? d : mathf::bit_cast<uint32_t>(d) >> 31 ? -1e-20f : 1e-20f);
+		}
+	};
+
+	// left, right, bottom, top, near, far with normals pointing inwards
+	struct frustum {
+		plane planes[6];
+		inline constexpr bool contains(const vec3f& p) const {
+			for (int i = 0; i < 6; ++i) if (planes[i].distance(p) < 0) return false;
+			return true;
+		}
+		// conservative, boxes near an edge outside two planes can pass
+		inline constexpr bool intersects(const aabb& b) const {
+			for (int i = 0; i < 6; ++i) {
+				const vec3f& n = planes[i].n;
+				const vec3f p{ n.x >= 0 ? b.max.x : b.min.x, n.y >= 0 ? b.max.y : b.min.y, n.z >= 0 ? b.max.z : b.min.z };
+				if (planes[i].distance(p) < 0) return false;
+			}
+			return true;
+		}
+		inline constexpr bool intersects(const sphere& s) const {
+			for (int i = 0; i < 6; ++i) if (planes[i].distance(s.center) < -s.radius) return false;
+			return true;
+		}
+
+		// planes of clip = m * v with -w <= x, y, z <= w, as produced by mat4f::perspective/orthographic
+		// times a view matrix, normalized so distances are in world units
+		inline static constexpr frustum from_matrix(const mat4f& m) {
+			return { {
+				plane{ { m.m30 + m.m00, m.m31 + m.m01, m.m32 + m.m02 }, m.m33 + m.m03 }.normalize(),
+				plane{ { m.m30 - m.m00, m.m31 - m.m01, m.m32 - m.m02 }, m.m33 - m.m03 }.normalize(),
+				plane{ { m.m30 + m.m10, m.m31 + m.m11, m.m32 + m.m12 }, m.m33 + m.m13 }.normalize(),
+				plane{ { m.m30 - m.m10, m.m31 - m.m11, m.m32 - m.m12 }, m.m33 - m.m13 }.normalize(),
+				plane{ { m.m30 + m.m20, m.m31 + m.m21, m.m32 + m.m22 }, m.m33 + m.m23 }.normalize(),
+				plane{ { m.m30 - m.m20, m.m31 - m.m21, m.m32 - m.m22 }, m.m33 - m.m23 }.normalize() } };
+		}
+	};
+
+	namespace simd {
+		// per lane forms of the ray tests on rays in lanes against one shape, returning the lanes that hit with t (and
+		// u, v) updated in those. ray_rcp is ray::inv_dir, ray_box takes its result and leaves t alone
+		template<typename V> inline V ray_rcp(const V& d) {
+			const V tiny = broadcast<V>(1e-20f), abs = broadcast<V>(mathf::bit_cast<float>(0x7fffffffu));
+			return div(broadcast<V>(1), select(cmplt(band(d, abs), tiny), bor(tiny, band(d, broadcast<V>(-0.0f))), d));
+		}
+		// the operand order keeps a nan from a degenerate slab out of near and far on sse, where min and max return the second
+		template<typename V> inline V ray_box(const V& ox, const V& oy, const V& oz, const V& ix, const V& iy, const V& iz,
+			const float* bmin, const float* bmax, const V& t, V& near) {
+			V t0 = mul(sub(broadcast<V>(bmin[0]), ox), ix), t1 = mul(sub(broadcast<V>(bmax[0]), ox), ix);
+			V tn = max(min(t0, t1), broadcast<V>(0)), tf = min(max(t0, t1), t);
+			t0 = mul(sub(broadcast<V>(bmin[1]), oy), iy); t1 = mul(sub(broadcast<V>(bmax[1]), oy), iy);
+			tn = max(min(t0, t1), tn); tf = min(max(t0, t1), tf);
+			t0 = mul(sub(broadcast<V>(bmin[2]), oz), iz); t1 = mul(sub(broadcast<V>(bmax[2]), oz), iz);
+			tn = max(min(t0, t1), tn); tf = min(max(t0, t1), tf);
+			near = tn;
+			return cmple(tn, tf);
+		}
+		template<typename V> inline V ray_sphere(const V& ox, const V& oy, const V& oz, const V& dx, const V& dy, const V& dz, const sphere& s, V& t) {
+			const V zero = broadcast<V>(0);
+			const V cx = sub(ox, broadcast<V>(s.center.x)), cy = sub(oy, broadcast<V>(s.center.y)), cz = sub(oz, broadcast<V>(s.center.z));
+			const V a = add(add(mul(dx, dx), mul(dy, dy)), mul(dz, dz)), b = add(add(mul(cx, dx), mul(cy, dy)), mul(cz, dz));
+			const V c = sub(add(add(mul(cx, cx), mul(cy, cy)), mul(cz, cz)), broadcast<V>(s.radius * s.radius)), disc = sub(mul(b, b), mul(a, c));
+			const V q = sqrt(max(disc, zero)), t0 = div(sub(sub(zero, b), q), a), h = select(cmplt(t0, zero), div(sub(q, b), a), t0);
+			const V hit = band(band(cmple(zero, disc), cmple(zero, h)), cmple(h, t));
+			t = select(hit, h, t);
+			return hit;
+		}
+		// triangle as a and the edges e1 = b - a, e2 = c - a
+		template<typename V> inline V ray_triangle(const V& ox, const V& oy, const V& oz, const V& dx, const V& dy, const V& dz,
+			const vec3f& a, const vec3f& e1, const vec3f& e2, V& t, V& u, V& v) {
+			const V zero = broadcast<V>(0), one = broadcast<V>(1);
+			const V ax = broadcast<V>(e1.x), ay = broadcast<V>(e1.y), az = broadcast<V>(e1.z), bx = broadcast<V>(e2.x), by = broadcast<V>(e2.y), bz = broadcast<V>(e2.z);
+			const V px = sub(mul(dy, bz), mul(dz, by)), py = sub(mul(dz, bx), mul(dx, bz)), pz = sub(mul(dx, by), mul(dy, bx));
+			const V r = div(one, add(add(mul(ax, px), mul(ay, py)), mul(az, pz)));
+			const V sx = sub(ox, broadcast<V>(a.x)), sy = sub(oy, broadcast<V>(a.y)), sz = sub(oz, broadcast<V>(a.z));
+			const V qx = sub(mul(sy, az), mul(sz, ay)), qy = sub(mul(sz, ax), mul(sx, az)), qz = sub(mul(sx, ay), mul(sy, ax));
+			const V hu = mul(add(add(mul(sx, px), mul(sy, py)), mul(sz, pz)), r), hv = mul(add(add(mul(dx, qx), mul(dy, qy)), mul(dz, qz)), r);
+			const V h = mul(add(add(mul(bx, qx), mul(by, qy)), mul(bz, qz)), r);
+			const V hit = band(band(band(cmple(zero, hu), cmple(zero, hv)), cmple(add(hu, hv), one)), band(cmple(zero, h), cmple(h, t)));
+			t = select(hit, h, t); u = select(hit, hu, u); v = select(hit, hv, v);
+			return hit;
+		}
+
+		// boxes or spheres against the frustum planes over the leading whole blocks of V, bit i of mask set when
+		// element i passes frustum::intersects, mask words must start zeroed, returns the count done
+		template<typename V> inline size_t frustum_cull(const frustum& f, const aabb* b, const size_t& n, uint32_t* mask) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			V nx[6], ny[6], nz[6], d[6];
+			bool px[6], py[6], pz[6];
+			for (int k = 0; k < 6; ++k) {
+				const plane& p = f.planes[k];
+				nx[k] = broadcast<V>(p.n.x); ny[k] = broadcast<V>(p.n.y); nz[k] = broadcast<V>(p.n.z); d[k] = broadcast<V>(p.d);
+				px[k] = p.n.x >= 0; py[k] = p.n.y >= 0; pz[k] = p.n.z >= 0;
+			}
+			const V zero = broadcast<V>(0);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				// { minx miny minz maxx } and { minz maxx maxy maxz } of each box, 6 floats apart
+				V x0, y0, z0, x1, y1, z1, t0, t1;
+				load4((const float*)(b + i), 6, x0, y0, z0, x1);
+				load4((const float*)(b + i) + 2, 6, t0, t1, y1, z1);
+				V out = cmplt(add(add(add(mul(nx[0], px[0] ? x1 : x0), mul(ny[0], py[0] ? y1 : y0)), mul(nz[0], pz[0] ? z1 : z0)), d[0]), zero);
+				for (int k = 1; k < 6; ++k)
+					out = bor(out, cmplt(add(add(add(mul(nx[k], px[k] ? x1 : x0), mul(ny[k], py[k] ? y1 : y0)), mul(nz[k], pz[k] ? z1 : z0)), d[k]), zero));
+				mask[i >> 5] |= uint32_t(~movemask(out) & ((1 << lanes) - 1)) << (i & 31);
+			}
+			return i;
+		}
+		template<typename V> inline size_t frustum_cull(const frustum& f, const sphere* s, const size_t& n, uint32_t* mask) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			V nx[6], ny[6], nz[6], d[6];
+			for (int k = 0; k < 6; ++k) {
+				const plane& p = f.planes[k];
+				nx[k] = broadcast<V>(p.n.x); ny[k] = broadcast<V>(p.n.y); nz[k] = broadcast<V>(p.n.z); d[k] = broadcast<V>(p.d);
+			}
+			const V zero = broadcast<V>(0);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V x, y, z, r;
+				load4((const float*)(s + i), x, y, z, r);
+				const V nr = sub(zero, r);
+				V out = cmplt(add(add(add(mul(nx[0], x), mul(ny[0], y)), mul(nz[0], z)), d[0]), nr);
+				for (int k = 1; k < 6; ++k)
+					out = bor(out, cmplt(add(add(add(mul(nx[k], x), mul(ny[k], y)), mul(nz[k], z)), d[k]), nr));
+				mask[i >> 5] |= uint32_t(~movemask(out) & ((1 << lanes) - 1)) << (i & 31);
+			}
+			return i;
+		}
+	}
+
+	// N rays in lanes with the ray tests per lane, t u and v as in ray, returning the lanes that hit
+	template<size_t N> struct ray_xn {
+		typedef typename simd::reg<N>::type V;
+		vec3f_xn<N> origin, dir;
+		static constexpr size_t lanes = N;
+		inline vec3f_xn<N> inv_dir() const { return { simd::ray_rcp(dir.x), simd::ray_rcp(dir.y), simd::ray_rcp(dir.z) }; }
+		inline mask_xn<N> intersects(const aabb& b, float_xn<N>& t) const { return intersects(b, inv_dir(), t); }
+		inline mask_xn<N> intersects(const aabb& b, const vec3f_xn<N>& inv, float_xn<N>& t) const {
+			V near;
+			const V hit = simd::ray_box(origin.x, origin.y, origin.z, inv.x, inv.y, inv.z, &b.min.x, &b.max.x, t.v, near);
+			t.v = simd::select(hit, near, t.v);
+			return { hit };
+		}
+		inline mask_xn<N> intersects(const sphere& s, float_xn<N>& t) const {
+			return { simd::ray_sphere(origin.x, origin.y, origin.z, dir.x, dir.y, dir.z, s, t.v) };
+		}
+		inline mask_xn<N> intersects(const vec3f& a, const vec3f& b, const vec3f& c, float_xn<N>& t, float_xn<N>& u, float_xn<N>& v) const {
+			return { simd::ray_triangle(origin.x, origin.y, origin.z, dir.x, dir.y, dir.z, a, b - a, c - a, t.v, u.v, v.v) };
+		}
+		inline ray operator[](const size_t& i) const { return { origin[i], dir[i] }; }
+
+		inline static ray_xn broadcast(const ray& r) { return { vec3f_xn<N>::broadcast(r.origin), vec3f_xn<N>::broadcast(r.dir) }; }
+		// reads lanes consecutive rays, as { ox oy oz dx } and { oz dx dy dz } 6 floats apart
+		inline static ray_xn load(const ray* p) {
+			ray_xn r;
+			V t0, t1;
+			simd::load4((const float*)p, 6, r.origin.x, r.origin.y, r.origin.z, r.dir.x);
+			simd::load4((const float*)p + 2, 6, t0, t1, r.dir.y, r.dir.z);
+			return r;
+		}
+	};
+	typedef ray_xn<4> ray_x4;
+	typedef ray_xn<8> ray_x8;
+
+	// visibility of n boxes or spheres as bits of (n + 31) / 32 mask words, bit i % 32 of mask[i / 32]
+	// set when element i is at least partly inside, unused high bits of the last word are cleared
+	// disjoint ranges starting at multiples of 32 can be culled on separate threads
+	inline void cull_n(const frustum& f, const aabb* b, const size_t& n, uint32_t* mask) {
+		memset(mask, 0, (n + 31) / 32 * sizeof(uint32_t));
+		size_t i = 0;
+#if PXL_SIMD
+		i += simd::frustum_cull<simd::fw>(f, b, n, mask);
+#endif
+		for (; i < n; ++i) if (f.intersects(b[i])) mask[i >> 5] |= 1u << (i & 31);
+	}
+	inline void cull_n(const frustum& f, const sphere* s, const size_t& n, uint32_t* mask) {
+		memset(mask, 0, (n + 31) / 32 * sizeof(uint32_t));
+		size_t i = 0;
+#if PXL_SIMD
+		i += simd::frustum_cull<simd::fw>(f, s, n, mask);
+#endif
+		for (; i < n; ++i) if (f.intersects(s[i])) mask[i >> 5] |= 1u << (i & 31);
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "pxlmath.h"
+#include "pxlmath_arena.h"
+
+namespace pxl {
+	// matrix layouts for gpu buffers, named by the mat4f members m<row><col>. std140 and std430 agree on all three:
+	// row_major is a mat4 declared layout(row_major) (hlsl row_major float4x4), column_major the default mat4 /
+	// float4x4, rows3x4 the top three rows in 48 bytes for affine palettes, read as a column-major mat3x4 applied as
+	// v * m in glsl or a row_major float3x4 applied as mul(m, v) in hlsl. The bottom row is dropped, not checked
+	enum class matrix_layout { row_major, column_major, rows3x4 };
+	inline constexpr size_t layout_bytes(const matrix_layout& l) { return l == matrix_layout::rows3x4 ? 48 : 64; }
+
+	namespace simd {
+		// n mat4f to dst, one every stride bytes, streamed when nt (dst and stride on 16 bytes)
+		template<matrix_layout L, bool nt> inline void mat4_write(const float* in, unsigned char* dst, const size_t& stride, const size_t& n) {
+			for (size_t i = 0; i < n; ++i, in += 16, dst += stride) {
+				f4 r0 = load(in), r1 = load(in + 4), r2 = load(in + 8), r3 = load(in + 12);
+				if (L == matrix_layout::column_major) transpose(r0, r1, r2, r3);
+				float* o = (float*)dst;
+				if (nt) { stream(o, r0); stream(o + 4, r1); stream(o + 8, r2); }
+				else { store(o, r0); store(o + 4, r1); store(o + 8, r2); }
+				if (L != matrix_layout::rows3x4) {
+					if (nt) stream(o + 12, r3);
+					else store(o + 12, r3);
+				}
+			}
+		}
+	}
+
+	// n matrices into a gpu buffer, typically persistently mapped upload memory, one every stride bytes (0 packs them
+	// at layout_bytes, a larger stride leaves the rest of each element alone). With dst and stride on 16 bytes the
+	// stores are non-temporal and fenced at the end, so a large palette neither reads the write-combined buffer nor
+	// evicts the cache, and no staging copy is needed. Disjoint ranges may be written from several threads.
+	inline void write_palette(const mat4f* in, void* dst, const size_t& n, const matrix_layout& l, size_t stride = 0) {
+		if (!n) return;
+		if (!stride) stride = layout_bytes(l);
+		unsigned char* d = (unsigned char*)dst;
+		if (((uintptr_t)d & 15) == 0 && (stride & 15) == 0) {
+			if (l == matrix_layout::row_major) simd::mat4_write<matrix_layout::row_major, true>(&in->m00, d, stride, n);
+			else if (l == matrix_layout::column_major) simd::mat4_write<matrix_layout::column_major, true>(&in->m00, d, stride, n);
+			else simd::mat4_write<matrix_layout::rows3x4, true>(&in->m00, d, stride, n);
+			simd::stream_fence();
+		}
+		else {
+			if (l == matrix_layout::row_major) simd::mat4_write<matrix_layout::row_major, false>(&in->m00, d, stride, n);
+			else if (l == matrix_layout::column_major) simd::mat4_write<matrix_layout::column_major, false>(&in->m00, d, stride, n);
+			else simd::mat4_write<matrix_layout::rows3x4, false>(&in->m00, d, stride, n);
+		}
+	}
+	inline void write_palette(const span<const mat4f>& in, void* dst, const matrix_layout& l, const size_t& stride = 0) {
+		write_palette(in.data(), dst, in.size(), l, stride);
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pxl {
+	// fixed set of worker threads with one deque each. Owners pop from the back, idle workers steal from the
+	// front of the others, and the thread calling parallel_for works through the queues until its range is done.
+	struct job_pool {
+		struct job {
+			void (*fn)(const void*, size_t, size_t);
+			const void* ctx;
+			size_t begin, end;
+			std::atomic<size_t>* pending;
+		};
+		struct queue {
+			std::mutex lock;
+			std::deque<job> jobs;
+		};
+
+		// threads = 0 runs everything on the calling thread
+		inline explicit job_pool(const size_t& threads = default_threads()) : queues(threads ? threads : 1) {
+			for (size_t i = 0; i < threads; ++i) workers.emplace_back([this, i] { run(i); });
+		}
+		inline ~job_pool() {
+			{
+				std::lock_guard<std::mutex> g(sleep_lock);
+				stop = true;
+			}
+			wake.notify_all();
+			for (std::thread& t : workers) t.join();
+		}
+		job_pool(const job_pool&) = delete;
+		job_pool& operator =(const job_pool&) = delete;
+
+		// worker threads plus the calling thread
+		inline size_t size() const { return workers.size() + 1; }
+
+		// f(begin, end) over [0, n) in chunks of at most grain, returns once every chunk has run
+		// chunks run concurrently and in no particular order, f may call parallel_for again
+		template<typename F> inline void parallel_for(const size_t& n, const size_t& grain, const F& f) {
+			const size_t g = grain ? grain : 1;
+			if (workers.empty() || n <= g) {
+				if (n) f(size_t(0), n);
+				return;
+			}
+			std::atomic<size_t> pending{ (n + g - 1) / g };
+			const size_t first = next.fetch_add(1, std::memory_order_relaxed);
+			{
+				// counted before the push so a fast taker never sees queued below zero
+				std::lock_guard<std::mutex> l(sleep_lock);
+				queued += pending.load(std::memory_order_relaxed);
+			}
+			for (size_t b = 0, k = 0; b < n; b += g, ++k) {
+				queue& q = queues[(first + k) % queues.size()];
+				std::lock_guard<std::mutex> l(q.lock);
+				q.jobs.push_back({ &call<F>, &f, b, b + g < n ? b + g : n, &pending });
+			}
+			wake.notify_all();
+			while (pending.load(std::memory_order_acquire)) {
+				job j;
+				if (take(first % queues.size(), j)) execute(j);
+				else std::this_thread::yield();
+			}
+		}
+
+		inline static size_t default_threads() {
+			const size_t c = std::thread::hardware_concurrency();
+			return c > 1 ? c - 1 : 0;
+		}
+
+	private:
+		std::vector<queue> queues;
+		std::vector<std::thread> workers;
+		std::mutex sleep_lock;
+		std::condition_variable wake;
+		size_t queued{ 0 };
+		bool stop{ false };
+		std::atomic<size_t> next{ 0 };
+
+		template<typename F> inline static void call(const void* f, size_t b, size_t e) { (*(const F*)f)(b, e); }
+		inline static void execute(const job& j) {
+			j.fn(j.ctx, j.begin, j.end);
+			j.pending->fetch_sub(1, std::memory_order_release);
+		}
+		// own queue from the back, then the others from the front
+		inline bool take(const size_t& self, job& j) {
+			const size_t c = queues.size();
+			for (size_t k = 0; k < c; ++k) {
+				queue& q = queues[(self + k) % c];
+				std::unique_lock<std::mutex> l(q.lock);
+				if (q.jobs.empty()) continue;
+				if (k) { j = q.jobs.front(); q.jobs.pop_front(); }
+				else { j = q.jobs.back(); q.jobs.pop_back(); }
+				l.unlock();
+				std::lock_guard<std::mutex> g(sleep_lock);
+				--queued;
+				return true;
+			}
+			return false;
+		}
+		inline void run(const size_t& self) {
+			for (;;) {
+				job j;
+				if (take(self, j)) { execute(j); continue; }
+				std::unique_lock<std::mutex> l(sleep_lock);
+				wake.wait(l, [this] { return stop || queued; });
+				if (stop) return;
+			}
+		}
+	};
+}
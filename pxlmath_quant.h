@@ -0,0 +1,485 @@
+#pragma once
+
+#include "pxlmath.h"
+#include <stdint.h>
+
+namespace pxl {
+	namespace detail {
+		// smallest three: the largest |component| is dropped and rebuilt from the unit length with its index in the
+		// top 2 bits. The other three, sign flipped so the dropped one is positive (q and -q are the same rotation),
+		// lie in [-1 / sqrt2, 1 / sqrt2] and are stored as B bit offsets from m = 2^(B - 1) - 1 so zero is exact.
+		template<int B> struct smallest3 {
+			static constexpr int bits = B;
+			static constexpr uint64_t mask = (uint64_t(1) << B) - 1;
+			static constexpr float m = float((1 << (B - 1)) - 1), k = m * 1.41421356f, rk = 1 / k;
+			inline static constexpr uint64_t quantize(const float& c) { return uint64_t(mathf::min(mathf::max(c * k, -m), m) + m + 0.5f); }
+			inline static constexpr float dequantize(const uint64_t& u) { return (float(u & mask) - m) * rk; }
+			inline static constexpr uint64_t encode(const quatf& q) {
+				const float c[4]{ q.x, q.y, q.z, q.w };
+				int i = 0;
+				for (int j = 1; j < 4; ++j) if (mathf::abs(c[j]) > mathf::abs(c[i])) i = j;
+				const float s = c[i] < 0 ? -1.0f : 1.0f;
+				uint64_t v = (uint64_t)i;
+				for (int j = 0; j < 4; ++j) if (j != i) v = v << B | quantize(c[j] * s);
+				return v;
+			}
+			inline static constexpr quatf decode(const uint64_t& v) {
+				const float a = dequantize(v >> 2 * B), b = dequantize(v >> B), c = dequantize(v);
+				const float d = mathf::sqrt(mathf::max(0.0f, 1 - (a * a + b * b + c * c)));
+				switch (v >> 3 * B & 3) {
+				case 0: return { d, a, b, c };
+				case 1: return { a, d, b, c };
+				case 2: return { a, b, d, c };
+				default: return { a, b, c, d };
+				}
+			}
+		};
+
+		// octahedral map of a unit vector to [-1, 1]^2: project onto |x| + |y| + |z| = 1 and fold the z < 0 half
+		// over the diagonals, coordinates stored as snorm with m steps either side of zero
+		template<int M> struct octahedral {
+			static constexpr float m = float(M), rm = 1 / m;
+			inline static constexpr int32_t quantize(const float& f) {
+				const float c = mathf::min(mathf::max(f, -1.0f), 1.0f);
+				return int32_t(c * m + (c < 0 ? -0.5f : 0.5f));
+			}
+			inline static constexpr vec2f encode(const vec3f& n) {
+				const float r = 1 / (mathf::abs(n.x) + mathf::abs(n.y) + mathf::abs(n.z)), px = n.x * r, py = n.y * r;
+				if (!(n.z < 0)) return { px, py };
+				const float fx = 1 - mathf::abs(py), fy = 1 - mathf::abs(px);
+				return { px < 0 ? -fx : fx, py < 0 ? -fy : fy };
+			}
+			inline static constexpr vec3f decode(const float& u, const float& v) {
+				float x = mathf::max(u * rm, -1.0f), y = mathf::max(v * rm, -1.0f);
+				const float z = 1 - mathf::abs(x) - mathf::abs(y), t = mathf::max(-z, 0.0f);
+				x += x < 0 ? t : -t;
+				y += y < 0 ? t : -t;
+				const float r = 1 / mathf::sqrt(x * x + y * y + z * z);
+				return { x * r, y * r, z * r };
+			}
+		};
+	}
+
+	// unit quaternions in 32, 48 and 64 bits by smallest three with 10, 15 and 20 bits per component. Each stored
+	// component is within 1 / (2 sqrt2 m) of the input: 6.9e-4, 2.2e-5 and 6.7e-7. The rebuilt largest one adds
+	// to that, the rotation comes back within 0.3, 0.01 and 0.0004 degrees (0.255, 0.0082 and 0.00027 measured).
+	// Decoding is unit length to the component error and may return -q for q.
+	struct quat32 {
+		uint32_t bits;
+		typedef detail::smallest3<10> codec;
+		quat32() = default;
+		inline constexpr quat32(const quatf& q) : bits(uint32_t(codec::encode(q))) {}
+		inline constexpr operator quatf() const { return codec::decode(bits); }
+		inline constexpr uint64_t value() const { return bits; }
+		inline static constexpr quat32 from_value(const uint64_t& v) { quat32 q{}; q.bits = uint32_t(v); return q; }
+	};
+	struct quat48 {
+		uint16_t bits[3];
+		typedef detail::smallest3<15> codec;
+		quat48() = default;
+		inline constexpr quat48(const quatf& q) : bits{} { *this = from_value(codec::encode(q)); }
+		inline constexpr operator quatf() const { return codec::decode(value()); }
+		inline constexpr uint64_t value() const { return bits[0] | uint64_t(bits[1]) << 16 | uint64_t(bits[2]) << 32; }
+		inline static constexpr quat48 from_value(const uint64_t& v) {
+			quat48 q{};
+			q.bits[0] = uint16_t(v); q.bits[1] = uint16_t(v >> 16); q.bits[2] = uint16_t(v >> 32);
+			return q;
+		}
+	};
+	struct quat64 {
+		uint64_t bits;
+		typedef detail::smallest3<20> codec;
+		quat64() = default;
+		inline constexpr quat64(const quatf& q) : bits(codec::encode(q)) {}
+		inline constexpr operator quatf() const { return codec::decode(bits); }
+		inline constexpr uint64_t value() const { return bits; }
+		inline static constexpr quat64 from_value(const uint64_t& v) { quat64 q{}; q.bits = v; return q; }
+	};
+
+	// unit vectors in 16 and 32 bits by octahedral mapping with 8 and 16 bit snorm coordinates. Rounding to the
+	// nearest step keeps the direction within 1 and 0.004 degrees (0.954 and 0.0037 measured), decoding is normalized.
+	struct oct16 {
+		int8_t u, v;
+		typedef detail::octahedral<127> codec;
+		oct16() = default;
+		inline constexpr oct16(const vec3f& n) : u(), v() {
+			const vec2f p = codec::encode(n);
+			u = int8_t(codec::quantize(p.x)); v = int8_t(codec::quantize(p.y));
+		}
+		inline constexpr operator vec3f() const { return codec::decode(u, v); }
+	};
+	struct oct32 {
+		int16_t u, v;
+		typedef detail::octahedral<32767> codec;
+		oct32() = default;
+		inline constexpr oct32(const vec3f& n) : u(), v() {
+			const vec2f p = codec::encode(n);
+			u = int16_t(codec::quantize(p.x)); v = int16_t(codec::quantize(p.y));
+		}
+		inline constexpr operator vec3f() const { return codec::decode(u, v); }
+	};
+
+	// positions quantized to a box by pos_range, 16 bits per axis for pos48 and 11, 11 and 10 bits for pos32
+	// (x in the low bits). steps + 1 levels span each axis
+	struct pos48 {
+		uint16_t x, y, z;
+		static constexpr uint32_t steps[3]{ 65535, 65535, 65535 };
+		inline constexpr uint32_t operator[](const size_t& i) const { return i == 0 ? x : i == 1 ? y : z; }
+		inline static constexpr pos48 pack(const uint32_t& x, const uint32_t& y, const uint32_t& z) { return { uint16_t(x), uint16_t(y), uint16_t(z) }; }
+	};
+	struct pos32 {
+		uint32_t bits;
+		static constexpr uint32_t steps[3]{ 2047, 2047, 1023 };
+		inline constexpr uint32_t operator[](const size_t& i) const { return bits >> (i * 11) & steps[i]; }
+		inline static constexpr pos32 pack(const uint32_t& x, const uint32_t& y, const uint32_t& z) { return { x | y << 11 | z << 22 }; }
+	};
+
+	// the box min .. min + size (size > 0 on every axis). Points inside come back within half a step per axis,
+	// size / 131070 for pos48, size / 4094 on x and y and size / 2046 on z for pos32, plus the float rounding of
+	// the encode scale and of min + q * (size / steps): (|min| + size) * 2^-22 more at most.
+	// Points outside clamp to the box.
+	struct pos_range {
+		vec3f min, size;
+		template<typename P> inline constexpr P encode(const vec3f& p) const {
+			return P::pack(quantize(p.x, min.x, 1 / size.x, P::steps[0]), quantize(p.y, min.y, 1 / size.y, P::steps[1]),
+				quantize(p.z, min.z, 1 / size.z, P::steps[2]));
+		}
+		template<typename P> inline constexpr vec3f decode(const P& q) const {
+			return { min.x + float(q[0]) * (size.x / P::steps[0]), min.y + float(q[1]) * (size.y / P::steps[1]), min.z + float(q[2]) * (size.z / P::steps[2]) };
+		}
+
+		// the bounds of points, a flat axis gets a size of epsilon
+		inline static constexpr pos_range from_bounds(const vec3f& min, const vec3f& max) {
+			return { min, { mathf::max(max.x - min.x, mathf::epsilon), mathf::max(max.y - min.y, mathf::epsilon), mathf::max(max.z - min.z, mathf::epsilon) } };
+		}
+		inline static constexpr uint32_t quantize(const float& p, const float& min, const float& rsize, const uint32_t& steps) {
+			return uint32_t(mathf::min(mathf::max((p - min) * rsize, 0.0f), 1.0f) * float(steps) + 0.5f);
+		}
+	};
+
+	namespace simd {
+		// the float math runs on V and the bit packing per lane through int32 blocks, over the leading whole blocks
+		// of V, returns the count done. Encoding matches the scalar conversions bit for bit, decoding up to fma
+		// contraction of the scalar code. Decoding unpacks stage elements at a time before loading them as vectors,
+		// a vector load right behind the narrow stores that filled it stalls on the failed store forward
+		static constexpr size_t stage = 64;
+		template<typename V, typename P> inline size_t quat_encode(const quatf* in, P* out, const size_t& n) {
+			typedef typename P::codec C;
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), two = broadcast<V>(2), three = broadcast<V>(3),
+				m = broadcast<V>(C::m), nm = broadcast<V>(-C::m), k = broadcast<V>(C::k), h = broadcast<V>(0.5f),
+				sign = broadcast<V>(-0.0f), abs = broadcast<V>(mathf::bit_cast<float>(0x7fffffffu));
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V x, y, z, w;
+				load4((const float*)(in + i), x, y, z, w);
+				const V ax = band(x, abs), ay = band(y, abs), az = band(z, abs), aw = band(w, abs),
+					mx = max(max(ax, ay), max(az, aw));
+				// first index holding the largest, like the scalar scan
+				V idx = select(cmpeq(az, mx), two, three);
+				idx = select(cmpeq(ay, mx), one, idx);
+				idx = select(cmpeq(ax, mx), zero, idx);
+				const V e0 = cmpeq(idx, zero), le1 = cmple(idx, one), le2 = cmple(idx, two),
+					s = band(select(e0, x, select(le1, y, select(le2, z, w))), sign);
+				const V a = bxor(select(e0, y, x), s), b = bxor(select(le1, z, y), s), c = bxor(select(le2, w, z), s);
+				int32_t t[4][lanes];
+				store32(t[0], idx);
+				store32(t[1], add(add(min(max(mul(a, k), nm), m), m), h));
+				store32(t[2], add(add(min(max(mul(b, k), nm), m), m), h));
+				store32(t[3], add(add(min(max(mul(c, k), nm), m), m), h));
+				for (size_t j = 0; j < lanes; ++j)
+					out[i + j] = P::from_value(uint64_t(t[0][j]) << 3 * C::bits | uint64_t(t[1][j]) << 2 * C::bits | uint64_t(t[2][j]) << C::bits | uint64_t(t[3][j]));
+			}
+			return i;
+		}
+		template<typename V, typename P> inline size_t quat_decode(const P* in, quatf* out, const size_t& n) {
+			typedef typename P::codec C;
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), two = broadcast<V>(2), three = broadcast<V>(3),
+				m = broadcast<V>(C::m), rk = broadcast<V>(C::rk);
+			size_t i = 0;
+			for (; i + lanes <= n;) {
+				const size_t count = n - i < stage ? (n - i) / lanes * lanes : stage;
+				int32_t t[stage / lanes][4][lanes];
+				for (size_t j = 0; j < count / lanes; ++j)
+					for (size_t k = 0; k < lanes; ++k) {
+						const uint64_t v = in[i + j * lanes + k].value();
+						t[j][0][k] = int32_t(v >> 3 * C::bits & 3); t[j][1][k] = int32_t(v >> 2 * C::bits & C::mask);
+						t[j][2][k] = int32_t(v >> C::bits & C::mask); t[j][3][k] = int32_t(v & C::mask);
+					}
+				for (size_t j = 0; j < count; j += lanes) {
+					V idx, a, b, c;
+					load32(t[j / lanes][0], idx); load32(t[j / lanes][1], a); load32(t[j / lanes][2], b); load32(t[j / lanes][3], c);
+					a = mul(sub(a, m), rk); b = mul(sub(b, m), rk); c = mul(sub(c, m), rk);
+					const V d = sqrt(max(zero, sub(one, add(add(mul(a, a), mul(b, b)), mul(c, c)))));
+					const V e0 = cmpeq(idx, zero), e1 = cmpeq(idx, one), e2 = cmpeq(idx, two), e3 = cmpeq(idx, three);
+					store4((float*)(out + i + j), select(e0, d, a), select(e0, a, select(e1, d, b)), select(e2, d, select(e3, c, b)), select(e3, d, c));
+				}
+				i += count;
+			}
+			return i;
+		}
+
+		template<typename V, typename P> inline size_t oct_encode(const vec3f* in, P* out, const size_t& n) {
+			typedef typename P::codec C;
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), lo = broadcast<V>(-1), m = broadcast<V>(C::m),
+				h = broadcast<V>(0.5f), nh = broadcast<V>(-0.5f), sign = broadcast<V>(-0.0f), abs = broadcast<V>(mathf::bit_cast<float>(0x7fffffffu));
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V x, y, z;
+				load3((const float*)(in + i), x, y, z);
+				const V r = div(one, add(add(band(x, abs), band(y, abs)), band(z, abs))), px = mul(x, r), py = mul(y, r);
+				const V fx = bxor(sub(one, band(py, abs)), band(cmplt(px, zero), sign)), fy = bxor(sub(one, band(px, abs)), band(cmplt(py, zero), sign));
+				const V neg = cmplt(z, zero), u = min(max(select(neg, fx, px), lo), one), v = min(max(select(neg, fy, py), lo), one);
+				int32_t t[2][lanes];
+				store32(t[0], add(mul(u, m), select(cmplt(u, zero), nh, h)));
+				store32(t[1], add(mul(v, m), select(cmplt(v, zero), nh, h)));
+				for (size_t j = 0; j < lanes; ++j) { out[i + j].u = decltype(out->u)(t[0][j]); out[i + j].v = decltype(out->v)(t[1][j]); }
+			}
+			return i;
+		}
+		template<typename V, typename P> inline size_t oct_decode(const P* in, vec3f* out, const size_t& n) {
+			typedef typename P::codec C;
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), lo = broadcast<V>(-1), rm = broadcast<V>(C::rm),
+				sign = broadcast<V>(-0.0f), abs = broadcast<V>(mathf::bit_cast<float>(0x7fffffffu));
+			size_t i = 0;
+			for (; i + lanes <= n;) {
+				const size_t count = n - i < stage ? (n - i) / lanes * lanes : stage;
+				int32_t t[stage / lanes][2][lanes];
+				for (size_t j = 0; j < count / lanes; ++j)
+					for (size_t k = 0; k < lanes; ++k) { t[j][0][k] = in[i + j * lanes + k].u; t[j][1][k] = in[i + j * lanes + k].v; }
+				for (size_t j = 0; j < count; j += lanes) {
+					V x, y;
+					load32(t[j / lanes][0], x); load32(t[j / lanes][1], y);
+					x = max(mul(x, rm), lo); y = max(mul(y, rm), lo);
+					const V z = sub(sub(one, band(x, abs)), band(y, abs)), f = max(bxor(z, sign), zero);
+					x = add(x, select(cmplt(x, zero), f, bxor(f, sign)));
+					y = add(y, select(cmplt(y, zero), f, bxor(f, sign)));
+					const V r = div(one, sqrt(add(add(mul(x, x), mul(y, y)), mul(z, z))));
+					store3((float*)(out + i + j), mul(x, r), mul(y, r), mul(z, r));
+				}
+				i += count;
+			}
+			return i;
+		}
+
+		template<typename V, typename P> inline size_t pos_encode(const pos_range& range, const vec3f* in, P* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), h = broadcast<V>(0.5f),
+				mx = broadcast<V>(range.min.x), my = broadcast<V>(range.min.y), mz = broadcast<V>(range.min.z),
+				rx = broadcast<V>(1 / range.size.x), ry = broadcast<V>(1 / range.size.y), rz = broadcast<V>(1 / range.size.z),
+				sx = broadcast<V>(float(P::steps[0])), sy = broadcast<V>(float(P::steps[1])), sz = broadcast<V>(float(P::steps[2]));
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V x, y, z;
+				load3((const float*)(in + i), x, y, z);
+				int32_t t[3][lanes];
+				store32(t[0], add(mul(min(max(mul(sub(x, mx), rx), zero), one), sx), h));
+				store32(t[1], add(mul(min(max(mul(sub(y, my), ry), zero), one), sy), h));
+				store32(t[2], add(mul(min(max(mul(sub(z, mz), rz), zero), one), sz), h));
+				for (size_t j = 0; j < lanes; ++j) out[i + j] = P::pack(uint32_t(t[0][j]), uint32_t(t[1][j]), uint32_t(t[2][j]));
+			}
+			return i;
+		}
+		template<typename V, typename P> inline size_t pos_decode(const pos_range& range, const P* in, vec3f* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			const V mx = broadcast<V>(range.min.x), my = broadcast<V>(range.min.y), mz = broadcast<V>(range.min.z),
+				sx = broadcast<V>(range.size.x / P::steps[0]), sy = broadcast<V>(range.size.y / P::steps[1]), sz = broadcast<V>(range.size.z / P::steps[2]);
+			size_t i = 0;
+			for (; i + lanes <= n;) {
+				const size_t count = n - i < stage ? (n - i) / lanes * lanes : stage;
+				int32_t t[stage / lanes][3][lanes];
+				for (size_t j = 0; j < count / lanes; ++j)
+					for (size_t k = 0; k < lanes; ++k) {
+						const P& q = in[i + j * lanes + k];
+						t[j][0][k] = int32_t(q[0]); t[j][1][k] = int32_t(q[1]); t[j][2][k] = int32_t(q[2]);
+					}
+				for (size_t j = 0; j < count; j += lanes) {
+					V x, y, z;
+					load32(t[j / lanes][0], x); load32(t[j / lanes][1], y); load32(t[j / lanes][2], z);
+					store3((float*)(out + i + j), add(mx, mul(x, sx)), add(my, mul(y, sy)), add(mz, mul(z, sz)));
+				}
+				i += count;
+			}
+			return i;
+		}
+		// pos48 is a plain uint16 stream, converted in place with the box repeating every 3 lanes
+		template<typename V> inline size_t pos_encode(const pos_range& range, const vec3f* in, pos48* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			float m[3 * lanes], r[3 * lanes];
+			for (size_t j = 0; j < 3 * lanes; ++j) { m[j] = range.min[j % 3]; r[j] = 1 / range.size[j % 3]; }
+			const V zero = broadcast<V>(0), one = broadcast<V>(1), h = broadcast<V>(0.5f), s = broadcast<V>(float(pos48::steps[0]));
+			const V m0 = load<V>(m), m1 = load<V>(m + lanes), m2 = load<V>(m + 2 * lanes), r0 = load<V>(r), r1 = load<V>(r + lanes), r2 = load<V>(r + 2 * lanes);
+			const float* p = (const float*)in;
+			uint16_t* o = (uint16_t*)out;
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				store16(o + 3 * i, add(mul(min(max(mul(sub(load<V>(p + 3 * i), m0), r0), zero), one), s), h));
+				store16(o + 3 * i + lanes, add(mul(min(max(mul(sub(load<V>(p + 3 * i + lanes), m1), r1), zero), one), s), h));
+				store16(o + 3 * i + 2 * lanes, add(mul(min(max(mul(sub(load<V>(p + 3 * i + 2 * lanes), m2), r2), zero), one), s), h));
+			}
+			return i;
+		}
+		template<typename V> inline size_t pos_decode(const pos_range& range, const pos48* in, vec3f* out, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			float m[3 * lanes], s[3 * lanes];
+			for (size_t j = 0; j < 3 * lanes; ++j) { m[j] = range.min[j % 3]; s[j] = range.size[j % 3] / pos48::steps[0]; }
+			const V m0 = load<V>(m), m1 = load<V>(m + lanes), m2 = load<V>(m + 2 * lanes), s0 = load<V>(s), s1 = load<V>(s + lanes), s2 = load<V>(s + 2 * lanes);
+			const uint16_t* p = (const uint16_t*)in;
+			float* o = (float*)out;
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V u0, u1, u2;
+				load16(p + 3 * i, u0); load16(p + 3 * i + lanes, u1); load16(p + 3 * i + 2 * lanes, u2);
+				store(o + 3 * i, add(m0, mul(u0, s0)));
+				store(o + 3 * i + lanes, add(m1, mul(u1, s1)));
+				store(o + 3 * i + 2 * lanes, add(m2, mul(u2, s2)));
+			}
+			return i;
+		}
+	}
+
+	// n rotations, unit vectors or positions to a quantized format and back, out must not overlap in
+	inline void convert_n(const quatf* in, quat32* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::quat_encode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::quat_encode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const quat32* in, quatf* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::quat_decode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::quat_decode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const quatf* in, quat48* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::quat_encode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::quat_encode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const quat48* in, quatf* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::quat_decode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::quat_decode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const quatf* in, quat64* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::quat_encode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::quat_encode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const quat64* in, quatf* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::quat_decode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::quat_decode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const vec3f* in, oct16* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::oct_encode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::oct_encode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const oct16* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::oct_decode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::oct_decode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const vec3f* in, oct32* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::oct_encode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::oct_encode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const oct32* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::oct_decode<simd::f8>(in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::oct_decode<simd::f4>(in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = in[i];
+	}
+	inline void convert_n(const pos_range& r, const vec3f* in, pos48* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::pos_encode<simd::f8>(r, in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::pos_encode<simd::f4>(r, in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = r.encode<pos48>(in[i]);
+	}
+	inline void convert_n(const pos_range& r, const pos48* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::pos_decode<simd::f8>(r, in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::pos_decode<simd::f4>(r, in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = r.decode(in[i]);
+	}
+	inline void convert_n(const pos_range& r, const vec3f* in, pos32* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::pos_encode<simd::f8>(r, in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::pos_encode<simd::f4>(r, in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = r.encode<pos32>(in[i]);
+	}
+	inline void convert_n(const pos_range& r, const pos32* in, vec3f* out, const size_t& n) {
+		size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+		i += simd::pos_decode<simd::f8>(r, in, out, n);
+#endif
+#if PXL_SIMD
+		i += simd::pos_decode<simd::f4>(r, in + i, out + i, n - i);
+#endif
+		for (; i < n; ++i) out[i] = r.decode(in[i]);
+	}
+}
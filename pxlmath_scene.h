@@ -0,0 +1,87 @@
+#pragma once
+
+#include "pxlmath.h"
+#include "pxlmath_jobs.h"
+#include <stdint.h>
+#include <vector>
+
+namespace pxl {
+	// flat transform hierarchy. Nodes are added parent first, local trs lives in parallel arrays and world
+	// matrices are rebuilt by propagate one depth level at a time, so every parent is final before its children.
+	// set_* marks a node dirty; clean nodes under clean parents keep their world matrix, and levels with nothing
+	// dirty above or in them are skipped without touching their nodes.
+	struct scene_graph {
+		static constexpr uint32_t none = ~0u;
+
+		std::vector<uint32_t> parent, depth;
+		std::vector<vec3f> position, scale;
+		std::vector<quatf> rotation;
+		std::vector<mat4f> world;
+		std::vector<uint8_t> dirty, changed;
+		std::vector<std::vector<uint32_t>> levels;
+		std::vector<uint8_t> level_dirty;
+
+		inline size_t size() const { return parent.size(); }
+		inline void reserve(const size_t& n) {
+			parent.reserve(n); depth.reserve(n);
+			position.reserve(n); rotation.reserve(n); scale.reserve(n);
+			world.reserve(n); dirty.reserve(n); changed.reserve(n);
+		}
+		inline void clear() {
+			parent.clear(); depth.clear();
+			position.clear(); rotation.clear(); scale.clear();
+			world.clear(); dirty.clear(); changed.clear();
+			levels.clear(); level_dirty.clear();
+		}
+		// p must be none or an existing node, returns the new node index
+		inline uint32_t add(const uint32_t& p = none, const vec3f& t = vec3f::zero(), const quatf& r = quatf::identity(), const vec3f& s = { 1, 1, 1 }) {
+			const uint32_t i = (uint32_t)parent.size(), d = p == none ? 0 : depth[p] + 1;
+			parent.push_back(p); depth.push_back(d);
+			position.push_back(t); rotation.push_back(r); scale.push_back(s);
+			world.push_back(mat4f::identity()); dirty.push_back(1); changed.push_back(0);
+			if (levels.size() <= d) { levels.resize(d + 1); level_dirty.resize(d + 1, 0); }
+			levels[d].push_back(i);
+			level_dirty[d] = 1;
+			return i;
+		}
+
+		inline void set_position(const uint32_t& i, const vec3f& t) { position[i] = t; mark(i); }
+		inline void set_rotation(const uint32_t& i, const quatf& r) { rotation[i] = r; mark(i); }
+		inline void set_scale(const uint32_t& i, const vec3f& s) { scale[i] = s; mark(i); }
+		inline void set_local(const uint32_t& i, const vec3f& t, const quatf& r, const vec3f& s) {
+			position[i] = t; rotation[i] = r; scale[i] = s; mark(i);
+		}
+		inline void mark(const uint32_t& i) { dirty[i] = 1; level_dirty[depth[i]] = 1; }
+		inline mat4f local(const uint32_t& i) const { return mat4f::trs(position[i], rotation[i], scale[i]); }
+
+		// world = world[parent] * trs(position, rotation, scale) for dirty nodes and everything under them,
+		// using mul_affine since both sides come from trs
+		// levels wider than grain are split across pool, null runs on the calling thread
+		inline void propagate(job_pool* pool = nullptr, const size_t& grain = 1024) {
+			bool carry = false;
+			for (size_t d = 0; d < levels.size(); ++d) {
+				if (!carry && !level_dirty[d]) continue;
+				const uint32_t* nodes = levels[d].data();
+				std::atomic<bool> any{ false };
+				auto work = [&](const size_t& b, const size_t& e) {
+					bool hit = false;
+					for (size_t k = b; k < e; ++k) {
+						const uint32_t i = nodes[k], p = parent[i];
+						const bool c = dirty[i] || (carry && p != none && changed[p]);
+						changed[i] = c;
+						if (!c) continue;
+						dirty[i] = 0;
+						hit = true;
+						world[i] = p == none ? local(i) : world[p].mul_affine(local(i));
+					}
+					if (hit) any.store(true, std::memory_order_relaxed);
+				};
+				if (pool) pool->parallel_for(levels[d].size(), grain, work);
+				else work(0, levels[d].size());
+				// changed flags of a level are only read by the next one when it ran this pass
+				carry = any.load(std::memory_order_relaxed);
+				level_dirty[d] = 0;
+			}
+		}
+	};
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "pxlmath.h"
+#include "pxlmath_jobs.h"
+#include <stdint.h>
+
+namespace pxl {
+	// rigid transform as real + e dual with real the rotation r and dual t r / 2 for the translation t (as a pure
+	// quaternion). Unit dual quaternions blend as plain sums and renormalize, without the volume loss of blended
+	// matrices around twisting joints. a * b applies b first, like quat and mat
+	template<typename T> struct dualquat {
+		quat<T> real, dual;
+
+		inline constexpr quat<T> rotation() const { return real; }
+		// 2 dual conj(real), the part of dual along real (left over by blending) drops out
+		inline constexpr vec<3, T> translation() const {
+			return {
+				2 * (real.w * dual.x - dual.w * real.x + real.y * dual.z - real.z * dual.y),
+				2 * (real.w * dual.y - dual.w * real.y + real.z * dual.x - real.x * dual.z),
+				2 * (real.w * dual.z - dual.w * real.z + real.x * dual.y - real.y * dual.x) };
+		}
+		inline constexpr vec<3, T> transform_point(const vec<3, T>& p) const {
+			const vec<3, T> r{ real.rotate(p) }, t{ translation() };
+			return { r.x + t.x, r.y + t.y, r.z + t.z };
+		}
+		inline constexpr vec<3, T> transform_dir(const vec<3, T>& d) const { return real.rotate(d); }
+
+		// both parts scaled by 1 / |real|, zero when real is below epsilon like quat::normalized
+		inline constexpr dualquat& normalize() { return *this = normalized(); }
+		inline constexpr dualquat normalized() const {
+			const T sqrmag = quat<T>::dot(real, real);
+			if (sqrmag < mathf::epsilon) return zero();
+			const T rmag = mathf::rsqrt(sqrmag);
+			return { { real.x * rmag, real.y * rmag, real.z * rmag, real.w * rmag }, { dual.x * rmag, dual.y * rmag, dual.z * rmag, dual.w * rmag } };
+		}
+		// the inverse of a unit dual quaternion
+		inline constexpr dualquat conjugated() const { return { real.conjugated(), dual.conjugated() }; }
+		inline constexpr dualquat operator*(const dualquat& o) const {
+			const quat<T> a{ real * o.dual }, b{ dual * o.real };
+			return { real * o.real, { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w } };
+		}
+		inline constexpr bool operator==(const dualquat& o) const { return real == o.real && dual == o.dual; }
+		inline constexpr bool operator!=(const dualquat& o) const { return !(*this == o); }
+
+		inline static constexpr dualquat zero() { return { { 0, 0, 0, 0 }, { 0, 0, 0, 0 } }; }
+		inline static constexpr dualquat identity() { return { { 0, 0, 0, 1 }, { 0, 0, 0, 0 } }; }
+		// rotation r (unit) then translation t
+		inline static constexpr dualquat from_rt(const quat<T>& r, const vec<3, T>& t) {
+			const quat<T> d{ quat<T>{ t.x, t.y, t.z, 0 } * r };
+			return { r, { d.x * T(0.5f), d.y * T(0.5f), d.z * T(0.5f), d.w * T(0.5f) } };
+		}
+		// rotation and translation of m through mat::decompose, the scale is dropped
+		inline static constexpr dualquat from_mat(const mat<4, 4, T>& m) {
+			vec<3, T> t{}, s{};
+			quat<T> r{};
+			mat<4, 4, T>::decompose(m, t, r, s);
+			return from_rt(r, t);
+		}
+	};
+	typedef dualquat<float> dualquatf;
+	typedef dualquat<double> dualquatd;
+	template<typename T> inline constexpr bool approx_equal(const dualquat<T>& a, const dualquat<T>& b, const T& eps = T(1e-5f)) {
+		return approx_equal(a.real, b.real, eps) && approx_equal(a.dual, b.dual, eps);
+	}
+	template<typename T> inline constexpr size_t hash(const dualquat<T>& q) {
+		detail::hasher h;
+		h.add(q.real.x, q.real.y); h.add(q.real.z, q.real.w);
+		h.add(q.dual.x, q.dual.y); h.add(q.dual.z, q.dual.w);
+		return h.finish();
+	}
+
+	// K influences of a vertex, joint indexes the palette. The weights should sum to 1, unused slots have weight 0
+	template<size_t K> struct skin_weights {
+		static_assert(K == 4 || K == 8, "4 or 8 influences");
+		float weight[K];
+		uint16_t joint[K];
+	};
+	typedef skin_weights<4> skin_weights4;
+	typedef skin_weights<8> skin_weights8;
+
+	// linear blend: the weighted sum of the palette matrices (top three rows, the bottom row is 0 0 0 1)
+	template<size_t K> inline constexpr mat4f skin_matrix(const mat4f* palette, const skin_weights<K>& w) {
+		mat4f r{ mat4f::zero() };
+		r.m33 = 1;
+		for (size_t k = 0; k < K; ++k) {
+			const mat4f& m = palette[w.joint[k]];
+			const float s = w.weight[k];
+			r.m00 += s * m.m00; r.m01 += s * m.m01; r.m02 += s * m.m02; r.m03 += s * m.m03;
+			r.m10 += s * m.m10; r.m11 += s * m.m11; r.m12 += s * m.m12; r.m13 += s * m.m13;
+			r.m20 += s * m.m20; r.m21 += s * m.m21; r.m22 += s * m.m22; r.m23 += s * m.m23;
+		}
+		return r;
+	}
+	// dual quaternion blend: the weighted sum with every real part on the side of the first influence's (q and -q
+	// are the same rotation), normalized
+	template<size_t K> inline constexpr dualquatf skin_dualquat(const dualquatf* palette, const skin_weights<K>& w) {
+		const quatf& q = palette[w.joint[0]].real;
+		dualquatf r{ dualquatf::zero() };
+		for (size_t k = 0; k < K; ++k) {
+			const dualquatf& d = palette[w.joint[k]];
+			const float s = quatf::dot(d.real, q) < 0 ? -w.weight[k] : w.weight[k];
+			r.real.x += s * d.real.x; r.real.y += s * d.real.y; r.real.z += s * d.real.z; r.real.w += s * d.real.w;
+			r.dual.x += s * d.dual.x; r.dual.y += s * d.dual.y; r.dual.z += s * d.dual.z; r.dual.w += s * d.dual.w;
+		}
+		return r.normalized();
+	}
+
+	namespace simd {
+		// top three rows of skin_matrix, on avx2 the first two as one f8
+		template<size_t K> inline void skin_rows(const float* palette, const skin_weights<K>& w, f4& r0, f4& r1, f4& r2) {
+			const float* m = palette + 16 * w.joint[0];
+#if PXL_SIMD == PXL_SIMD_AVX2
+			f8 a = broadcast<f8>(w.weight[0]), r01 = mul(a, load<f8>(m));
+			r2 = mul(low(a), load(m + 8));
+			for (size_t k = 1; k < K; ++k) {
+				m = palette + 16 * w.joint[k];
+				a = broadcast<f8>(w.weight[k]);
+				r01 = add(r01, mul(a, load<f8>(m)));
+				r2 = add(r2, mul(low(a), load(m + 8)));
+			}
+			r0 = low(r01); r1 = high(r01);
+#else
+			f4 a = set1(w.weight[0]);
+			r0 = mul(a, load(m)); r1 = mul(a, load(m + 4)); r2 = mul(a, load(m + 8));
+			for (size_t k = 1; k < K; ++k) {
+				m = palette + 16 * w.joint[k];
+				a = set1(w.weight[k]);
+				r0 = add(r0, mul(a, load(m))); r1 = add(r1, mul(a, load(m + 4))); r2 = add(r2, mul(a, load(m + 8)));
+			}
+#endif
+		}
+		// groups of 4 floats, one per lane, to the lanes of a b c d. f8 takes the high half from the groups 4 to 7
+		inline void rows_to_lanes(const f4* r, f4& a, f4& b, f4& c, f4& d) {
+			a = r[0]; b = r[1]; c = r[2]; d = r[3];
+			transpose(a, b, c, d);
+		}
+		inline void rows_to_lanes(const f4* r, f8& a, f8& b, f8& c, f8& d) {
+			a = combine(r[0], r[4]); b = combine(r[1], r[5]); c = combine(r[2], r[6]); d = combine(r[3], r[7]);
+			transpose(a, b, c, d);
+		}
+		inline void load_lanes(const float* const* p, const size_t& offset, f4& a, f4& b, f4& c, f4& d) {
+			a = load(p[0] + offset); b = load(p[1] + offset); c = load(p[2] + offset); d = load(p[3] + offset);
+			transpose(a, b, c, d);
+		}
+		inline void load_lanes(const float* const* p, const size_t& offset, f8& a, f8& b, f8& c, f8& d) {
+			a = load(p[0] + offset, p[4] + offset); b = load(p[1] + offset, p[5] + offset);
+			c = load(p[2] + offset, p[6] + offset); d = load(p[3] + offset, p[7] + offset);
+			transpose(a, b, c, d);
+		}
+
+		// skinned positions (and normals) over the leading whole blocks of V, returns the count done.
+		// Linear blend sums the palette rows per vertex and turns a block of blended matrices into lanes
+		template<typename V, size_t K, bool normals> inline size_t skin_lbs(const float* palette, const skin_weights<K>* w,
+			const float* pos, const float* nrm, float* opos, float* onrm, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				f4 r[3][lanes];
+				for (size_t j = 0; j < lanes; ++j) skin_rows(palette, w[i + j], r[0][j], r[1][j], r[2][j]);
+				V m[3][4];
+				for (int j = 0; j < 3; ++j) rows_to_lanes(r[j], m[j][0], m[j][1], m[j][2], m[j][3]);
+				V x, y, z;
+				load3(pos + 3 * i, x, y, z);
+				store3(opos + 3 * i,
+					add(add(add(mul(m[0][0], x), mul(m[0][1], y)), mul(m[0][2], z)), m[0][3]),
+					add(add(add(mul(m[1][0], x), mul(m[1][1], y)), mul(m[1][2], z)), m[1][3]),
+					add(add(add(mul(m[2][0], x), mul(m[2][1], y)), mul(m[2][2], z)), m[2][3]));
+				if (normals) {
+					load3(nrm + 3 * i, x, y, z);
+					store3(onrm + 3 * i,
+						add(add(mul(m[0][0], x), mul(m[0][1], y)), mul(m[0][2], z)),
+						add(add(mul(m[1][0], x), mul(m[1][1], y)), mul(m[1][2], z)),
+						add(add(mul(m[2][0], x), mul(m[2][1], y)), mul(m[2][2], z)));
+				}
+			}
+			return i;
+		}
+		// dual quaternion blend with one vertex per lane, the palette entries are gathered into lanes per influence
+		// and the antipodal check against the first influence is a sign flip of the weight
+		template<typename V, size_t K, bool normals> inline size_t skin_dqs(const float* palette, const skin_weights<K>* w,
+			const float* pos, const float* nrm, float* opos, float* onrm, const size_t& n) {
+			const size_t lanes = sizeof(V) / sizeof(float), stride = sizeof(skin_weights<K>) / sizeof(float);
+			const V zero = broadcast<V>(0), two = broadcast<V>(2), sign = broadcast<V>(-0.0f), eps = broadcast<V>(mathf::epsilon);
+			size_t i = 0;
+			for (; i + lanes <= n; i += lanes) {
+				V wt[K];
+				for (size_t k = 0; k < K; k += 4) load4(w[i].weight + k, stride, wt[k], wt[k + 1], wt[k + 2], wt[k + 3]);
+				const float* p[lanes];
+				for (size_t j = 0; j < lanes; ++j) p[j] = palette + 8 * w[i + j].joint[0];
+				V qx, qy, qz, qw, dx, dy, dz, dw;
+				load_lanes(p, 0, qx, qy, qz, qw);
+				load_lanes(p, 4, dx, dy, dz, dw);
+				V rx = mul(wt[0], qx), ry = mul(wt[0], qy), rz = mul(wt[0], qz), rw = mul(wt[0], qw);
+				dx = mul(wt[0], dx); dy = mul(wt[0], dy); dz = mul(wt[0], dz); dw = mul(wt[0], dw);
+				for (size_t k = 1; k < K; ++k) {
+					for (size_t j = 0; j < lanes; ++j) p[j] = palette + 8 * w[i + j].joint[k];
+					V ax, ay, az, aw, bx, by, bz, bw;
+					load_lanes(p, 0, ax, ay, az, aw);
+					load_lanes(p, 4, bx, by, bz, bw);
+					const V d = add(add(add(mul(ax, qx), mul(ay, qy)), mul(az, qz)), mul(aw, qw));
+					const V s = bxor(wt[k], band(cmplt(d, zero), sign));
+					rx = add(rx, mul(s, ax)); ry = add(ry, mul(s, ay)); rz = add(rz, mul(s, az)); rw = add(rw, mul(s, aw));
+					dx = add(dx, mul(s, bx)); dy = add(dy, mul(s, by)); dz = add(dz, mul(s, bz)); dw = add(dw, mul(s, bw));
+				}
+				const V sqrmag = add(add(add(mul(rx, rx), mul(ry, ry)), mul(rz, rz)), mul(rw, rw));
+				const V rmag = select(cmplt(sqrmag, eps), zero, rsqrt<mathf::precision::standard>(sqrmag));
+				rx = mul(rx, rmag); ry = mul(ry, rmag); rz = mul(rz, rmag); rw = mul(rw, rmag);
+				dx = mul(dx, rmag); dy = mul(dy, rmag); dz = mul(dz, rmag); dw = mul(dw, rmag);
+				const V tx = mul(two, add(sub(mul(rw, dx), mul(dw, rx)), sub(mul(ry, dz), mul(rz, dy))));
+				const V ty = mul(two, add(sub(mul(rw, dy), mul(dw, ry)), sub(mul(rz, dx), mul(rx, dz))));
+				const V tz = mul(two, add(sub(mul(rw, dz), mul(dw, rz)), sub(mul(rx, dy), mul(ry, dx))));
+				V x, y, z;
+				load3(pos + 3 * i, x, y, z);
+				quat_rotate(rx, ry, rz, rw, x, y, z);
+				store3(opos + 3 * i, add(x, tx), add(y, ty), add(z, tz));
+				if (normals) {
+					load3(nrm + 3 * i, x, y, z);
+					quat_rotate(rx, ry, rz, rw, x, y, z);
+					store3(onrm + 3 * i, x, y, z);
+				}
+			}
+			return i;
+		}
+	}
+
+	namespace detail {
+		template<size_t K, bool normals> inline void skin_lbs(const mat4f* palette, const skin_weights<K>* w,
+			const vec3f* pos, const vec3f* nrm, vec3f* opos, vec3f* onrm, const size_t& n) {
+			size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+			i += simd::skin_lbs<simd::f8, K, normals>(&palette->m00, w, (const float*)pos, (const float*)nrm, (float*)opos, (float*)onrm, n);
+#endif
+#if PXL_SIMD
+			i += simd::skin_lbs<simd::f4, K, normals>(&palette->m00, w + i, (const float*)(pos + i), (const float*)(nrm + i), (float*)(opos + i), (float*)(onrm + i), n - i);
+#endif
+			for (; i < n; ++i) {
+				const mat4f m = skin_matrix(palette, w[i]);
+				opos[i] = m.transform_point(pos[i]);
+				if (normals) onrm[i] = m.transform_dir(nrm[i]);
+			}
+		}
+		template<size_t K, bool normals> inline void skin_dqs(const dualquatf* palette, const skin_weights<K>* w,
+			const vec3f* pos, const vec3f* nrm, vec3f* opos, vec3f* onrm, const size_t& n) {
+			size_t i = 0;
+#if PXL_SIMD == PXL_SIMD_AVX2
+			i += simd::skin_dqs<simd::f8, K, normals>(&palette->real.x, w, (const float*)pos, (const float*)nrm, (float*)opos, (float*)onrm, n);
+#endif
+#if PXL_SIMD
+			i += simd::skin_dqs<simd::f4, K, normals>(&palette->real.x, w + i, (const float*)(pos + i), (const float*)(nrm + i), (float*)(opos + i), (float*)(onrm + i), n - i);
+#endif
+			for (; i < n; ++i) {
+				const dualquatf q = skin_dualquat(palette, w[i]);
+				opos[i] = q.transform_point(pos[i]);
+				if (normals) onrm[i] = q.transform_dir(nrm[i]);
+			}
+		}
+		// chunks of grain vertices (rounded up to whole blocks of 8, at least one) across pool, null runs on the calling thread
+		template<typename F> inline void skin_chunks(const size_t& n, job_pool* pool, const size_t& grain, const F& f) {
+			if (pool) pool->parallel_for(n, ((grain ? grain : 1) + 7) & ~size_t(7), f);
+			else if (n) f(size_t(0), n);
+		}
+	}
+
+	// n skinned positions, and normals in the second form, by linear blend over a mat4f palette or by dual
+	// quaternion blend over a dualquatf palette; the scalar results are skin_matrix / skin_dualquat applied per
+	// vertex. Linear blend normals go through the blended 3x3 and are not renormalized, dual quaternion normals
+	// are only rotated. Outputs may be the same arrays as the inputs but must not partially overlap them
+	template<size_t K> inline void skin_n(const mat4f* palette, const skin_weights<K>* w, const vec3f* in, vec3f* out, const size_t& n,
+		job_pool* pool = nullptr, const size_t& grain = 1024) {
+		detail::skin_chunks(n, pool, grain, [&](const size_t& b, const size_t& e) {
+			detail::skin_lbs<K, false>(palette, w + b, in + b, in + b, out + b, out + b, e - b);
+		});
+	}
+	template<size_t K> inline void skin_n(const mat4f* palette, const skin_weights<K>* w, const vec3f* pos, const vec3f* nrm,
+		vec3f* out_pos, vec3f* out_nrm, const size_t& n, job_pool* pool = nullptr, const size_t& grain = 1024) {
+		detail::skin_chunks(n, pool, grain, [&](const size_t& b, const size_t& e) {
+			detail::skin_lbs<K, true>(palette, w + b, pos + b, nrm + b, out_pos + b, out_nrm + b, e - b);
+		});
+	}
+	template<size_t K> inline void skin_n(const dualquatf* palette, const skin_weights<K>* w, const vec3f* in, vec3f* out, const size_t& n,
+		job_pool* pool = nullptr, const size_t& grain = 1024) {
+		detail::skin_chunks(n, pool, grain, [&](const size_t& b, const size_t& e) {
+			detail::skin_dqs<K, false>(palette, w + b, in + b, in + b, out + b, out + b, e - b);
+		});
+	}
+	template<size_t K> inline void skin_n(const dualquatf* palette, const skin_weights<K>* w, const vec3f* pos, const vec3f* nrm,
+		vec3f* out_pos, vec3f* out_nrm, const size_t& n, job_pool* pool = nullptr, const size_t& grain = 1024) {
+		detail::skin_chunks(n, pool, grain, [&](const size_t& b, const size_t& e) {
+			detail::skin_dqs<K, true>(palette, w + b, pos + b, nrm + b, out_pos + b, out_nrm + b, e - b);
+		});
+	}
+}
+
+namespace std {
+	template<typename T> struct hash<pxl::dualquat<T>> { inline size_t operator()(const pxl::dualquat<T>& q) const { return pxl::hash(q); } };
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "pxlmath.h"
+#include <new>
+#include <utility>
+
+namespace pxl {
+	// S float streams of the same length in one allocation. Every stream starts on a 64-byte boundary and is
+	// padded to a multiple of 16 lanes, so the bulk kernels below run whole registers with no tail. The kernels
+	// write their results into the padding too, resize zeroes whatever elements it adds or drops.
+	template<size_t S> struct soa_streams {
+		float* data{ nullptr };
+		size_t count{ 0 }, stride{ 0 };
+
+		inline soa_streams() {}
+		inline explicit soa_streams(const size_t& n) { resize(n); }
+		inline soa_streams(const soa_streams& o) { resize(o.count); if (stride) memcpy(data, o.data, S * stride * sizeof(float)); }
+		inline soa_streams(soa_streams&& o) noexcept { swap(o); }
+		inline ~soa_streams() { release(); }
+		inline soa_streams& operator =(const soa_streams& o) {
+			if (this != &o) { resize(o.count); if (stride) memcpy(data, o.data, S * stride * sizeof(float)); }
+			return *this;
+		}
+		inline soa_streams& operator =(soa_streams&& o) noexcept { swap(o); return *this; }
+
+		inline size_t size() const { return count; }
+		inline size_t padded() const { return stride; }
+		inline float* stream(const size_t& k) { return data + k * stride; }
+		inline const float* stream(const size_t& k) const { return data + k * stride; }
+		inline void swap(soa_streams& o) noexcept { std::swap(data, o.data); std::swap(count, o.count); std::swap(stride, o.stride); }
+		// keeps the first min(n, size()) elements, new elements are zero
+		inline void resize(const size_t& n) {
+			const size_t s = (n + 15) & ~size_t(15);
+			if (s != stride) {
+				float* d = s ? (float*)::operator new(S * s * sizeof(float), std::align_val_t(64)) : nullptr;
+				if (d) memset(d, 0, S * s * sizeof(float));
+				const size_t keep = n < count ? n : count;
+				for (size_t k = 0; k < S && keep; ++k) memcpy(d + k * s, data + k * stride, keep * sizeof(float));
+				release();
+				data = d; stride = s;
+			}
+			else if (n < count) {
+				for (size_t k = 0; k < S; ++k) memset(data + k * stride + n, 0, (count - n) * sizeof(float));
+			}
+			else if (n > count) {
+				for (size_t k = 0; k < S; ++k) memset(data + k * stride + count, 0, (n - count) * sizeof(float));
+			}
+			count = n;
+		}
+		inline void release() {
+			if (data) ::operator delete(data, std::align_val_t(64));
+			data = nullptr; count = stride = 0;
+		}
+	};
+
+	struct vec3f_soa : soa_streams<3> {
+		using soa_streams<3>::soa_streams;
+		inline float* x() { return stream(0); }
+		inline float* y() { return stream(1); }
+		inline float* z() { return stream(2); }
+		inline const float* x() const { return stream(0); }
+		inline const float* y() const { return stream(1); }
+		inline const float* z() const { return stream(2); }
+		inline vec3f get(const size_t& i) const { return { x()[i], y()[i], z()[i] }; }
+		inline void set(const size_t& i, const vec3f& v) { x()[i] = v.x; y()[i] = v.y; z()[i] = v.z; }
+
+		inline void from_aos(const vec3f* v, const size_t& n) {
+			resize(n);
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4) {
+				simd::f4 vx, vy, vz;
+				simd::load3((const float*)(v + i), vx, vy, vz);
+				simd::store(x() + i, vx); simd::store(y() + i, vy); simd::store(z() + i, vz);
+			}
+			for (; i < n; ++i) set(i, v[i]);
+		}
+		inline void to_aos(vec3f* v) const {
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+				simd::store3((float*)(v + i), simd::load(x() + i), simd::load(y() + i), simd::load(z() + i));
+			for (; i < count; ++i) v[i] = get(i);
+		}
+	};
+
+	struct quatf_soa : soa_streams<4> {
+		using soa_streams<4>::soa_streams;
+		inline float* x() { return stream(0); }
+		inline float* y() { return stream(1); }
+		inline float* z() { return stream(2); }
+		inline float* w() { return stream(3); }
+		inline const float* x() const { return stream(0); }
+		inline const float* y() const { return stream(1); }
+		inline const float* z() const { return stream(2); }
+		inline const float* w() const { return stream(3); }
+		inline quatf get(const size_t& i) const { return { x()[i], y()[i], z()[i], w()[i] }; }
+		inline void set(const size_t& i, const quatf& q) { x()[i] = q.x; y()[i] = q.y; z()[i] = q.z; w()[i] = q.w; }
+
+		inline void from_aos(const quatf* q, const size_t& n) {
+			resize(n);
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4) {
+				simd::f4 vx, vy, vz, vw;
+				simd::load4((const float*)(q + i), vx, vy, vz, vw);
+				simd::store(x() + i, vx); simd::store(y() + i, vy); simd::store(z() + i, vz); simd::store(w() + i, vw);
+			}
+			for (; i < n; ++i) set(i, q[i]);
+		}
+		inline void to_aos(quatf* q) const {
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+				simd::store4((float*)(q + i), simd::load(x() + i), simd::load(y() + i), simd::load(z() + i), simd::load(w() + i));
+			for (; i < count; ++i) q[i] = get(i);
+		}
+	};
+
+	// stream 4 * r + c holds element m<r><c>
+	struct mat4f_soa : soa_streams<16> {
+		using soa_streams<16>::soa_streams;
+		inline float* m(const size_t& r, const size_t& c) { return stream(4 * r + c); }
+		inline const float* m(const size_t& r, const size_t& c) const { return stream(4 * r + c); }
+		inline mat4f get(const size_t& i) const {
+			mat4f o;
+			for (size_t k = 0; k < 16; ++k) o[k] = stream(k)[i];
+			return o;
+		}
+		inline void set(const size_t& i, const mat4f& o) { for (size_t k = 0; k < 16; ++k) stream(k)[i] = o[k]; }
+
+		inline void from_aos(const mat4f* o, const size_t& n) {
+			resize(n);
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4) {
+				const float* p = (const float*)(o + i);
+				for (size_t r = 0; r < 4; ++r) {
+					simd::f4 r0 = simd::load(p + 4 * r), r1 = simd::load(p + 16 + 4 * r), r2 = simd::load(p + 32 + 4 * r), r3 = simd::load(p + 48 + 4 * r);
+					simd::transpose(r0, r1, r2, r3);
+					simd::store(m(r, 0) + i, r0); simd::store(m(r, 1) + i, r1); simd::store(m(r, 2) + i, r2); simd::store(m(r, 3) + i, r3);
+				}
+			}
+			for (; i < n; ++i) set(i, o[i]);
+		}
+		inline void to_aos(mat4f* o) const {
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				float* p = (float*)(o + i);
+				for (size_t r = 0; r < 4; ++r) {
+					simd::f4 r0 = simd::load(m(r, 0) + i), r1 = simd::load(m(r, 1) + i), r2 = simd::load(m(r, 2) + i), r3 = simd::load(m(r, 3) + i);
+					simd::transpose(r0, r1, r2, r3);
+					simd::store(p + 4 * r, r0); simd::store(p + 16 + 4 * r, r1); simd::store(p + 32 + 4 * r, r2); simd::store(p + 48 + 4 * r, r3);
+				}
+			}
+			for (; i < count; ++i) o[i] = get(i);
+		}
+	};
+
+	// bulk kernels, out is resized to the input size and may be one of the inputs. Inputs of different sizes are
+	// taken up to the shorter one
+	template<size_t A, size_t B> inline size_t common_size(const soa_streams<A>& a, const soa_streams<B>& b) { return a.size() < b.size() ? a.size() : b.size(); }
+
+	inline void add(const vec3f_soa& a, const vec3f_soa& b, vec3f_soa& out) {
+		out.resize(common_size(a, b));
+		for (size_t k = 0; k < 3; ++k)
+			for (size_t i = 0; i < out.padded(); i += simd::lanes)
+				simd::store(out.stream(k) + i, simd::add(simd::load<simd::fw>(a.stream(k) + i), simd::load<simd::fw>(b.stream(k) + i)));
+	}
+	inline void sub(const vec3f_soa& a, const vec3f_soa& b, vec3f_soa& out) {
+		out.resize(common_size(a, b));
+		for (size_t k = 0; k < 3; ++k)
+			for (size_t i = 0; i < out.padded(); i += simd::lanes)
+				simd::store(out.stream(k) + i, simd::sub(simd::load<simd::fw>(a.stream(k) + i), simd::load<simd::fw>(b.stream(k) + i)));
+	}
+	inline void mul(const vec3f_soa& a, const vec3f_soa& b, vec3f_soa& out) {
+		out.resize(common_size(a, b));
+		for (size_t k = 0; k < 3; ++k)
+			for (size_t i = 0; i < out.padded(); i += simd::lanes)
+				simd::store(out.stream(k) + i, simd::mul(simd::load<simd::fw>(a.stream(k) + i), simd::load<simd::fw>(b.stream(k) + i)));
+	}
+	inline void mul(const vec3f_soa& a, const float& s, vec3f_soa& out) {
+		out.resize(a.size());
+		const simd::fw vs = simd::broadcast<simd::fw>(s);
+		for (size_t i = 0; i < 3 * a.padded(); i += simd::lanes)
+			simd::store(out.data + i, simd::mul(simd::load<simd::fw>(a.data + i), vs));
+	}
+	// out holds common_size(a, b) floats
+	inline void dot(const vec3f_soa& a, const vec3f_soa& b, float* out) {
+		const size_t n = common_size(a, b);
+		size_t i = 0;
+		for (; i + simd::lanes <= n; i += simd::lanes) {
+			const simd::fw d = simd::add(simd::add(
+				simd::mul(simd::load<simd::fw>(a.x() + i), simd::load<simd::fw>(b.x() + i)),
+				simd::mul(simd::load<simd::fw>(a.y() + i), simd::load<simd::fw>(b.y() + i))),
+				simd::mul(simd::load<simd::fw>(a.z() + i), simd::load<simd::fw>(b.z() + i)));
+			simd::store(out + i, d);
+		}
+		for (; i < n; ++i) out[i] = a.x()[i] * b.x()[i] + a.y()[i] * b.y()[i] + a.z()[i] * b.z()[i];
+	}
+	inline void length(const vec3f_soa& a, float* out) {
+		size_t i = 0;
+		for (; i + simd::lanes <= a.size(); i += simd::lanes) {
+			const simd::fw x = simd::load<simd::fw>(a.x() + i), y = simd::load<simd::fw>(a.y() + i), z = simd::load<simd::fw>(a.z() + i);
+			simd::store(out + i, simd::sqrt(simd::add(simd::add(simd::mul(x, x), simd::mul(y, y)), simd::mul(z, z))));
+		}
+		for (; i < a.size(); ++i) out[i] = sqrtf(a.x()[i] * a.x()[i] + a.y()[i] * a.y()[i] + a.z()[i] * a.z()[i]);
+	}
+	inline void cross(const vec3f_soa& a, const vec3f_soa& b, vec3f_soa& out) {
+		out.resize(common_size(a, b));
+		for (size_t i = 0; i < out.padded(); i += simd::lanes) {
+			const simd::fw ax = simd::load<simd::fw>(a.x() + i), ay = simd::load<simd::fw>(a.y() + i), az = simd::load<simd::fw>(a.z() + i);
+			const simd::fw bx = simd::load<simd::fw>(b.x() + i), by = simd::load<simd::fw>(b.y() + i), bz = simd::load<simd::fw>(b.z() + i);
+			simd::store(out.x() + i, simd::sub(simd::mul(ay, bz), simd::mul(az, by)));
+			simd::store(out.y() + i, simd::sub(simd::mul(az, bx), simd::mul(ax, bz)));
+			simd::store(out.z() + i, simd::sub(simd::mul(ax, by), simd::mul(ay, bx)));
+		}
+	}
+	// like vec3f::normalized, vectors shorter than sqrt(epsilon) become zero
+	inline void normalize(const vec3f_soa& a, vec3f_soa& out) {
+		out.resize(a.size());
+		const simd::fw eps = simd::broadcast<simd::fw>(mathf::epsilon), zero = simd::broadcast<simd::fw>(0);
+		for (size_t i = 0; i < a.padded(); i += simd::lanes) {
+			const simd::fw x = simd::load<simd::fw>(a.x() + i), y = simd::load<simd::fw>(a.y() + i), z = simd::load<simd::fw>(a.z() + i);
+			const simd::fw sqrmag = simd::add(simd::add(simd::mul(x, x), simd::mul(y, y)), simd::mul(z, z));
+			const simd::fw r = simd::select(simd::cmplt(sqrmag, eps), zero, simd::rsqrt<mathf::precision::standard>(simd::max(sqrmag, eps)));
+			simd::store(out.x() + i, simd::mul(x, r)); simd::store(out.y() + i, simd::mul(y, r)); simd::store(out.z() + i, simd::mul(z, r));
+		}
+	}
+
+	inline void mul(const quatf_soa& a, const quatf_soa& b, quatf_soa& out) {
+		out.resize(common_size(a, b));
+		for (size_t i = 0; i < out.padded(); i += simd::lanes) {
+			const simd::fw ax = simd::load<simd::fw>(a.x() + i), ay = simd::load<simd::fw>(a.y() + i),
+				az = simd::load<simd::fw>(a.z() + i), aw = simd::load<simd::fw>(a.w() + i);
+			const simd::fw bx = simd::load<simd::fw>(b.x() + i), by = simd::load<simd::fw>(b.y() + i),
+				bz = simd::load<simd::fw>(b.z() + i), bw = simd::load<simd::fw>(b.w() + i);
+			// same terms as quatf::operator*
+			simd::store(out.x() + i, simd::add(simd::sub(simd::add(simd::mul(ax, bw), simd::mul(ay, bz)), simd::mul(az, by)), simd::mul(aw, bx)));
+			simd::store(out.y() + i, simd::add(simd::add(simd::sub(simd::mul(ay, bw), simd::mul(ax, bz)), simd::mul(az, bx)), simd::mul(aw, by)));
+			simd::store(out.z() + i, simd::add(simd::add(simd::sub(simd::mul(ax, by), simd::mul(ay, bx)), simd::mul(az, bw)), simd::mul(aw, bz)));
+			simd::store(out.w() + i, simd::sub(simd::sub(simd::sub(simd::mul(aw, bw), simd::mul(ax, bx)), simd::mul(ay, by)), simd::mul(az, bz)));
+		}
+	}
+	inline void dot(const quatf_soa& a, const quatf_soa& b, float* out) {
+		const size_t n = common_size(a, b);
+		size_t i = 0;
+		for (; i + simd::lanes <= n; i += simd::lanes) {
+			const simd::fw d = simd::add(simd::add(simd::add(
+				simd::mul(simd::load<simd::fw>(a.x() + i), simd::load<simd::fw>(b.x() + i)),
+				simd::mul(simd::load<simd::fw>(a.y() + i), simd::load<simd::fw>(b.y() + i))),
+				simd::mul(simd::load<simd::fw>(a.z() + i), simd::load<simd::fw>(b.z() + i))),
+				simd::mul(simd::load<simd::fw>(a.w() + i), simd::load<simd::fw>(b.w() + i)));
+			simd::store(out + i, d);
+		}
+		for (; i < n; ++i) out[i] = a.x()[i] * b.x()[i] + a.y()[i] * b.y()[i] + a.z()[i] * b.z()[i] + a.w()[i] * b.w()[i];
+	}
+	inline void normalize(const quatf_soa& a, quatf_soa& out) {
+		out.resize(a.size());
+		const simd::fw eps = simd::broadcast<simd::fw>(mathf::epsilon), zero = simd::broadcast<simd::fw>(0);
+		for (size_t i = 0; i < a.padded(); i += simd::lanes) {
+			const simd::fw x = simd::load<simd::fw>(a.x() + i), y = simd::load<simd::fw>(a.y() + i),
+				z = simd::load<simd::fw>(a.z() + i), w = simd::load<simd::fw>(a.w() + i);
+			const simd::fw sqrmag = simd::add(simd::add(simd::add(simd::mul(x, x), simd::mul(y, y)), simd::mul(z, z)), simd::mul(w, w));
+			const simd::fw r = simd::select(simd::cmplt(sqrmag, eps), zero, simd::rsqrt<mathf::precision::standard>(simd::max(sqrmag, eps)));
+			simd::store(out.x() + i, simd::mul(x, r)); simd::store(out.y() + i, simd::mul(y, r));
+			simd::store(out.z() + i, simd::mul(z, r)); simd::store(out.w() + i, simd::mul(w, r));
+		}
+	}
+
+	// out[i] = a[i] * b[i], one matrix pair per lane
+	inline void mul(const mat4f_soa& a, const mat4f_soa& b, mat4f_soa& out) {
+		out.resize(common_size(a, b));
+		for (size_t i = 0; i < out.padded(); i += simd::lanes) {
+			simd::fw r[16];
+			for (size_t row = 0; row < 4; ++row) {
+				const simd::fw a0 = simd::load<simd::fw>(a.m(row, 0) + i), a1 = simd::load<simd::fw>(a.m(row, 1) + i),
+					a2 = simd::load<simd::fw>(a.m(row, 2) + i), a3 = simd::load<simd::fw>(a.m(row, 3) + i);
+				for (size_t c = 0; c < 4; ++c)
+					r[4 * row + c] = simd::add(simd::add(simd::add(
+						simd::mul(a0, simd::load<simd::fw>(b.m(0, c) + i)), simd::mul(a1, simd::load<simd::fw>(b.m(1, c) + i))),
+						simd::mul(a2, simd::load<simd::fw>(b.m(2, c) + i))), simd::mul(a3, simd::load<simd::fw>(b.m(3, c) + i)));
+			}
+			for (size_t k = 0; k < 16; ++k) simd::store(out.stream(k) + i, r[k]);
+		}
+	}
+	// out[i] = m[i].transform_point(p[i])
+	inline void transform_points(const mat4f_soa& m, const vec3f_soa& p, vec3f_soa& out) {
+		out.resize(common_size(m, p));
+		for (size_t i = 0; i < out.padded(); i += simd::lanes) {
+			const simd::fw x = simd::load<simd::fw>(p.x() + i), y = simd::load<simd::fw>(p.y() + i), z = simd::load<simd::fw>(p.z() + i);
+			simd::fw o[3];
+			for (size_t row = 0; row < 3; ++row)
+				o[row] = simd::add(simd::add(simd::add(
+					simd::mul(simd::load<simd::fw>(m.m(row, 0) + i), x), simd::mul(simd::load<simd::fw>(m.m(row, 1) + i), y)),
+					simd::mul(simd::load<simd::fw>(m.m(row, 2) + i), z)), simd::load<simd::fw>(m.m(row, 3) + i));
+			simd::store(out.x() + i, o[0]); simd::store(out.y() + i, o[1]); simd::store(out.z() + i, o[2]);
+		}
+	}
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "pxlmath.h"
+
+namespace pxl {
+	// one object per lane: float_x8 holds eight floats, vec3f_x8 eight vec3f in three registers and so on.
+	// N is 4 or 8, the 8-lane forms are two 4-lane halves on backends without 256-bit registers.
+	template<size_t N> struct mask_xn {
+		typedef typename simd::reg<N>::type V;
+		V m;
+		static constexpr size_t lanes = N;
+		inline mask_xn operator&(const mask_xn& o) const { return { simd::band(m, o.m) }; }
+		inline mask_xn operator|(const mask_xn& o) const { return { simd::bor(m, o.m) }; }
+		inline mask_xn operator^(const mask_xn& o) const { return { simd::bxor(m, o.m) }; }
+		inline mask_xn operator~() const {
+			const V z = simd::broadcast<V>(0);
+			return { simd::bxor(m, simd::cmple(z, z)) };
+		}
+		inline int bits() const { return simd::movemask(m); }
+		inline bool any() const { return bits() != 0; }
+		inline bool all() const { return bits() == (1 << lanes) - 1; }
+		inline bool none() const { return bits() == 0; }
+		inline bool operator[](const size_t& i) const { return (bits() >> i) & 1; }
+	};
+
+	template<size_t N> struct float_xn {
+		typedef typename simd::reg<N>::type V;
+		V v;
+		static constexpr size_t lanes = N;
+		inline float_xn operator+() const { return *this; }
+		inline float_xn operator-() const { return { simd::sub(simd::broadcast<V>(0), v) }; }
+		inline float_xn operator+(const float_xn& o) const { return { simd::add(v, o.v) }; }
+		inline float_xn operator-(const float_xn& o) const { return { simd::sub(v, o.v) }; }
+		inline float_xn operator*(const float_xn& o) const { return { simd::mul(v, o.v) }; }
+		inline float_xn operator/(const float_xn& o) const { return { simd::div(v, o.v) }; }
+		inline float_xn operator+(const float& o) const { return { simd::add(v, simd::broadcast<V>(o)) }; }
+		inline float_xn operator-(const float& o) const { return { simd::sub(v, simd::broadcast<V>(o)) }; }
+		inline float_xn operator*(const float& o) const { return { simd::mul(v, simd::broadcast<V>(o)) }; }
+		inline float_xn operator/(const float& o) const { return { simd::div(v, simd::broadcast<V>(o)) }; }
+		inline friend float_xn operator+(const float& l, const float_xn& r) { return { simd::add(simd::broadcast<V>(l), r.v) }; }
+		inline friend float_xn operator-(const float& l, const float_xn& r) { return { simd::sub(simd::broadcast<V>(l), r.v) }; }
+		inline friend float_xn operator*(const float& l, const float_xn& r) { return { simd::mul(simd::broadcast<V>(l), r.v) }; }
+		inline friend float_xn operator/(const float& l, const float_xn& r) { return { simd::div(simd::broadcast<V>(l), r.v) }; }
+		inline float_xn& operator+=(const float_xn& o) { v = simd::add(v, o.v); return *this; }
+		inline float_xn& operator-=(const float_xn& o) { v = simd::sub(v, o.v); return *this; }
+		inline float_xn& operator*=(const float_xn& o) { v = simd::mul(v, o.v); return *this; }
+		inline float_xn& operator/=(const float_xn& o) { v = simd::div(v, o.v); return *this; }
+		inline mask_xn<N> operator<(const float_xn& o) const { return { simd::cmplt(v, o.v) }; }
+		inline mask_xn<N> operator<=(const float_xn& o) const { return { simd::cmple(v, o.v) }; }
+		inline mask_xn<N> operator>(const float_xn& o) const { return { simd::cmplt(o.v, v) }; }
+		inline mask_xn<N> operator>=(const float_xn& o) const { return { simd::cmple(o.v, v) }; }
+		inline mask_xn<N> operator==(const float_xn& o) const { return { simd::cmpeq(v, o.v) }; }
+		inline mask_xn<N> operator!=(const float_xn& o) const { return ~(*this == o); }
+		inline float operator[](const size_t& i) const { float t[lanes]; simd::store(t, v); return t[i]; }
+		inline float hsum() const { return simd::hsum(v); }
+		inline float hmin() const { return simd::hmin(v); }
+		inline float hmax() const { return simd::hmax(v); }
+		inline void store(float* p) const { simd::store(p, v); }
+
+		inline static float_xn broadcast(const float& x) { return { simd::broadcast<V>(x) }; }
+		inline static float_xn load(const float* p) { return { simd::load<V>(p) }; }
+		inline static float_xn sqrt(const float_xn& x) { return { simd::sqrt(x.v) }; }
+		inline static float_xn min(const float_xn& l, const float_xn& r) { return { simd::min(l.v, r.v) }; }
+		inline static float_xn max(const float_xn& l, const float_xn& r) { return { simd::max(l.v, r.v) }; }
+		// the mathf polynomials per lane with the same error, exact lanes use the standard ones
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn sin(const float_xn& x) { return { simd::sin<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn cos(const float_xn& x) { return { simd::cos<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn tan(const float_xn& x) { return { simd::tan<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn asin(const float_xn& x) { return { simd::asin<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn acos(const float_xn& x) { return { simd::acos<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn atan(const float_xn& x) { return { simd::atan<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn exp(const float_xn& x) { return { simd::exp<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn log(const float_xn& x) { return { simd::log<P>(x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn atan2(const float_xn& y, const float_xn& x) { return { simd::atan2<P>(y.v, x.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static float_xn pow(const float_xn& x, const float_xn& y) { return { simd::pow<P>(x.v, y.v) }; }
+		template<mathf::precision P = mathf::precision::standard> inline static void sincos(const float_xn& x, float_xn& s, float_xn& c) { simd::sincos<P>(x.v, s.v, c.v); }
+	};
+
+	template<size_t N> struct vec3f_xn {
+		typedef typename simd::reg<N>::type V;
+		V x, y, z;
+		static constexpr size_t lanes = N;
+		inline float_xn<N> sqrmagnitude() const { return { simd::add(simd::add(simd::mul(x, x), simd::mul(y, y)), simd::mul(z, z)) }; }
+		inline float_xn<N> magnitude() const {
+			const V sqrmag = sqrmagnitude().v;
+			return { simd::select(simd::cmplt(sqrmag, simd::broadcast<V>(mathf::epsilon)), simd::broadcast<V>(0), simd::sqrt(sqrmag)) };
+		}
+		inline const vec3f_xn& normalize() { return *this = normalized(); }
+		inline vec3f_xn normalized() const {
+			const V sqrmag = sqrmagnitude().v, eps = simd::broadcast<V>(mathf::epsilon);
+			const V rmag = simd::select(simd::cmplt(sqrmag, eps), simd::broadcast<V>(0),
+				simd::rsqrt<mathf::precision::standard>(simd::max(sqrmag, eps)));
+			return { simd::mul(x, rmag), simd::mul(y, rmag), simd::mul(z, rmag) };
+		}
+		inline vec3f_xn operator+() const { return *this; }
+		inline vec3f_xn operator-() const { return (*this) * -1; }
+		inline vec3f_xn operator+(const vec3f_xn& o) const { return { simd::add(x, o.x), simd::add(y, o.y), simd::add(z, o.z) }; }
+		inline vec3f_xn operator-(const vec3f_xn& o) const { return { simd::sub(x, o.x), simd::sub(y, o.y), simd::sub(z, o.z) }; }
+		inline vec3f_xn operator*(const vec3f_xn& o) const { return { simd::mul(x, o.x), simd::mul(y, o.y), simd::mul(z, o.z) }; }
+		inline vec3f_xn operator/(const vec3f_xn& o) const { return { simd::div(x, o.x), simd::div(y, o.y), simd::div(z, o.z) }; }
+		inline vec3f_xn operator+(const vec3f& o) const { return *this + broadcast(o); }
+		inline vec3f_xn operator-(const vec3f& o) const { return *this - broadcast(o); }
+		inline vec3f_xn operator*(const vec3f& o) const { return *this * broadcast(o); }
+		inline vec3f_xn operator/(const vec3f& o) const { return *this / broadcast(o); }
+		inline vec3f_xn operator*(const float_xn<N>& o) const { return { simd::mul(x, o.v), simd::mul(y, o.v), simd::mul(z, o.v) }; }
+		inline vec3f_xn operator/(const float_xn<N>& o) const { return { simd::div(x, o.v), simd::div(y, o.v), simd::div(z, o.v) }; }
+		inline vec3f_xn operator*(const float& o) const { return *this * float_xn<N>::broadcast(o); }
+		inline vec3f_xn operator/(const float& o) const { return *this / float_xn<N>::broadcast(o); }
+		inline friend vec3f_xn operator*(const float_xn<N>& l, const vec3f_xn& r) { return r * l; }
+		inline friend vec3f_xn operator*(const float& l, const vec3f_xn& r) { return r * l; }
+		inline vec3f_xn& operator+=(const vec3f_xn& o) { return *this = *this + o; }
+		inline vec3f_xn& operator-=(const vec3f_xn& o) { return *this = *this - o; }
+		inline vec3f_xn& operator*=(const vec3f_xn& o) { return *this = *this * o; }
+		inline vec3f_xn& operator/=(const vec3f_xn& o) { return *this = *this / o; }
+		inline vec3f_xn& operator*=(const float_xn<N>& o) { return *this = *this * o; }
+		inline vec3f_xn& operator*=(const float& o) { return *this = *this * o; }
+		inline vec3f operator[](const size_t& i) const {
+			float tx[lanes], ty[lanes], tz[lanes];
+			simd::store(tx, x); simd::store(ty, y); simd::store(tz, z);
+			return { tx[i], ty[i], tz[i] };
+		}
+		inline vec3f hsum() const { return { simd::hsum(x), simd::hsum(y), simd::hsum(z) }; }
+		// writes lanes consecutive vec3f
+		inline void store(vec3f* p) const { simd::store3((float*)p, x, y, z); }
+
+		inline static vec3f_xn zero() { return broadcast({ 0, 0, 0 }); }
+		inline static vec3f_xn broadcast(const vec3f& v) { return { simd::broadcast<V>(v.x), simd::broadcast<V>(v.y), simd::broadcast<V>(v.z) }; }
+		// reads lanes consecutive vec3f
+		inline static vec3f_xn load(const vec3f* p) { vec3f_xn r; simd::load3((const float*)p, r.x, r.y, r.z); return r; }
+		inline static float_xn<N> dot(const vec3f_xn& l, const vec3f_xn& r) {
+			return { simd::add(simd::add(simd::mul(l.x, r.x), simd::mul(l.y, r.y)), simd::mul(l.z, r.z)) };
+		}
+		inline static vec3f_xn cross(const vec3f_xn& l, const vec3f_xn& r) {
+			return {
+				simd::sub(simd::mul(l.y, r.z), simd::mul(l.z, r.y)),
+				simd::sub(simd::mul(l.z, r.x), simd::mul(l.x, r.z)),
+				simd::sub(simd::mul(l.x, r.y), simd::mul(l.y, r.x)) };
+		}
+	};
+
+	template<size_t N> struct quatf_xn {
+		typedef typename simd::reg<N>::type V;
+		V x, y, z, w;
+		static constexpr size_t lanes = N;
+		inline float_xn<N> magnitude() const {
+			const V sqrmag = simd::add(simd::add(simd::add(simd::mul(x, x), simd::mul(y, y)), simd::mul(z, z)), simd::mul(w, w));
+			return { simd::select(simd::cmplt(sqrmag, simd::broadcast<V>(mathf::epsilon)), simd::broadcast<V>(0), simd::sqrt(sqrmag)) };
+		}
+		inline quatf_xn& normalize() { return *this = normalized(); }
+		inline quatf_xn normalized() const {
+			const V sqrmag = simd::add(simd::add(simd::add(simd::mul(x, x), simd::mul(y, y)), simd::mul(z, z)), simd::mul(w, w));
+			const V eps = simd::broadcast<V>(mathf::epsilon);
+			const V rmag = simd::select(simd::cmplt(sqrmag, eps), simd::broadcast<V>(0),
+				simd::rsqrt<mathf::precision::standard>(simd::max(sqrmag, eps)));
+			return { simd::mul(x, rmag), simd::mul(y, rmag), simd::mul(z, rmag), simd::mul(w, rmag) };
+		}
+		inline quatf_xn& conjugate() { return *this = conjugated(); }
+		inline quatf_xn conjugated() const {
+			const V z0 = simd::broadcast<V>(0);
+			return { simd::sub(z0, x), simd::sub(z0, y), simd::sub(z0, z), w };
+		}
+		inline quatf_xn operator*(const quatf_xn& o) const {
+			return {
+				simd::add(simd::sub(simd::add(simd::mul(x, o.w), simd::mul(y, o.z)), simd::mul(z, o.y)), simd::mul(w, o.x)),
+				simd::add(simd::add(simd::sub(simd::mul(y, o.w), simd::mul(x, o.z)), simd::mul(z, o.x)), simd::mul(w, o.y)),
+				simd::add(simd::add(simd::sub(simd::mul(x, o.y), simd::mul(y, o.x)), simd::mul(z, o.w)), simd::mul(w, o.z)),
+				simd::sub(simd::sub(simd::sub(simd::mul(w, o.w), simd::mul(x, o.x)), simd::mul(y, o.y)), simd::mul(z, o.z)) };
+		}
+		inline quatf_xn& operator*=(const quatf_xn& o) { return *this = *this * o; }
+		inline vec3f_xn<N> rotate(const vec3f_xn<N>& v) const {
+			vec3f_xn<N> r = v;
+			simd::quat_rotate(x, y, z, w, r.x, r.y, r.z);
+			return r;
+		}
+		inline vec3f_xn<N> operator*(const vec3f_xn<N>& v) const { return rotate(v); }
+		inline quatf operator[](const size_t& i) const {
+			float tx[lanes], ty[lanes], tz[lanes], tw[lanes];
+			simd::store(tx, x); simd::store(ty, y); simd::store(tz, z); simd::store(tw, w);
+			return { tx[i], ty[i], tz[i], tw[i] };
+		}
+		// writes lanes consecutive quatf
+		inline void store(quatf* p) const { simd::store4((float*)p, x, y, z, w); }
+
+		inline static quatf_xn identity() { return broadcast(quatf::identity()); }
+		inline static quatf_xn broadcast(const quatf& q) {
+			return { simd::broadcast<V>(q.x), simd::broadcast<V>(q.y), simd::broadcast<V>(q.z), simd::broadcast<V>(q.w) };
+		}
+		// reads lanes consecutive quatf
+		inline static quatf_xn load(const quatf* p) { quatf_xn r; simd::load4((const float*)p, r.x, r.y, r.z, r.w); return r; }
+		inline static float_xn<N> dot(const quatf_xn& l, const quatf_xn& r) {
+			return { simd::add(simd::add(simd::add(simd::mul(l.x, r.x), simd::mul(l.y, r.y)), simd::mul(l.z, r.z)), simd::mul(l.w, r.w)) };
+		}
+		// per lane quatf::slerp, 0 <= t <= 1
+		inline static quatf_xn slerp(const quatf_xn& a, const quatf_xn& b, const float_xn<N>& t) {
+			quatf_xn r = a;
+			simd::quat_slerp(r.x, r.y, r.z, r.w, b.x, b.y, b.z, b.w, t.v);
+			return r;
+		}
+	};
+
+	// m[4 * r + c] holds element m<r><c> of every lane, products sum in the same order as mat4f's
+	template<size_t N> struct mat4f_xn {
+		typedef typename simd::reg<N>::type V;
+		V m[16];
+		static constexpr size_t lanes = N;
+		inline mat4f_xn operator*(const mat4f_xn& o) const {
+			mat4f_xn r;
+			for (size_t row = 0; row < 4; ++row)
+				for (size_t c = 0; c < 4; ++c)
+					r.m[4 * row + c] = simd::add(simd::add(simd::add(simd::mul(m[4 * row], o.m[c]), simd::mul(m[4 * row + 1], o.m[4 + c])),
+						simd::mul(m[4 * row + 2], o.m[8 + c])), simd::mul(m[4 * row + 3], o.m[12 + c]));
+			return r;
+		}
+		inline mat4f_xn& operator*=(const mat4f_xn& o) { return *this = *this * o; }
+		inline vec3f_xn<N> transform_point(const vec3f_xn<N>& p) const {
+			vec3f_xn<N> r;
+			V* o[3] = { &r.x, &r.y, &r.z };
+			for (size_t row = 0; row < 3; ++row)
+				*o[row] = simd::add(simd::add(simd::add(simd::mul(m[4 * row], p.x), simd::mul(m[4 * row + 1], p.y)), simd::mul(m[4 * row + 2], p.z)), m[4 * row + 3]);
+			return r;
+		}
+		inline vec3f_xn<N> transform_dir(const vec3f_xn<N>& d) const {
+			vec3f_xn<N> r;
+			V* o[3] = { &r.x, &r.y, &r.z };
+			for (size_t row = 0; row < 3; ++row)
+				*o[row] = simd::add(simd::add(simd::mul(m[4 * row], d.x), simd::mul(m[4 * row + 1], d.y)), simd::mul(m[4 * row + 2], d.z));
+			return r;
+		}
+		inline mat4f operator[](const size_t& i) const {
+			mat4f r;
+			float t[lanes];
+			for (size_t k = 0; k < 16; ++k) { simd::store(t, m[k]); r[k] = t[i]; }
+			return r;
+		}
+		// writes lanes consecutive mat4f
+		inline void store(mat4f* p) const {
+			for (size_t row = 0; row < 4; ++row) simd::store4(&p->m00 + 4 * row, 16, m[4 * row], m[4 * row + 1], m[4 * row + 2], m[4 * row + 3]);
+		}
+
+		inline static mat4f_xn identity() { return broadcast(mat4f::identity()); }
+		inline static mat4f_xn broadcast(const mat4f& o) {
+			mat4f_xn r;
+			for (size_t k = 0; k < 16; ++k) r.m[k] = simd::broadcast<V>(o[k]);
+			return r;
+		}
+		// reads lanes consecutive mat4f
+		inline static mat4f_xn load(const mat4f* p) {
+			mat4f_xn r;
+			for (size_t row = 0; row < 4; ++row) simd::load4(&p->m00 + 4 * row, 16, r.m[4 * row], r.m[4 * row + 1], r.m[4 * row + 2], r.m[4 * row + 3]);
+			return r;
+		}
+	};
+
+	// per lane m ? t : f
+	template<size_t N> inline float_xn<N> select(const mask_xn<N>& m, const float_xn<N>& t, const float_xn<N>& f) {
+		return { simd::select(m.m, t.v, f.v) };
+	}
+	template<size_t N> inline vec3f_xn<N> select(const mask_xn<N>& m, const vec3f_xn<N>& t, const vec3f_xn<N>& f) {
+		return { simd::select(m.m, t.x, f.x), simd::select(m.m, t.y, f.y), simd::select(m.m, t.z, f.z) };
+	}
+	template<size_t N> inline quatf_xn<N> select(const mask_xn<N>& m, const quatf_xn<N>& t, const quatf_xn<N>& f) {
+		return { simd::select(m.m, t.x, f.x), simd::select(m.m, t.y, f.y), simd::select(m.m, t.z, f.z), simd::select(m.m, t.w, f.w) };
+	}
+	template<size_t N> inline mat4f_xn<N> select(const mask_xn<N>& m, const mat4f_xn<N>& t, const mat4f_xn<N>& f) {
+		mat4f_xn<N> r;
+		for (size_t k = 0; k < 16; ++k) r.m[k] = simd::select(m.m, t.m[k], f.m[k]);
+		return r;
+	}
+
+	typedef mask_xn<4> mask_x4;
+	typedef mask_xn<8> mask_x8;
+	typedef float_xn<4> float_x4;
+	typedef float_xn<8> float_x8;
+	typedef vec3f_xn<4> vec3f_x4;
+	typedef vec3f_xn<8> vec3f_x8;
+	typedef quatf_xn<4> quatf_x4;
+	typedef quatf_xn<8> quatf_x8;
+	typedef mat4f_xn<4> mat4f_x4;
+	typedef mat4f_xn<8> mat4f_x8;
+}
@@ -0,0 +1,897 @@
+// pxlmath checks, self-contained, one binary per backend like the bench, exits non-zero on any failure:
+//   g++ -O2 -std=c++17 -DPXL_SIMD=PXL_SIMD_NONE tests/pxlmath_tests.cpp -o tests_none -lpthread
+//   g++ -O2 -std=c++17 -msse2 -DPXL_SIMD=PXL_SIMD_SSE2 tests/pxlmath_tests.cpp -o tests_sse2 -lpthread
+//   g++ -O2 -std=c++17 -mavx2 -mfma -mf16c -DPXL_SIMD=PXL_SIMD_AVX2 tests/pxlmath_tests.cpp -o tests_avx2 -lpthread
+//   cl /O2 /std:c++17 /EHsc /arch:AVX2 /DPXL_SIMD=PXL_SIMD_AVX2 tests\pxlmath_tests.cpp
+// usage: tests [filter...], only cases whose name contains one of the filters run
+
+#include "../pxlmath.h"
+#include "../pxlmath_anim.h"
+#include "../pxlmath_bvh.h"
+#include "../pxlmath_expr.h"
+#include "../pxlmath_quant.h"
+#include "../pxlmath_skin.h"
+#include "../pxlmath_soa.h"
+#include "../pxlmath_wide.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace pxl;
+
+namespace test {
+	static int nfilters = 0;
+	static char** filters = nullptr;
+	static int failures = 0, checks = 0;
+	static inline bool selected(const char* name) {
+		if (!nfilters) return true;
+		for (int i = 0; i < nfilters; ++i) if (strstr(name, filters[i])) return true;
+		return false;
+	}
+
+	static uint32_t seed = 0x12345678;
+	static inline float rnd() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) * (2.0f / 16777216.0f) - 1; }
+	static inline float rnd(const float& lo, const float& hi) { return lo + (rnd() + 1) * 0.5f * (hi - lo); }
+	static inline vec3f rnd3() { return { rnd(), rnd(), rnd() }; }
+	static inline quatf rndq() { return quatf{ rnd(), rnd(), rnd(), rnd() + 0.01f }.normalized(); }
+	// trs with scales in [lo, hi], view of a random rigid transform
+	static inline mat4f rnd_trs(const float& lo = 0.5f, const float& hi = 2) { return mat4f::trs(rnd3() * 10, rndq(), { rnd(lo, hi), rnd(lo, hi), rnd(lo, hi) }); }
+	static inline mat4f rnd_view() { return mat4f::view(rnd3() * 10, rndq(), { 1, 1, 1 }); }
+	// projection times view, far / near up to 20000
+	static inline mat4f rnd_camera() {
+		const float n = rnd(0.05f, 1), f = rnd(50, 1000), a = rnd(0.5f, 2);
+		return mat4f::perspective(n, f, -n * a, n * a, n, -n) * rnd_view();
+	}
+
+	// the scalar cofactor expansion mat4f::det / inverse run without simd, written out so every backend compares
+	// its kernels against it
+	static inline float ref_inverse(const mat4f& m, mat4f* out) {
+		const float m2323 = m.m22 * m.m33 - m.m23 * m.m32, m1323 = m.m21 * m.m33 - m.m23 * m.m31, m1223 = m.m21 * m.m32 - m.m22 * m.m31;
+		const float m0323 = m.m20 * m.m33 - m.m23 * m.m30, m0223 = m.m20 * m.m32 - m.m22 * m.m30, m0123 = m.m20 * m.m31 - m.m21 * m.m30;
+		const float m2313 = m.m12 * m.m33 - m.m13 * m.m32, m1313 = m.m11 * m.m33 - m.m13 * m.m31, m1213 = m.m11 * m.m32 - m.m12 * m.m31;
+		const float m2312 = m.m12 * m.m23 - m.m13 * m.m22, m1312 = m.m11 * m.m23 - m.m13 * m.m21, m1212 = m.m11 * m.m22 - m.m12 * m.m21;
+		const float m0313 = m.m10 * m.m33 - m.m13 * m.m30, m0213 = m.m10 * m.m32 - m.m12 * m.m30, m0312 = m.m10 * m.m23 - m.m13 * m.m20;
+		const float m0212 = m.m10 * m.m22 - m.m12 * m.m20, m0113 = m.m10 * m.m31 - m.m11 * m.m30, m0112 = m.m10 * m.m21 - m.m11 * m.m20;
+		const float det = m.m00 * (m.m11 * m2323 - m.m12 * m1323 + m.m13 * m1223)
+			- m.m01 * (m.m10 * m2323 - m.m12 * m0323 + m.m13 * m0223)
+			+ m.m02 * (m.m10 * m1323 - m.m11 * m0323 + m.m13 * m0123)
+			- m.m03 * (m.m10 * m1223 - m.m11 * m0223 + m.m12 * m0123);
+		if (!out || !det) return det;
+		const float r = 1 / det;
+		mat4f& o = *out;
+		o.m00 = r * (m.m11 * m2323 - m.m12 * m1323 + m.m13 * m1223);
+		o.m01 = r * -(m.m01 * m2323 - m.m02 * m1323 + m.m03 * m1223);
+		o.m02 = r * (m.m01 * m2313 - m.m02 * m1313 + m.m03 * m1213);
+		o.m03 = r * -(m.m01 * m2312 - m.m02 * m1312 + m.m03 * m1212);
+		o.m10 = r * -(m.m10 * m2323 - m.m12 * m0323 + m.m13 * m0223);
+		o.m11 = r * (m.m00 * m2323 - m.m02 * m0323 + m.m03 * m0223);
+		o.m12 = r * -(m.m00 * m2313 - m.m02 * m0313 + m.m03 * m0213);
+		o.m13 = r * (m.m00 * m2312 - m.m02 * m0312 + m.m03 * m0212);
+		o.m20 = r * (m.m10 * m1323 - m.m11 * m0323 + m.m13 * m0123);
+		o.m21 = r * -(m.m00 * m1323 - m.m01 * m0323 + m.m03 * m0123);
+		o.m22 = r * (m.m00 * m1313 - m.m01 * m0313 + m.m03 * m0113);
+		o.m23 = r * -(m.m00 * m1312 - m.m01 * m0312 + m.m03 * m0112);
+		o.m30 = r * -(m.m10 * m1223 - m.m11 * m0223 + m.m12 * m0123);
+		o.m31 = r * (m.m00 * m1223 - m.m01 * m0223 + m.m02 * m0123);
+		o.m32 = r * -(m.m00 * m1213 - m.m01 * m0213 + m.m02 * m0113);
+		o.m33 = r * (m.m00 * m1212 - m.m01 * m0212 + m.m02 * m0112);
+		return det;
+	}
+
+	// rotation angle between a and b in radians, q and -q being the same rotation
+	static inline double angle(const quatf& a, const quatf& b) {
+		// from the chord, acos of a dot product close to 1 loses half the digits
+		const double s = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z + double(a.w) * b.w < 0 ? -1 : 1;
+		double c = 0;
+		for (size_t k = 0; k < 4; ++k) c += (a[k] - s * b[k]) * (a[k] - s * b[k]);
+		return 4 * asin(fmin(1.0, sqrt(c) / 2));
+	}
+	// a random rotation about angle radians away from q
+	static inline quatf rnd_near(const quatf& q, const float& angle) {
+		const vec3f axis = vec3f{ rnd(), rnd(), rnd() + 0.01f }.normalized() * mathf::sin(angle * 0.5f);
+		return (q * quatf{ axis.x, axis.y, axis.z, mathf::cos(angle * 0.5f) }).normalized();
+	}
+
+	static inline float max_abs(const mat4f& m) {
+		float r = 0;
+		for (size_t i = 0; i < 16; ++i) r = mathf::max(r, mathf::abs(m[i]));
+		return r;
+	}
+	static inline float frobenius(const mat4f& m) {
+		float r = 0;
+		for (size_t i = 0; i < 16; ++i) r += m[i] * m[i];
+		return mathf::sqrt(r);
+	}
+	// largest difference over the elements in units of one ulp of scale
+	static inline float ulps(const mat4f& a, const mat4f& b, const float& scale) {
+		const float ulp = scale * FLT_EPSILON;
+		float r = 0;
+		for (size_t i = 0; i < 16; ++i) r = mathf::max(r, mathf::abs(a[i] - b[i]) / ulp);
+		return r;
+	}
+
+	// error of r against the double t in ulp of t rounded to float, results below FLT_MIN in ulp of FLT_MIN
+	static inline double ulp_error(const float& r, const double& t) {
+		const float f = float(t);
+		const int e = f == 0 || ilogb(f) < -126 ? -126 : ilogb(f);
+		return fabs(r - t) / ldexp(1.0, e - 23);
+	}
+
+	// records a failure with the case name, the measured value and the bound
+	static inline void check(const char* name, const bool& ok, const char* what, const double& value, const double& bound) {
+		++checks;
+		if (ok) return;
+		++failures;
+		printf("FAIL %-28s %s: %g (bound %g)\n", name, what, value, bound);
+	}
+	template<typename F> inline void run(const char* name, const F& f) {
+		if (!selected(name)) return;
+		const int before = failures;
+		f(name);
+		printf("%-4s %s\n", failures == before ? "ok" : "FAIL", name);
+		fflush(stdout);
+	}
+}
+
+using namespace test;
+
+int main(int argc, char** argv) {
+	if (argc > 1) { filters = argv + 1; nfilters = argc - 1; }
+
+	// the per backend rsqrte errors simd::rsqrt documents, over [1, 4) which covers every mantissa and parity
+	run("rsqrt tiers", [](const char* name) {
+#if PXL_SIMD == PXL_SIMD_SSE2 || PXL_SIMD == PXL_SIMD_AVX2
+		const double estimate = 3.7e-4;
+#elif PXL_SIMD == PXL_SIMD_NEON
+		const double estimate = 2e-5;
+#else
+		const double estimate = 4.8e-6;
+#endif
+		double e = 0, fast = 0, standard = 0, scalar = 0;
+		for (uint32_t b = 0x3f800000u; b < 0x40800000u; b += 4 * 7) {
+			float x[4], r[3][4];
+			for (uint32_t k = 0; k < 4; ++k) x[k] = mathf::bit_cast<float>(b + k);
+			const simd::f4 v = simd::load(x);
+			simd::store(r[0], simd::rsqrte(v));
+			simd::store(r[1], simd::rsqrt<mathf::precision::fast>(v));
+			simd::store(r[2], simd::rsqrt<mathf::precision::standard>(v));
+			for (int k = 0; k < 4; ++k) {
+				const double t = 1 / sqrt(double(x[k]));
+				e = fmax(e, fabs(r[0][k] - t) / t);
+				fast = fmax(fast, fabs(r[1][k] - t) / t);
+				standard = fmax(standard, fabs(r[2][k] - t) / t);
+				scalar = fmax(scalar, fabs(mathf::rsqrt<mathf::precision::fast>(x[k]) - t) / t);
+			}
+		}
+		check(name, e <= estimate, "rsqrte relative error", e, estimate);
+		check(name, fast <= 1.76e-3, "rsqrt<fast> relative error", fast, 1.76e-3);
+		check(name, standard <= 4.8e-7, "rsqrt<standard> relative error", standard, 4.8e-7);
+		check(name, scalar <= 1.76e-3, "mathf::rsqrt<fast> relative error", scalar, 1.76e-3);
+	});
+
+	// the max ulp table of the mathf functions against double libm, over the domains and with the footnotes it states
+	const auto ulp_table = [](const char* name, auto tier) {
+		constexpr mathf::precision P = decltype(tier)::value;
+		constexpr bool fast = P == mathf::precision::fast;
+		double sc = 0, sc0 = 0, t = 0, a = 0, at = 0, at0 = 0, at0r = 0, e = 0, l = 0, l1 = 0, p = 0;
+		for (int i = 0; i < 300000; ++i) {
+			// sin and cos over |x| <= 8192 and more densely near 0, absolute error within 0.01 of a zero
+			const float x = i & 1 ? rnd() * 8192 : rnd() * 16;
+			const float fs[2] = { mathf::sin<P>(x), mathf::cos<P>(x) };
+			const double rs[2] = { sin(double(x)), cos(double(x)) };
+			for (int k = 0; k < 2; ++k) {
+				if (fabs(rs[k]) < 0.01) sc0 = fmax(sc0, fabs(fs[k] - rs[k]));
+				else sc = fmax(sc, ulp_error(fs[k], rs[k]));
+			}
+			const float y = rnd() * 1.5707963f;
+			t = fmax(t, ulp_error(mathf::tan<P>(y), tan(double(y))));
+			const float s = rnd();
+			a = fmax(a, fmax(ulp_error(mathf::asin<P>(s), asin(double(s))), ulp_error(mathf::acos<P>(s), acos(double(s)))));
+
+			// atan and atan2 over magnitudes 2^-30 to 2^30
+			const float u = rnd() * float(ldexp(1.0, int(rnd(-30, 30)))), v = rnd() * float(ldexp(1.0, int(rnd(-30, 30))));
+			const float fa = mathf::atan<P>(u);
+			const double ra = atan(double(u));
+			at = fmax(at, fmax(ulp_error(fa, ra), ulp_error(mathf::atan2<P>(u, v), atan2(double(u), double(v)))));
+			at0 = fmax(at0, fabs(fa - ra));
+			if (fabs(u) < 1) at0r = fmax(at0r, fabs(fa - ra) / fabs(ra));
+
+			// exp while the result is normal, log over every normal exponent, pow with y up to the overflow of x^y
+			const float ex = rnd(-87.3f, 88.7f);
+			const double re = exp(double(ex));
+			if (re >= FLT_MIN && re <= FLT_MAX) e = fmax(e, ulp_error(mathf::exp<P>(ex), re));
+			const float lx = rnd(0.5f, 1) * float(ldexp(1.0, int(rnd(-125, 128))));
+			const double rl = log(double(lx)), el = ulp_error(mathf::log<P>(lx), rl);
+			l = fmax(l, el);
+			if (fabs(rl) >= 1) l1 = fmax(l1, el);
+			const float px = rnd(0.5f, 1) * float(ldexp(1.0, int(rnd(i & 2 ? -1 : -125, i & 2 ? 2 : 128))));
+			const float lim = 87 / fmax(fabs(log(double(px))), 1e-3), py = i & 1 ? rnd(-lim, lim) : rnd(-3, 3);
+			const double rp = pow(double(px), double(py));
+			if (rp >= FLT_MIN && rp <= FLT_MAX) p = fmax(p, ulp_error(mathf::pow<P>(px, py), rp) / (1 + fabs(py * log(double(px)))));
+		}
+		check(name, sc <= (fast ? 220 : 1.6), "sin, cos ulp", sc, fast ? 220 : 1.6);
+		check(name, sc0 <= (fast ? 1.6e-8 : 1e-9), "sin, cos absolute within 0.01 of a zero", sc0, fast ? 1.6e-8 : 1e-9);
+		check(name, t <= (fast ? 280 : 3.3), "tan ulp, |x| < pi / 2", t, fast ? 280 : 3.3);
+		check(name, a <= (fast ? 560 : 2.4), "asin, acos ulp", a, fast ? 560 : 2.4);
+		check(name, at <= (fast ? 2300 : 3.1), "atan, atan2 ulp", at, fast ? 2300 : 3.1);
+		if (fast) check(name, at0 <= 1.2e-5, "atan absolute", at0, 1.2e-5);
+		if (fast) check(name, at0r <= 1.4e-4, "atan relative, |x| < 1", at0r, 1.4e-4);
+		check(name, e <= (fast ? 75 : 1.3), "exp ulp", e, fast ? 75 : 1.3);
+		check(name, l <= (fast ? 390 : 0.9), "log ulp", l, fast ? 390 : 0.9);
+		if (fast) check(name, l1 <= 70, "log ulp, |ln x| >= 1", l1, 70);
+		check(name, p <= (fast ? 400 : 2.2), "pow ulp per k", p, fast ? 400 : 2.2);
+	};
+	run("mathf ulp table fast", [&](const char* name) { ulp_table(name, std::integral_constant<mathf::precision, mathf::precision::fast>()); });
+	run("mathf ulp table standard", [&](const char* name) { ulp_table(name, std::integral_constant<mathf::precision, mathf::precision::standard>()); });
+
+	// rotate against the matrix of the rotation, slerp against a double precision slerp along the shortest arc
+	run("quatf rotate/slerp", [](const char* name) {
+		double rot = 0, sl = 0;
+		for (int i = 0; i < 20000; ++i) {
+			const quatf a = rndq(), b = i & 1 ? rndq() : rnd_near(a, rnd(0, 0.1f));
+			const vec3f v = rnd3() * 10, r = a.rotate(v), m = mat4f::trs({ 0, 0, 0 }, a, { 1, 1, 1 }).transform_dir(v);
+			for (size_t k = 0; k < 3; ++k) rot = fmax(rot, fabs(double(r[k]) - m[k]) / fmax(1.0, fabs(double(m[k]))));
+			const float t = rnd(0, 1);
+			double d = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z + double(a.w) * b.w, s = 1;
+			if (d < 0) { d = -d; s = -1; }
+			const double th = acos(fmin(d, 1.0)), wa = th < 1e-9 ? 1 - t : sin((1 - t) * th) / sin(th), wb = (th < 1e-9 ? t : sin(t * th) / sin(th)) * s;
+			const quatf q = quatf::slerp(a, b, t);
+			for (size_t k = 0; k < 4; ++k) sl = fmax(sl, fabs(double(q[k]) - (wa * a[k] + wb * b[k])));
+		}
+		check(name, rot <= 1e-5, "rotate against the rotation matrix", rot, 1e-5);
+		check(name, sl <= 2e-6, "slerp against double precision", sl, 2e-6);
+	});
+	// keys far apart, where the inner slerp of a shortest arc squad would cross to the other hemisphere: the
+	// result moves smoothly from q1 to q2, never more than a few times the average step between samples
+	run("quatf squad", [](const char* name) {
+		double jump = 0, ends = 0;
+		for (int i = 0; i < 2000; ++i) {
+			const quatf q0 = rndq(), q1 = rnd_near(q0, rnd(1.5f, 2.5f)), q2 = rnd_near(q1, rnd(2, 2.6f)), q3 = rnd_near(q2, rnd(1.5f, 2.5f));
+			const quatf s1 = quatf::squad_control(q0, q1, q2), s2 = quatf::squad_control(q1, q2, q3);
+			quatf prev = quatf::squad(q1, q2, s1, s2, 0);
+			ends = fmax(ends, fmax(angle(prev, q1), angle(quatf::squad(q1, q2, s1, s2, 1), q2)));
+			const int steps = 1000;
+			for (int k = 1; k <= steps; ++k) {
+				const quatf q = quatf::squad(q1, q2, s1, s2, float(k) / steps);
+				jump = fmax(jump, angle(q, prev) * steps);
+				prev = q;
+			}
+		}
+		check(name, ends <= 1e-3, "end points, radians", ends, 1e-3);
+		check(name, jump <= 10, "largest step times the step count, radians", jump, 10);
+	});
+	// the batch forms against the scalar ones, 1003 elements for the simd blocks and the tail
+	run("quatf rotate_n/slerp_n", [](const char* name) {
+		const size_t n = 1003;
+		std::vector<quatf> a(n), b(n), q(n);
+		std::vector<vec3f> v(n), r(n);
+		std::vector<float> t(n);
+		for (size_t i = 0; i < n; ++i) { a[i] = rndq(); b[i] = i & 1 ? rndq() : rnd_near(a[i], rnd(0, 0.1f)); v[i] = rnd3() * 10; t[i] = rnd(0, 1); }
+		bool ok = true;
+		rotate_n(a[0], v.data(), r.data(), n);
+		for (size_t i = 0; i < n; ++i) ok = ok && approx_equal(r[i], a[0].rotate(v[i]));
+		check(name, ok, "rotate_n by one quaternion", 0, 0);
+		rotate_n(a.data(), v.data(), r.data(), n);
+		for (size_t i = 0; i < n; ++i) ok = ok && approx_equal(r[i], a[i].rotate(v[i]));
+		check(name, ok, "rotate_n elementwise", 0, 0);
+		slerp_n(a.data(), b.data(), t[0], q.data(), n);
+		for (size_t i = 0; i < n; ++i) ok = ok && approx_equal(q[i], quatf::slerp(a[i], b[i], t[0]), 2e-5f);
+		check(name, ok, "slerp_n by one t", 0, 0);
+		slerp_n(a.data(), b.data(), t.data(), q.data(), n);
+		for (size_t i = 0; i < n; ++i) ok = ok && approx_equal(q[i], quatf::slerp(a[i], b[i], t[i]), 2e-5f);
+		check(name, ok, "slerp_n elementwise", 0, 0);
+	});
+
+	// from_euler_n / to_euler_n against quatf::from_euler / to_euler, every fourth lane at a pitch of +-pi / 2 so the
+	// gimbal lock selects land in every simd lane and the tail. Angles compare modulo 2 pi. Short of the lock the pitch
+	// is steep in its input, there standard and the scalar functions are both a few 1e-6 from a double to_euler
+	const auto euler_n = [](const char* name, auto tier, const double& bound) {
+		constexpr mathf::precision P = decltype(tier)::value;
+		const size_t n = 1003;
+		std::vector<vec3f> e(n), r(n);
+		std::vector<quatf> q(n), p(n);
+		for (size_t i = 0; i < n; ++i) {
+			e[i] = { rnd() * mathf::pi, rnd() * mathf::halfpi, rnd() * mathf::pi };
+			if (i % 4 == 1) e[i].y = i & 4 ? mathf::halfpi : -mathf::halfpi;
+			const quatf u = rndq();
+			const float k = rnd(0.5f, 2);
+			p[i] = i % 4 == 3 ? quatf{ u.x * k, u.y * k, u.z * k, u.w * k } : quatf::from_euler(e[i]);
+		}
+		double from = 0, to = 0;
+		from_euler_n<P>(e.data(), q.data(), n);
+		for (size_t i = 0; i < n; ++i) {
+			const quatf s = quatf::from_euler(e[i]);
+			for (size_t k = 0; k < 4; ++k) from = fmax(from, fabs(q[i][k] - s[k]));
+		}
+		to_euler_n<P>(p.data(), r.data(), n);
+		for (size_t i = 0; i < n; ++i) {
+			const vec3f s = quatf::to_euler(p[i]);
+			for (size_t k = 0; k < 3; ++k) to = fmax(to, fabs(remainder(double(r[i][k]) - s[k], 6.283185307179586)));
+		}
+		check(name, from <= bound, "from_euler_n, largest component difference", from, bound);
+		check(name, to <= bound, "to_euler_n, radians", to, bound);
+	};
+	run("quatf from_euler_n/to_euler_n fast", [&](const char* name) { euler_n(name, std::integral_constant<mathf::precision, mathf::precision::fast>(), 4e-5); });
+	run("quatf from_euler_n/to_euler_n standard", [&](const char* name) { euler_n(name, std::integral_constant<mathf::precision, mathf::precision::standard>(), 5e-6); });
+	run("quatf from_euler_n/to_euler_n exact", [&](const char* name) { euler_n(name, std::integral_constant<mathf::precision, mathf::precision::exact>(), 0); });
+
+	// det within 3 ulp of the product of the row lengths, every inverse element within cond ulp of the largest one,
+	// cond = |m| |m^-1| in the frobenius norm. The plain ulp bounds are the ones the pxlmath.h comment quotes
+	const auto det_inverse = [](const char* name, const float& lo, const float& hi, const int& kind, const float& bound) {
+		float det_worst = 0, cond_worst = 0, worst = 0;
+		for (int i = 0; i < 20000; ++i) {
+			const mat4f m = kind == 0 ? rnd_trs(lo, hi) : kind == 1 ? rnd_view() : rnd_camera();
+			mat4f r, s;
+			const float d = ref_inverse(m, &r), e = m.inverse(s);
+			float rows = 1;
+			for (size_t k = 0; k < 4; ++k) rows *= mathf::sqrt(m[4 * k] * m[4 * k] + m[4 * k + 1] * m[4 * k + 1] + m[4 * k + 2] * m[4 * k + 2] + m[4 * k + 3] * m[4 * k + 3]);
+			det_worst = mathf::max(det_worst, mathf::abs(m.det() - d) / (rows * FLT_EPSILON));
+			det_worst = mathf::max(det_worst, mathf::abs(e - d) / (rows * FLT_EPSILON));
+			const float u = ulps(s, r, max_abs(r));
+			cond_worst = mathf::max(cond_worst, u / (frobenius(m) * frobenius(r)));
+			worst = mathf::max(worst, u);
+		}
+		check(name, det_worst <= 3, "det, ulp of the row length product", det_worst, 3);
+		check(name, cond_worst <= 1, "inverse, ulp of the largest element per unit of cond", cond_worst, 1);
+		if (bound) check(name, worst <= bound, "inverse, ulp of the largest element", worst, bound);
+	};
+	run("mat4f det/inverse trs 0.5-2", [&](const char* name) { det_inverse(name, 0.5f, 2, 0, 8); });
+	run("mat4f det/inverse trs 0.1-5", [&](const char* name) { det_inverse(name, 0.1f, 5, 0, 24); });
+	run("mat4f det/inverse view", [&](const char* name) { det_inverse(name, 1, 1, 1, 8); });
+	run("mat4f det/inverse camera", [&](const char* name) { det_inverse(name, 1, 1, 2, 0); });
+
+	// mul_affine is operator* with the bottom row terms dropped, exact for bottom rows 0 0 0 1
+	run("mat4f mul_affine", [](const char* name) {
+		for (int i = 0; i < 20000; ++i) {
+			const mat4f a = i & 1 ? rnd_view() : rnd_trs(), b = i & 2 ? rnd_view() : rnd_trs(), p = a * b, q = a.mul_affine(b);
+			bool same = true;
+			for (size_t k = 0; k < 16; ++k) same = same && p[k] == q[k];
+			check(name, same, "differs from operator*", i, 0);
+		}
+	});
+	// inverse_affine and inverse_rigid against inverse, in ulp of the largest element of the inverse
+	run("mat4f inverse_affine", [](const char* name) {
+		float worst = 0;
+		for (int i = 0; i < 20000; ++i) {
+			const mat4f m = i & 1 ? rnd_view() : rnd_trs();
+			mat4f r, a;
+			m.inverse(r);
+			m.inverse_affine(a);
+			worst = mathf::max(worst, ulps(a, r, max_abs(r)));
+		}
+		check(name, worst <= 8, "ulp of the largest element", worst, 8);
+	});
+	// the transpose is exact, what is left is the error of inverse and the rounding of the rotation
+	run("mat4f inverse_rigid", [](const char* name) {
+		float worst = 0;
+		for (int i = 0; i < 20000; ++i) {
+			const mat4f m = i & 1 ? rnd_view() : mat4f::trs(rnd3() * 10, rndq(), { 1, 1, 1 });
+			mat4f r;
+			m.inverse(r);
+			worst = mathf::max(worst, ulps(m.inverse_rigid(), r, max_abs(r)));
+		}
+		check(name, worst <= 24, "ulp of the largest element", worst, 24);
+	});
+
+	// load and store are exact, the products and transforms within approx_equal of mat4f (fma contraction differs)
+	const auto wide = [](const char* name, auto lanes) {
+		typedef mat4f_xn<decltype(lanes)::value> M;
+		typedef vec3f_xn<decltype(lanes)::value> V;
+		mat4f a[M::lanes], b[M::lanes], c[M::lanes];
+		vec3f p[M::lanes], q[M::lanes], d[M::lanes];
+		for (int k = 0; k < 2000; ++k) {
+			for (size_t i = 0; i < M::lanes; ++i) { a[i] = rnd_trs(); b[i] = rnd_view(); p[i] = rnd3() * 10; }
+			const M ma = M::load(a), mb = M::load(b);
+			(ma * mb).store(c);
+			ma.transform_point(V::load(p)).store(q);
+			ma.transform_dir(V::load(p)).store(d);
+			bool same = true, close = true;
+			for (size_t i = 0; i < M::lanes; ++i) {
+				same = same && ma[i] == a[i] && mb[i] == b[i];
+				close = close && approx_equal(c[i], a[i] * b[i]) && approx_equal(q[i], a[i].transform_point(p[i])) && approx_equal(d[i], a[i].transform_dir(p[i]));
+			}
+			check(name, same, "load differs from the input", k, 0);
+			check(name, close, "*, transform_point or transform_dir differ from mat4f", k, 0);
+		}
+	};
+	run("mat4f_x4", [&](const char* name) { wide(name, std::integral_constant<size_t, 4>()); });
+	run("mat4f_x8", [&](const char* name) { wide(name, std::integral_constant<size_t, 8>()); });
+
+	// pxl::expr against the plain operators. Chains with a product are fused and agree to a few ulp of the largest
+	// term, a single operation per element agrees bit for bit. mat4f has no elementwise + and -, so its plain side
+	// applies the same operators per element
+	const auto expr_ops = [](const char* name, auto zero) {
+		typedef decltype(zero) T;
+		constexpr bool matrix = std::is_same<T, mat4f>::value;
+		constexpr size_t N = sizeof(T) / sizeof(float);
+		double fused = 0;
+		bool exact = true;
+		for (int i = 0; i < 20000; ++i) {
+			T a = zero, b = zero, c = zero, d = zero;
+			for (size_t k = 0; k < N; ++k) {
+				expr::data(a)[k] = rnd();
+				expr::data(b)[k] = rnd();
+				expr::data(c)[k] = rnd();
+				expr::data(d)[k] = rnd(0.5f, 2);
+			}
+			const float s = rnd(-2, 2), t = rnd(-2, 2), u = rnd(0.5f, 2);
+			const auto plain = [&](const auto& f) {
+				if constexpr (matrix) {
+					T r = zero;
+					for (size_t k = 0; k < N; ++k) expr::data(r)[k] = f(expr::data(a)[k], expr::data(b)[k], expr::data(c)[k], expr::data(d)[k]);
+					return r;
+				}
+				else return T(f(a, b, c, d));
+			};
+			const auto near = [&](const T& e, const T& r, const float& scale) {
+				for (size_t k = 0; k < N; ++k) fused = fmax(fused, fabs(expr::data(e)[k] - expr::data(r)[k]) / (scale * FLT_EPSILON));
+			};
+			const auto same = [&](const T& e, const T& r) { exact = exact && memcmp(&e, &r, sizeof(T)) == 0; };
+
+			const float chain = fabs(s) + fabs(t) + 1;
+			near(lazy(a) * s + lazy(b) * t - c, plain([&](const auto& x, const auto& y, const auto& z, const auto&) { return x * s + y * t - z; }), chain);
+			near(s * lazy(a) - t * lazy(b) + c, plain([&](const auto& x, const auto& y, const auto& z, const auto&) { return s * x - t * y + z; }), chain);
+			near(c - lazy(a) * s, plain([&](const auto& x, const auto&, const auto& z, const auto&) { return z - x * s; }), chain);
+			near(lazy(a) * (1 - u) + lazy(b) * u, plain([&](const auto& x, const auto& y, const auto&, const auto&) { return x * (1 - u) + y * u; }), 2);
+			T acc = c;
+			acc += lazy(a) * s;
+			acc -= lazy(b) * t;
+			near(acc, plain([&](const auto& x, const auto& y, const auto& z, const auto&) { return z + x * s - y * t; }), chain);
+
+			same(-lazy(a), plain([](const auto& x, const auto&, const auto&, const auto&) { return -x; }));
+			same(lazy(a) / u, plain([&](const auto& x, const auto&, const auto&, const auto&) { return x / u; }));
+			same(lazy(a) * s, a * s);
+			same(s + lazy(a), plain([&](const auto& x, const auto&, const auto&, const auto&) { return s + x; }));
+			same(s - lazy(a), plain([&](const auto& x, const auto&, const auto&, const auto&) { return s - x; }));
+			if constexpr (!matrix) {
+				near(c - lazy(a) * b, c - a * b, 2);
+				near(lazy(a) * b - c, a * b - c, 2);
+				same(lazy(a) * b, a * b);
+				same(lazy(a) / d, a / d);
+				same(s / lazy(d), s / d);
+				same(eval(lazy(a) + b), a + b);
+			}
+		}
+		check(name, fused <= 2, "fused chains, ulp of the largest term", fused, 2);
+		check(name, exact, "single operations bit for bit", exact, 1);
+	};
+	run("expr vec2f", [&](const char* name) { expr_ops(name, vec2f{}); });
+	run("expr vec3f", [&](const char* name) { expr_ops(name, vec3f{}); });
+	run("expr vec4f", [&](const char* name) { expr_ops(name, vec4f{}); });
+	run("expr mat4f", [&](const char* name) { expr_ops(name, mat4f{}); });
+
+	// inputs of different sizes run up to the shorter one, growing the output again gives zeros
+	run("soa sizes", [](const char* name) {
+		vec3f_soa a(37), b(20), v;
+		quatf_soa p(37), q(20), r;
+		mat4f_soa m(20), n(37), o;
+		for (size_t i = 0; i < 37; ++i) {
+			a.set(i, rnd3()); p.set(i, rndq()); n.set(i, rnd_trs());
+			if (i < 20) { b.set(i, rnd3()); q.set(i, rndq()); m.set(i, rnd_trs()); }
+		}
+		bool same = true;
+		add(a, b, v);
+		for (size_t i = 0; i < 20; ++i) same = same && v.get(i) == a.get(i) + b.get(i);
+		check(name, v.size() == 20 && same, "add", 0, 0);
+		cross(b, a, v);
+		for (size_t i = 0; i < 20; ++i) same = same && approx_equal(v.get(i), vec3f::cross(b.get(i), a.get(i)));
+		check(name, v.size() == 20 && same, "cross", 0, 0);
+		mul(p, q, r);
+		for (size_t i = 0; i < 20; ++i) same = same && approx_equal(r.get(i), p.get(i) * q.get(i));
+		check(name, r.size() == 20 && same, "quatf mul", 0, 0);
+		mul(n, m, o);
+		check(name, o.size() == 20, "mat4f mul", 0, 0);
+		transform_points(n, b, v);
+		check(name, v.size() == 20, "transform_points", 0, 0);
+		v.resize(32);
+		for (size_t i = 20; i < 32; ++i) same = same && v.get(i) == vec3f{ 0, 0, 0 };
+		check(name, same, "grown elements are zero", 0, 0);
+	});
+
+	// half a step plus the rounding pos_range documents, on boxes from 1e-3 to 1e3 across, offset from the origin
+	const auto pos = [](const char* name, auto tag) {
+		typedef decltype(tag) P;
+		double worst = 0;
+		for (int b = 0; b < 1000; ++b) {
+			const float s = mathf::exp(rnd() * 7);
+			const pos_range r{ rnd3() * s * 3, vec3f{ rnd(0.5f, 2.5f), rnd(0.5f, 2.5f), rnd(0.5f, 2.5f) } * s };
+			for (int i = 0; i < 1000; ++i) {
+				const vec3f p = r.min + r.size * vec3f{ rnd(0, 1), rnd(0, 1), rnd(0, 1) }, d = r.decode(r.encode<P>(p));
+				for (size_t k = 0; k < 3; ++k) {
+					const double bound = double(r.size[k]) / (2.0 * P::steps[k]) + (fabs(double(r.min[k])) + r.size[k]) * ldexp(1.0, -22);
+					worst = fmax(worst, fabs(double(d[k]) - double(p[k])) / bound);
+				}
+			}
+		}
+		check(name, worst <= 1, "error over the bound", worst, 1);
+	};
+	run("pos48", [&](const char* name) { pos(name, pos48{}); });
+	run("pos32", [&](const char* name) { pos(name, pos32{}); });
+	// convert_n encodes bit for bit like the scalar conversions and decodes within fma contraction of them, both
+	// within the documented angles. The formats have no padding, their bytes are the stored bits
+	const auto bits = [](const auto& a, const auto& b) { return !memcmp(&a, &b, sizeof(a)); };
+	const auto quant = [&](const char* name, auto tag, const double& degrees) {
+		typedef decltype(tag) P;
+		constexpr bool rotation = std::is_constructible<P, quatf>::value;
+		typedef typename std::conditional<rotation, quatf, vec3f>::type T;
+		const size_t n = 200003;
+		std::vector<T> in(n), out(n);
+		std::vector<P> e(n);
+		for (size_t i = 0; i < n; ++i) {
+			if constexpr (rotation) in[i] = rndq();
+			else in[i] = vec3f{ rnd(), rnd(), rnd() + 0.01f }.normalized();
+		}
+		// the axes and diagonals, where the largest component or the fold changes
+		for (size_t i = 0; i < 64; ++i) {
+			const float c[4]{ float(i & 1), float(i >> 1 & 1), float(i >> 2 & 1), float(i >> 3 & 1) + (i < 16 ? 0 : 0.001f * float(i)) };
+			if constexpr (rotation) in[i] = quatf{ i & 16 ? -c[0] : c[0], c[1], i & 32 ? -c[2] : c[2], c[3] + 1e-3f }.normalized();
+			else in[i] = vec3f{ i & 16 ? -c[0] : c[0], i & 8 ? -c[1] : c[1], (i & 32 ? -1.0f : 1.0f) * (i & 7 ? c[2] : 1) }.normalized();
+		}
+		convert_n(in.data(), e.data(), n);
+		convert_n(e.data(), out.data(), n);
+		size_t mismatches = 0, decodes = 0;
+		double worst = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const P s(in[i]);
+			const T d = T(s);
+			if (!bits(s, e[i])) ++mismatches;
+			if (!approx_equal(d, out[i], 1e-6f)) ++decodes;
+			if constexpr (rotation) worst = fmax(worst, angle(in[i], out[i]));
+			else {
+				double c = 0;
+				for (size_t k = 0; k < 3; ++k) c += (double(in[i][k]) - out[i][k]) * (double(in[i][k]) - out[i][k]);
+				worst = fmax(worst, 2 * asin(fmin(1.0, sqrt(c) / 2)));
+			}
+		}
+		worst *= 180 / 3.14159265358979;
+		check(name, mismatches == 0, "convert_n encodes differ from the scalar ones", double(mismatches), 0);
+		check(name, decodes == 0, "convert_n decodes differ from the scalar ones", double(decodes), 0);
+		check(name, worst <= degrees, "degrees", worst, degrees);
+	};
+	run("quat32", [&](const char* name) { quant(name, quat32{}, 0.3); });
+	run("quat48", [&](const char* name) { quant(name, quat48{}, 0.01); });
+	run("quat64", [&](const char* name) { quant(name, quat64{}, 0.0004); });
+	run("oct16", [&](const char* name) { quant(name, oct16{}, 1); });
+	run("oct32", [&](const char* name) { quant(name, oct32{}, 0.004); });
+	// pos_range convert_n against encode / decode
+	const auto pos_n = [&](const char* name, auto tag) {
+		typedef decltype(tag) P;
+		const size_t n = 10003;
+		const pos_range r{ rnd3() * 50, vec3f{ rnd(1, 100), rnd(1, 100), rnd(1, 100) } };
+		std::vector<vec3f> in(n), out(n);
+		std::vector<P> e(n);
+		for (size_t i = 0; i < n; ++i) in[i] = r.min + r.size * vec3f{ rnd(-0.1f, 1.1f), rnd(-0.1f, 1.1f), rnd(-0.1f, 1.1f) };
+		convert_n(r, in.data(), e.data(), n);
+		convert_n(r, e.data(), out.data(), n);
+		size_t mismatches = 0, decodes = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const P s = r.encode<P>(in[i]);
+			if (!bits(s, e[i])) ++mismatches;
+			if (!approx_equal(r.decode(s), out[i], 1e-6f)) ++decodes;
+		}
+		check(name, mismatches == 0, "convert_n encodes differ from encode", double(mismatches), 0);
+		check(name, decodes == 0, "convert_n decodes differ from decode", double(decodes), 0);
+	};
+	run("pos48 convert_n", [&](const char* name) { pos_n(name, pos48{}); });
+	run("pos32 convert_n", [&](const char* name) { pos_n(name, pos32{}); });
+
+	// half against a double decode of every bit pattern and against round to nearest even over a stride of all floats
+	// and the midpoints between halves, snorm16 and unorm16 against the nearest step, convert_n (F16C or neon for
+	// half where the target has it) against the scalar conversions bit for bit
+	run("half/snorm16/unorm16", [](const char* name) {
+		bool decode = true, trip = true, round = true, batch = true;
+		for (uint32_t h = 0; h < 0x10000; ++h) {
+			const uint32_t e = (h >> 10) & 31, m = h & 1023;
+			const float f = half::to_float(uint16_t(h)), s = h & 0x8000 ? -1.0f : 1.0f;
+			const uint16_t b = half::from_float(f);
+			if (e == 31 && m) {
+				decode = decode && f != f;
+				trip = trip && (b & 0x7c00) == 0x7c00 && (b & 0x3ff);
+				continue;
+			}
+			const double v = e == 31 ? s * double(INFINITY) : s * (e ? ldexp(1024 + m, int(e) - 25) : ldexp(m, -24));
+			decode = decode && f == v && signbit(f) == (s < 0);
+			trip = trip && b == h;
+		}
+
+		std::vector<float> x;
+		for (uint64_t b = 0; b < 0x100000000ull; b += 997) x.push_back(mathf::bit_cast<float>(uint32_t(b)));
+		for (uint16_t h = 0; h < 0x7bff; ++h) {
+			const float mid = (half::to_float(h) + half::to_float(h + 1)) / 2;
+			for (const float& f : { mid, nextafterf(mid, 0), nextafterf(mid, INFINITY) }) x.insert(x.end(), { f, -f });
+		}
+		x.insert(x.end(), { 65504.0f, 65519.99f, 65520.0f, INFINITY, -INFINITY, 1.5f, -1.5f, 1, -1, 0, -0.0f });
+		for (int k = -32767; k <= 65535; ++k) x.insert(x.end(), { k / 65535.0f, nextafterf(k / 65535.0f, 2), (k + 0.5f) / 32767 });
+		const size_t n = x.size();
+
+		double sn = 0, un = 0;
+		for (const float& f : x) {
+			if (f == f) {
+				const double a = fabs(double(f));
+				const int e = a < ldexp(1.0, -14) ? -14 : ilogb(a);
+				const double r = a >= 65520 ? double(INFINITY) : nearbyint(a / ldexp(1.0, e - 10)) * ldexp(1.0, e - 10);
+				const float g = half(f);
+				round = round && g == r * (signbit(f) ? -1 : 1) && signbit(g) == signbit(f);
+			}
+			const double cs = f == f ? fmin(fmax(double(f), -1), 1) : -1, cu = f == f ? fmin(fmax(double(f), 0), 1) : 0;
+			sn = fmax(sn, fabs(snorm16::from_float(f) - cs * 32767));
+			un = fmax(un, fabs(unorm16::from_float(f) - cu * 65535));
+		}
+		double sf = 0, uf = 0;
+		for (int v = -32767; v < 32768; ++v) sf = fmax(sf, ulp_error(snorm16::to_float(int16_t(v)), v / 32767.0));
+		for (int v = 0; v < 65536; ++v) uf = fmax(uf, ulp_error(unorm16::to_float(uint16_t(v)), v / 65535.0));
+
+		// nan packs to the low end everywhere but on neon, half keeps nan as some nan
+#if PXL_SIMD != PXL_SIMD_NEON
+		x.insert(x.end(), 13, mathf::nan);
+#endif
+		std::vector<half> h(x.size());
+		std::vector<snorm16> s(x.size());
+		std::vector<unorm16> u(x.size());
+		std::vector<float> y(x.size());
+		convert_n(x.data(), h.data(), x.size());
+		convert_n(x.data(), s.data(), x.size());
+		convert_n(x.data(), u.data(), x.size());
+		for (size_t i = 0; i < x.size(); ++i) {
+			const uint16_t b = half::from_float(x[i]);
+			batch = batch && (x[i] == x[i] ? h[i].bits == b : (h[i].bits & 0x7c00) == 0x7c00 && (h[i].bits & 0x3ff));
+			batch = batch && s[i].v == snorm16::from_float(x[i]) && u[i].v == unorm16::from_float(x[i]);
+		}
+		const auto back = [&](const auto& in) {
+			convert_n(in.data(), y.data(), n);
+			for (size_t i = 0; i < n; ++i) {
+				const float f = in[i];
+				batch = batch && memcmp(&y[i], &f, sizeof(f)) == 0;
+			}
+		};
+		back(h);
+		back(s);
+		back(u);
+
+		check(name, decode, "half to float of every bit pattern", decode, 1);
+		check(name, trip, "half round trip of every bit pattern", trip, 1);
+		check(name, round, "half round to nearest even", round, 1);
+		check(name, sn <= 0.502, "snorm16 steps from the clamped value", sn, 0.502);
+		check(name, un <= 0.502, "unorm16 steps from the clamped value", un, 0.502);
+		check(name, sf <= 1, "snorm16 to float, ulp", sf, 1);
+		check(name, uf <= 1, "unorm16 to float, ulp", uf, 1);
+		check(name, batch, "convert_n against the scalar conversions", batch, 1);
+	});
+
+	// skin_n against skin_matrix / skin_dualquat per vertex, with and without normals and a pool. The error is
+	// relative to max(1, |reference|), the simd kernels sum the influences in another order
+	const auto skin = [](const char* name, auto tag, const bool& dq, job_pool* pool) {
+		constexpr size_t K = decltype(tag)::value;
+		const size_t joints = 64, n = 1003;
+		std::vector<mat4f> mats(joints);
+		std::vector<dualquatf> dqs(joints);
+		for (size_t j = 0; j < joints; ++j) {
+			const quatf r = rndq();
+			const vec3f t = rnd3() * 10;
+			mats[j] = mat4f::trs(t, r, { rnd(0.5f, 2), rnd(0.5f, 2), rnd(0.5f, 2) });
+			dqs[j] = dualquatf::from_rt(r, t);
+		}
+		std::vector<skin_weights<K>> w(n);
+		std::vector<vec3f> pos(n), nrm(n), out_pos(n), out_nrm(n), ref_pos(n), ref_nrm(n);
+		for (size_t i = 0; i < n; ++i) {
+			float sum = 0;
+			for (size_t k = 0; k < K; ++k) {
+				w[i].joint[k] = uint16_t(rnd(0, joints - 0.5f));
+				w[i].weight[k] = k && rnd() < -0.5f ? 0 : rnd(0, 1);
+				sum += w[i].weight[k];
+			}
+			for (size_t k = 0; k < K; ++k) w[i].weight[k] /= sum;
+			pos[i] = rnd3() * 2;
+			nrm[i] = rnd3().normalized();
+			if (dq) {
+				const dualquatf b = skin_dualquat(dqs.data(), w[i]);
+				ref_pos[i] = b.transform_point(pos[i]); ref_nrm[i] = b.transform_dir(nrm[i]);
+			}
+			else {
+				const mat4f b = skin_matrix(mats.data(), w[i]);
+				ref_pos[i] = b.transform_point(pos[i]); ref_nrm[i] = b.transform_dir(nrm[i]);
+			}
+		}
+		const double bound = dq ? 5e-6 : 1e-6;
+		// grain 0 on the K = 8 runs, chunks round up to whole blocks of 8 vertices
+		const size_t grain = K == 8 ? 0 : 64;
+		for (int normals = 0; normals < 2; ++normals) {
+			if (dq && normals) skin_n(dqs.data(), w.data(), pos.data(), nrm.data(), out_pos.data(), out_nrm.data(), n, pool, grain);
+			else if (dq) skin_n(dqs.data(), w.data(), pos.data(), out_pos.data(), n, pool, grain);
+			else if (normals) skin_n(mats.data(), w.data(), pos.data(), nrm.data(), out_pos.data(), out_nrm.data(), n, pool, grain);
+			else skin_n(mats.data(), w.data(), pos.data(), out_pos.data(), n, pool, grain);
+			double worst = 0;
+			for (size_t i = 0; i < n; ++i)
+				for (size_t k = 0; k < 3; ++k) {
+					worst = fmax(worst, fabs(double(out_pos[i][k]) - ref_pos[i][k]) / fmax(1.0, fabs(double(ref_pos[i][k]))));
+					if (normals) worst = fmax(worst, fabs(double(out_nrm[i][k]) - ref_nrm[i][k]) / fmax(1.0, fabs(double(ref_nrm[i][k]))));
+				}
+			check(name, worst <= bound, normals ? "positions and normals" : "positions", worst, bound);
+		}
+	};
+	job_pool pool(4);
+	for (int dq = 0; dq < 2; ++dq)
+		for (int pooled = 0; pooled < 2; ++pooled) {
+			char name[64];
+			snprintf(name, sizeof(name), "skin_n %s K=4%s", dq ? "dqs" : "lbs", pooled ? " pool" : "");
+			run(name, [&](const char* name) { skin(name, std::integral_constant<size_t, 4>(), dq != 0, pooled ? &pool : nullptr); });
+			snprintf(name, sizeof(name), "skin_n %s K=8%s", dq ? "dqs" : "lbs", pooled ? " pool" : "");
+			run(name, [&](const char* name) { skin(name, std::integral_constant<size_t, 8>(), dq != 0, pooled ? &pool : nullptr); });
+		}
+
+	// raycast_n and occluded_n against every triangle tested by ray::intersects, on a soup with coincident and
+	// degenerate triangles. Hits agree within the difference of the simd and scalar triangle tests, a ray grazing an
+	// edge may go either way so a few disagreements are allowed
+	run("bvh raycast_n/occluded_n", [](const char* name) {
+		const size_t triangles = 3000, n = 4003;
+		std::vector<vec3f> vertices;
+		std::vector<uint32_t> indices;
+		for (size_t i = 0; i < triangles; ++i) {
+			const vec3f c = rnd3() * 20, a = c + rnd3() * 2, b = i % 7 == 3 ? a : c + rnd3() * 2;
+			const uint32_t k = (uint32_t)vertices.size();
+			vertices.push_back(c); vertices.push_back(a); vertices.push_back(b);
+			indices.push_back(k); indices.push_back(k + 1); indices.push_back(k + 2);
+			if (i % 11 == 5) { indices.push_back(k); indices.push_back(k + 1); indices.push_back(k + 2); }
+		}
+		const size_t count = indices.size() / 3;
+		std::vector<ray> rays(n);
+		std::vector<float> tmax(n), ref_t(n);
+		std::vector<bool> ref_hit(n);
+		for (size_t i = 0; i < n; ++i) {
+			rays[i].origin = rnd3() * 25;
+			rays[i].dir = (rnd3() * 20 - rays[i].origin).normalized();
+			tmax[i] = rnd(10, 60);
+			float t = tmax[i], u, v;
+			bool hit = false;
+			for (size_t k = 0; k < count; ++k)
+				hit = rays[i].intersects(vertices[indices[3 * k]], vertices[indices[3 * k + 1]], vertices[indices[3 * k + 2]], t, u, v) || hit;
+			ref_hit[i] = hit; ref_t[i] = t;
+		}
+		job_pool pool(4);
+		bvh tree;
+		tree.build(vertices.data(), indices.data(), count, &pool);
+		for (int mode = 0; mode < 3; ++mode) {
+			job_pool* p = mode ? &pool : nullptr;
+			const size_t grain = mode == 1 ? 0 : 64;
+			std::vector<ray_hit> hits(n);
+			for (size_t i = 0; i < n; ++i) hits[i].t = tmax[i];
+			raycast_n(tree, vertices.data(), indices.data(), rays.data(), hits.data(), n, p, grain);
+			std::vector<uint32_t> mask((n + 31) / 32);
+			occluded_n(tree, vertices.data(), indices.data(), rays.data(), tmax.data(), n, mask.data(), p, grain);
+			size_t misses = 0, hits_wrong = 0, occluded_wrong = 0;
+			for (size_t i = 0; i < n; ++i) {
+				const bool hit = hits[i].prim != bvh::none, occ = (mask[i >> 5] >> (i & 31)) & 1;
+				if (hit != ref_hit[i]) ++misses;
+				else if (hit) {
+					// the reported triangle must give the reported distance
+					const uint32_t* x = indices.data() + 3 * hits[i].prim;
+					float t = tmax[i], u, v;
+					const bool again = rays[i].intersects(vertices[x[0]], vertices[x[1]], vertices[x[2]], t, u, v);
+					if (!again || !mathf::approx_equal(t, hits[i].t, 1e-4f) || !mathf::approx_equal(hits[i].t, ref_t[i], 1e-4f)) ++hits_wrong;
+				}
+				if (occ != ref_hit[i]) ++occluded_wrong;
+			}
+			check(name, misses <= 2, "raycast_n hit or miss differs", double(misses), 2);
+			check(name, hits_wrong == 0, "raycast_n distance or triangle differs", double(hits_wrong), 0);
+			check(name, occluded_wrong <= 2, "occluded_n differs", double(occluded_wrong), 2);
+		}
+	});
+
+	// a clip joint without keys samples to the identity transform
+	// keys at uneven times, rotations up to spread radians apart with every other one negated
+	const auto keyed = [](track<vec3f>& v, track<quatf>& q, const size_t& n, const bool& tangents, const float& spread) {
+		float t = rnd(-1, 1);
+		quatf r = rndq();
+		for (size_t i = 0; i < n; ++i) {
+			v.add(t, rnd3() * 10);
+			q.add(t, i & 1 ? quatf{ -r.x, -r.y, -r.z, -r.w } : r);
+			if (tangents) v.tangents.insert(v.tangents.end(), { rnd3() * 10, rnd3() * 10 });
+			t += rnd(0.1f, 0.5f);
+			r = rnd_near(r, rnd(0, spread));
+		}
+	};
+
+	// sampling through a cursor gives what sample(t) without one gives, playing forward, backward and jumping,
+	// at and between the keys and outside the track
+	run("track cursor", [&](const char* name) {
+		bool same = true;
+		for (int mode = 0; mode < 4; ++mode) {
+			track<vec3f> v;
+			track<quatf> q;
+			keyed(v, q, 40, mode == 3, 1);
+			v.mode = q.mode = mode == 0 ? interpolation::step : mode == 1 ? interpolation::linear : interpolation::cubic;
+			const float lo = v.start() - 0.5f, hi = v.end() + 0.5f;
+			uint32_t cv = 0, cq = 0;
+			const auto at = [&](const float& t) {
+				const vec3f a = v.sample(t, cv), b = v.sample(t);
+				const quatf c = q.sample(t, cq), d = q.sample(t);
+				same = same && memcmp(&a, &b, sizeof(a)) == 0 && memcmp(&c, &d, sizeof(c)) == 0;
+			};
+			for (float t = lo; t < hi; t += 0.013f) at(t);
+			for (float t = hi; t > lo; t -= 0.017f) at(t);
+			for (int i = 0; i < 2000; ++i) at(i & 3 ? rnd(lo, hi) : v.times[size_t(rnd(0, 39.99f))]);
+		}
+		check(name, same, "cursor against none", same, 1);
+	});
+
+	// vec3f cubic against a double hermite through the track's tangents or the catmull-rom ones, one-sided at the
+	// ends, and exactly the key values at the keys
+	run("track hermite/catmull-rom", [&](const char* name) {
+		double worst = 0;
+		bool keys = true;
+		for (int mode = 0; mode < 2; ++mode) {
+			track<vec3f> v;
+			track<quatf> q;
+			const size_t n = 30;
+			keyed(v, q, n, mode == 1, 1);
+			v.mode = interpolation::cubic;
+			for (size_t k = 0; k < n; ++k) keys = keys && v.sample(v.times[k]) == v.values[k];
+			for (size_t k = 0; k + 1 < n; ++k) {
+				const size_t a = k ? k - 1 : k, b = k + 2 < n ? k + 2 : k + 1;
+				const double t0 = v.times[k], t1 = v.times[k + 1], dt = t1 - t0;
+				for (int j = 1; j < 8; ++j) {
+					const float t = float(t0 + dt * j / 8);
+					const double u = (t - t0) / dt, u2 = u * u, u3 = u2 * u;
+					const double h00 = 2 * u3 - 3 * u2 + 1, h10 = (u3 - 2 * u2 + u) * dt, h01 = 3 * u2 - 2 * u3, h11 = (u3 - u2) * dt;
+					const vec3f r = v.sample(t);
+					for (size_t c = 0; c < 3; ++c) {
+						const double p0 = v.values[k][c], p1 = v.values[k + 1][c];
+						const double m0 = mode ? v.tangents[2 * k + 1][c] : (p1 - v.values[a][c]) / (t1 - v.times[a]);
+						const double m1 = mode ? v.tangents[2 * k + 2][c] : (v.values[b][c] - p0) / (v.times[b] - t0);
+						worst = fmax(worst, fabs(r[c] - (h00 * p0 + h10 * m0 + h01 * p1 + h11 * m1)));
+					}
+				}
+			}
+		}
+		check(name, keys, "key values at the keys", keys, 1);
+		check(name, worst <= 2e-5, "between the keys, absolute", worst, 2e-5);
+	});
+
+	// quatf cubic is squad: the key rotations at the keys, continuous along the track with keys up to 2.6 radians
+	// apart that flip hemisphere, and C1 through the keys
+	run("track squad", [&](const char* name) {
+		double keys = 0, speed = 0, smooth = 0;
+		for (int i = 0; i < 20; ++i) {
+			track<vec3f> v;
+			track<quatf> q;
+			const size_t n = 20;
+			keyed(v, q, n, false, i & 1 ? 2.6f : 1);
+			q.mode = interpolation::cubic;
+			// squad is C1 in the segment parameter, so in time only over even key spacing
+			for (size_t k = 0; k < n; ++k) q.times[k] = k * 0.25f;
+			for (size_t k = 0; k < n; ++k) keys = fmax(keys, angle(q.sample(q.times[k]), q.values[k]));
+			const float h = 1e-3f;
+			quatf prev = q.sample(0);
+			for (int k = 1; k * h <= q.end(); ++k) {
+				const quatf c = q.sample(k * h);
+				speed = fmax(speed, angle(prev, c) / h);
+				prev = c;
+			}
+			for (size_t k = 1; k + 1 < n; ++k) {
+				const float t = q.times[k];
+				const quatf a = q.sample(t - h), b = q.sample(t), c = q.sample(t + h);
+				// the rotation from a to b matches the one from b to c up to the second order in h
+				smooth = fmax(smooth, angle(b * a.conjugated(), c * b.conjugated()) / h);
+			}
+		}
+		check(name, keys <= 1e-5, "key rotations at the keys, radians", keys, 1e-5);
+		check(name, speed <= 30, "angular speed, radians per second", speed, 30);
+		check(name, smooth <= 0.5, "change of the rotation per step through the keys", smooth, 0.5);
+	});
+
+	run("clip rest", [](const char* name) {
+		clip c;
+		c.resize(3);
+		c.translation[1].add(0, { 1, 2, 3 });
+		uint32_t cursors[9] = {};
+		vec3f t[3], s[3];
+		quatf r[3];
+		c.sample(0.5f, cursors, t, r, s);
+		check(name, t[0] == vec3f{ 0, 0, 0 } && r[0] == quatf::identity() && s[0] == vec3f{ 1, 1, 1 }, "empty tracks", 0, 0);
+		check(name, t[1] == vec3f{ 1, 2, 3 } && r[1] == quatf::identity() && s[1] == vec3f{ 1, 1, 1 }, "keyed translation", 0, 0);
+		check(name, mat4f::trs(t[2], r[2], s[2]) == mat4f::identity(), "trs of the rest", 0, 0);
+	});
+
+	printf("%s, %d checks, %d failed\n", failures ? "FAILED" : "passed", checks, failures);
+	return failures ? 1 : 0;
+}